@@ -29,31 +29,37 @@ class IAnimationLibrary : public virtual core::IReferenceCounted
 
 		struct alignas(8) Keyframe
 		{
-				Keyframe() : scale(0ull) // TODO: initialize scale to 1.f
+				Keyframe() : scale(core::rgb32f_to_rgb18e7s3(1.f,1.f,1.f))
 				{
 					translation[2] = translation[1] = translation[0] = 0.f;
-					quat = core::vectorSIMDu32(128u,128u,128u,255u); // should be (0,0,0,1) encoded
+					quat = core::vectorSIMDu32(0u,0u,0u,127u); // (0,0,0,1) encoded as SNORM
 				}
 				Keyframe(const core::vectorSIMDf& _scale, const core::quaternion& _quat, const CQuantQuaternionCache* quantCache, const core::vectorSIMDf& _translation)
 				{
 					std::copy(_translation.pointer,_translation.pointer+3,translation);
-					quat = quantCache->template quantize<decltype(quat)>(_quat);
-					// TODO: encode to RGB18E7S3
-					//scale = ;
+					// the cache only memoizes the fits and does its own locking, so quantizing through a const one is fine
+					quat = const_cast<CQuantQuaternionCache*>(quantCache)->template quantize<EF_R8G8B8A8_SNORM>(_quat);
+					scale = core::rgb32f_to_rgb18e7s3(_scale.pointer);
 				}
 
 				inline core::quaternion getRotation() const
 				{
-					const void* _pix[4] = {&quat,nullptr,nullptr,nullptr};
-					double out[4];
-					decodePixels<EF_R8G8B8A8_SNORM,double>(_pix,out,0u,0u);
-					auto q = core::normalize(core::vectorSIMDf(out[0],out[1],out[2],out[3]));
+					// same as `decodePixels<EF_R8G8B8A8_SNORM>` but without the per-channel format dispatch, this sits in the hot loop of CPU animation sampling
+					const int8_t* snorm = reinterpret_cast<const int8_t*>(&quat);
+					const auto decoded = core::max(core::vectorSIMDf(snorm[0],snorm[1],snorm[2],snorm[3])*(1.f/127.f),core::vectorSIMDf(-1.f));
+					auto q = core::normalize(decoded);
 					return reinterpret_cast<const core::quaternion*>(&q)[0];
 				}
 
 				inline core::vectorSIMDf getScale() const
 				{
-					return core::vectorSIMDf(0.f/0.f); // TODO: decode from RGB18E7S3
+					const auto decoded = core::rgb18e7s3_to_rgb32f(scale);
+					return core::vectorSIMDf(decoded.x,decoded.y,decoded.z);
+				}
+
+				inline core::vectorSIMDf getTranslation() const
+				{
+					return core::vectorSIMDf(translation[0],translation[1],translation[2]);
 				}
 
 			private:
@@ -96,7 +102,7 @@ class IAnimationLibrary : public virtual core::IReferenceCounted
 				}
 				inline E_INTERPOLATION_MODE getInterpolationMode() const
 				{
-					return data[1]&EIM_MASK;
+					return static_cast<E_INTERPOLATION_MODE>(data[1]&EIM_MASK);
 				}
 
 			private:
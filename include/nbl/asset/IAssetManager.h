@@ -6,7 +6,10 @@
 #define __NBL_ASSET_I_ASSET_MANAGER_H_INCLUDED__
 
 #include <array>
+#include <future>
+#include <mutex>
 #include <ostream>
+#include <span>
 
 #include "nbl/core/declarations.h"
 #include "nbl/system/path.h"
@@ -117,6 +120,12 @@ class NBL_API2 IAssetManager : public core::IReferenceCounted
         core::smart_refctd_ptr<IGeometryCreator> m_geometryCreator;
         core::smart_refctd_ptr<IMeshManipulator> m_meshManipulator;
         core::smart_refctd_ptr<CCompilerSet> m_compilerSet;
+
+        // workers and the flushing thread of `writeAssetsAsync`, only started by its first call
+        struct SAsyncWriteQueue;
+        std::unique_ptr<SAsyncWriteQueue> m_asyncWriteQueue;
+        std::once_flag m_asyncWriteQueueCreated;
+        std::atomic<size_t> m_maxPendingAsyncWriteBytes = 0x1ull<<28ull;
         // called as a part of constructor only
         void initializeMeshTools();
 
@@ -143,12 +152,7 @@ class NBL_API2 IAssetManager : public core::IReferenceCounted
         CCompilerSet* getCompilerSet() const { return m_compilerSet.get(); }
 
     protected:
-		virtual ~IAssetManager()
-		{
-			for (size_t i = 0u; i < m_assetCache.size(); ++i)
-				if (m_assetCache[i])
-					delete m_assetCache[i];
-		}
+		virtual ~IAssetManager();
 
 		//TODO change name (its multiple assets not just one)
         //! _supposedFilename is filename as it was, not touched by loader override with _override->getLoadFilename()
@@ -384,6 +388,28 @@ class NBL_API2 IAssetManager : public core::IReferenceCounted
             return writeAsset(_file, _params, nullptr);
         }
 
+        //! One write of `writeAssetsAsync`, the `params.rootAsset`, `params.userData` and `override` have to stay alive until its future is ready
+        struct SAsyncWriteRequest
+        {
+            //! relative to `params.workingDirectory`, same as with `writeAsset`
+            std::string filename;
+            IAssetWriter::SAssetWriteParams params;
+            IAssetWriter::IAssetWriterOverride* override = nullptr;
+        };
+        //! Writing many assets at once
+        /** The assets get encoded into memory on a pool of worker threads (the same writers as `writeAsset` would pick),
+        then every output file gets created and written with a single write through the `ISystem`'s dispatch thread.
+        Encoded outputs waiting for their write take up at most `setMaxPendingAsyncWriteBytes` of memory in total, the workers stall while over it.
+        An output's size is only known once it's encoded, so on top of that every worker (one per hardware thread) can hold the output it just encoded,
+        the peak is the budget plus `std::thread::hardware_concurrency()` times the largest output.
+        The futures become `true` once the file has been written out in full, an exception thrown by a writer gets rethrown by the future's `get()`.
+        The manager waits for all outstanding writes before it dies.
+        */
+        core::vector<std::future<bool>> writeAssetsAsync(const std::span<const SAsyncWriteRequest> requests);
+        //! an output bigger than this still gets written, but only while nothing else is pending
+        inline void setMaxPendingAsyncWriteBytes(const size_t maxPendingBytes) { m_maxPendingAsyncWriteBytes.store(maxPendingBytes); }
+        inline size_t getMaxPendingAsyncWriteBytes() const { return m_maxPendingAsyncWriteBytes.load(); }
+
         // Asset Loaders [FOLLOWING ARE NOT THREAD SAFE]
         uint32_t getAssetLoaderCount() { return static_cast<uint32_t>(m_loaders.vector.size()); }
 
@@ -11,6 +11,8 @@
 #include "nbl/asset/ICPUDescriptorSetLayout.h"
 #include "nbl/asset/IDescriptorSet.h"
 
+#include "nbl/core/containers/pooled_refctd_dynamic_array.h"
+
 namespace nbl::asset
 {
 
@@ -40,7 +42,7 @@ class NBL_API2 ICPUDescriptorSet final : public IDescriptorSet<ICPUDescriptorSet
 				if (count == 0u)
 					continue;
 
-				m_descriptorInfos[t] = core::make_refctd_dynamic_array<core::smart_refctd_dynamic_array<ICPUDescriptorSet::SDescriptorInfo>>(count);
+				m_descriptorInfos[t] = core::make_refctd_dynamic_array<descriptor_info_array_t>(count);
 			}
 		}
 
@@ -85,8 +87,10 @@ class NBL_API2 ICPUDescriptorSet final : public IDescriptorSet<ICPUDescriptorSet
 		IAsset* getDependant_impl(size_t ix) override;
 
 	private:
+		// there's one of these per used descriptor type in every set and they're usually short, so keep them off the general heap
+		using descriptor_info_array_t = core::smart_pooled_refctd_dynamic_array<ICPUDescriptorSet::SDescriptorInfo>;
 
-		core::smart_refctd_dynamic_array<ICPUDescriptorSet::SDescriptorInfo> m_descriptorInfos[static_cast<uint32_t>(IDescriptor::E_TYPE::ET_COUNT)];
+		descriptor_info_array_t m_descriptorInfos[static_cast<uint32_t>(IDescriptor::E_TYPE::ET_COUNT)];
 };
 
 }
@@ -34,6 +34,7 @@
 #include "nbl/asset/filters/CSwizzleAndConvertImageFilter.h"
 #include "nbl/asset/filters/CFlattenRegionsImageFilter.h"
 #include "nbl/asset/filters/CMipMapGenerationImageFilter.h"
+#include "nbl/asset/filters/CStreamingMipMapGenerationFilter.h"
 #include "nbl/asset/filters/CSummedAreaTableImageFilter.h"
 
 // acceleration structure
@@ -50,6 +51,7 @@
 // skinning
 #include "nbl/asset/ICPUAnimationLibrary.h"
 #include "nbl/asset/ICPUSkeleton.h"
+#include "nbl/asset/utils/CAnimationSampler.h"
 
 // meshes
 #include "nbl/asset/ICPUMeshBuffer.h"
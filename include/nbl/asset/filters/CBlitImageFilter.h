@@ -504,6 +504,26 @@ class CBlitImageFilter :
 						static_cast<uint32_t>(intermediateExtent[axis][loopCoordID[0]]),
 						static_cast<uint32_t>(intermediateExtent[axis][loopCoordID[1]])
 					};
+					// The polyphase weights get decoded to `value_t` once per axis and the window start of every output texel gets computed once per axis,
+					// both only depend on the output coordinate along the axis so every line reuses them.
+					// Lines of every pass are contiguous in their input (the intermediate storage is transposed), so the
+					// convolution is a dot product of two contiguous arrays with a compile time `ChannelCount` wide accumulator.
+					const uint32_t axisOutExtent = outExtentLayerCount[axis];
+					core::vector<value_t> phaseWeights(phaseCount[axis]*windowSize*ChannelCount);
+					for (size_t j=0; j<phaseWeights.size(); j++)
+					{
+						if constexpr (std::is_same_v<lut_value_t,uint16_t>)
+							phaseWeights[j] = value_t(core::Float16Compressor::decompress(scaledKernelPhasedLUTPixel[axis][j]));
+						else
+							phaseWeights[j] = scaledKernelPhasedLUTPixel[axis][j];
+					}
+					core::vector<int32_t> windowOffsets(axisOutExtent);
+					for (uint32_t i=0u; i<axisOutExtent; i++)
+					{
+						float tmp = float(i)+0.5f;
+						windowOffsets[i] = (kernel.getWindowMinCoord(tmp*fScale[axis],tmp)-windowMinCoord[axis])*ChannelCount;
+					}
+
 					CBasicImageFilterCommon::BlockIterator<batch_dims> begin(batchExtent);
 					const uint32_t spaceFillingEnd[batch_dims] = {0u,batchExtent[1]};
 					CBasicImageFilterCommon::BlockIterator<batch_dims> end(begin.getExtentBatches(),spaceFillingEnd);
@@ -558,38 +578,21 @@ class CBlitImageFilter :
 							}
 						}
 
-						auto getWeightedSample = [scaledKernelPhasedLUTPixel, windowSize, lineBuffer, &windowMinCoord, axis](const auto& windowCoord, const auto phaseIndex, const auto windowPixel, const auto channel) -> value_t
-						{
-							value_t kernelWeight;
-							if constexpr (std::is_same_v<lut_value_t, uint16_t>)
-								kernelWeight = value_t(core::Float16Compressor::decompress(scaledKernelPhasedLUTPixel[axis][(phaseIndex * windowSize + windowPixel) * ChannelCount + channel]));
-							else
-								kernelWeight = scaledKernelPhasedLUTPixel[axis][(phaseIndex * windowSize + windowPixel) * ChannelCount + channel];
-
-							return kernelWeight * lineBuffer[(windowCoord - windowMinCoord[axis]) * ChannelCount + channel];
-						};
-
 						uint32_t phaseIndex = 0;
-						// TODO: this loop should probably get rewritten
-						for (auto& i=(localTexCoord[axis]=0); i<outExtentLayerCount[axis]; i++)
+						for (auto& i=(localTexCoord[axis]=0); i<axisOutExtent; i++)
 						{
 							// get output pixel
 							auto* const value = intermediateStorage[axis]+core::dot(static_cast<const core::vectorSIMDi32&>(intermediateStrides[axis]),localTexCoord)[0];
 
 							// do the filtering
-							float tmp = float(i)+0.5f;
-							int32_t windowCoord = kernel.getWindowMinCoord(tmp*fScale[axis], tmp);
-
-							for (auto ch = 0; ch < ChannelCount; ++ch)
-								value[ch] = getWeightedSample(windowCoord, phaseIndex, 0, ch);
+							const value_t* weights = phaseWeights.data()+phaseIndex*windowSize*ChannelCount;
+							const value_t* samples = lineBuffer+windowOffsets[i];
+							value_t accum[ChannelCount] = {};
+							for (auto h=0; h<windowSize; h++, weights+=ChannelCount, samples+=ChannelCount)
+							for (auto ch=0; ch<ChannelCount; ch++)
+								accum[ch] += weights[ch]*samples[ch];
+							std::copy_n(accum,ChannelCount,value);
 
-							for (auto h=1; h<windowSize; h++)
-							{
-								windowCoord++;
-
-								for (auto ch = 0; ch < ChannelCount; ch++)
-									value[ch] += getWeightedSample(windowCoord, phaseIndex, h, ch);
-							}
 							if (lastPass)
 							{
 								const core::vectorSIMDu32 localOutPos = localTexCoord+outOffsetBaseLayer+vLayer;
@@ -0,0 +1,313 @@
+// Copyright (C) 2018-2023 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef _NBL_ASSET_C_STREAMING_MIP_MAP_GENERATION_FILTER_H_INCLUDED_
+#define _NBL_ASSET_C_STREAMING_MIP_MAP_GENERATION_FILTER_H_INCLUDED_
+
+#include "nbl/core/declarations.h"
+#include "nbl/core/execution.h"
+
+#include <functional>
+#include <numeric>
+
+#include "nbl/system/IFile.h"
+
+#include "nbl/asset/filters/IImageFilter.h"
+#include "nbl/asset/format/decodePixels.h"
+#include "nbl/asset/format/encodePixels.h"
+
+namespace nbl::asset
+{
+
+//! Out-of-core counterpart of `CMipMapGenerationImageFilter` for 2D images which don't fit in memory.
+/** The base level is never resident as a whole, its rows get pulled from an `IRowSource` one band at a time,
+* and every level gets produced row by row in a single pass: each finished row immediately gets reduced into the accumulator
+* of the next level, so all levels advance together and finished bands of rows are pushed out to the sink.
+* The memory used is a couple of bands of rows per level, so it's independent of the image height and only linear in its width.
+*
+* The reduction is a 2x2 box filter (odd extents fold their last row/column into the last output texel), which is exact
+* for hierarchical application, unlike the kernels `CMipMapGenerationImageFilter` can use.
+* Only non-integer, non block compressed formats are supported, decoding and encoding goes through `double`.
+*/
+class CStreamingMipMapGenerationFilter
+{
+	public:
+		using value_t = double;
+		static inline constexpr uint32_t MaxChannels = 4u;
+		//! rows narrower than this get reduced on the calling thread
+		static inline constexpr uint32_t MinParallelRowWidth = 4096u;
+
+		//! Provides rows of the base level on demand
+		class IRowSource
+		{
+			public:
+				virtual ~IRowSource() = default;
+
+				//! Reads `rowCount` rows starting at `firstRow` into `dst`, the rows are tightly packed texels of the state's `format`, `dstRowPitch` bytes apart
+				virtual bool readRows(const uint32_t firstRow, const uint32_t rowCount, void* dst, const size_t dstRowPitch) = 0;
+		};
+		//! Rows stored `rowPitch` bytes apart in a file starting at `byteOffset`.
+		//! Copies straight out of the file's mapping if it has one (pages only get faulted in when their band is read), otherwise reads band by band.
+		class CFileRowSource final : public IRowSource
+		{
+			public:
+				CFileRowSource(core::smart_refctd_ptr<system::IFile>&& file, const size_t byteOffset, const size_t rowPitch)
+					: m_file(std::move(file)), m_byteOffset(byteOffset), m_rowPitch(rowPitch) {}
+
+				inline bool readRows(const uint32_t firstRow, const uint32_t rowCount, void* dst, const size_t dstRowPitch) override
+				{
+					if (!m_file)
+						return false;
+					const size_t offset = m_byteOffset+size_t(firstRow)*m_rowPitch;
+					const size_t rowBytes = core::min(m_rowPitch,dstRowPitch);
+					if (offset+size_t(rowCount)*m_rowPitch>m_file->getSize())
+						return false;
+
+					auto* const out = reinterpret_cast<uint8_t*>(dst);
+					if (const auto* mapped=reinterpret_cast<const uint8_t*>(static_cast<const system::IFile*>(m_file.get())->getMappedPointer()))
+					{
+						for (uint32_t r=0u; r<rowCount; r++)
+							memcpy(out+r*dstRowPitch,mapped+offset+r*m_rowPitch,rowBytes);
+						return true;
+					}
+
+					system::IFile::success_t succ;
+					if (m_rowPitch==dstRowPitch)
+					{
+						m_file->read(succ,out,offset,size_t(rowCount)*m_rowPitch);
+						return bool(succ);
+					}
+					for (uint32_t r=0u; r<rowCount; r++)
+					{
+						m_file->read(succ,out+r*dstRowPitch,offset+r*m_rowPitch,rowBytes);
+						if (!succ)
+							return false;
+					}
+					return true;
+				}
+
+			private:
+				core::smart_refctd_ptr<system::IFile> m_file;
+				const size_t m_byteOffset;
+				const size_t m_rowPitch;
+		};
+
+		//! Receives finished bands of rows of the generated levels, tightly packed texels of the state's `format` and rows.
+		//! Bands of one level arrive in order, bands of different levels interleave. Returning false aborts the generation.
+		using sink_t = std::function<bool(const uint32_t mipLevel, const uint32_t firstRow, const uint32_t rowCount, const void* rows)>;
+
+		class CState : public IImageFilter::IState
+		{
+			public:
+				virtual ~CState() {}
+
+				E_FORMAT	format = EF_UNKNOWN;
+				//! extent of the base level
+				uint32_t	width = 0u;
+				uint32_t	height = 0u;
+				//! levels `[1,endMipLevel)` get generated, 0 means the full chain down to 1x1
+				uint32_t	endMipLevel = 0u;
+				//! how many rows get read from the source and handed to the sink at once
+				uint32_t	bandRowCount = 64u;
+				IRowSource*	source = nullptr;
+				sink_t		sink;
+		};
+		using state_type = CState;
+
+		static inline uint32_t getFullMipChainLength(const uint32_t width, const uint32_t height)
+		{
+			return hlsl::findMSB(core::max(width,height))+1u;
+		}
+
+		static inline bool validate(state_type* state)
+		{
+			if (!state || !state->source || !state->sink)
+				return false;
+			if (state->width==0u || state->height==0u || state->bandRowCount==0u)
+				return false;
+			if (state->endMipLevel>getFullMipChainLength(state->width,state->height))
+				return false;
+			if (state->endMipLevel==1u)
+				return false;
+
+			const auto format = state->format;
+			if (format==EF_UNKNOWN || isBlockCompressionFormat(format) || isIntegerFormat(format) || isPlanarFormat(format) || isDepthOrStencilFormat(format))
+				return false;
+			return true;
+		}
+
+		//! Upper bound of the bytes `execute` allocates, doesn't depend on the height of the image
+		static inline size_t getPeakMemoryByteSize(const state_type* state)
+		{
+			const size_t texelBytes = getTexelOrBlockBytesize(state->format);
+			const size_t channels = getFormatChannelCount(state->format);
+			const uint32_t endMipLevel = state->endMipLevel ? state->endMipLevel:getFullMipChainLength(state->width,state->height);
+
+			size_t retval = size_t(state->bandRowCount)*state->width*texelBytes+size_t(state->width)*channels*sizeof(value_t);
+			for (uint32_t level=1u; level<endMipLevel; level++)
+			{
+				const size_t width = core::max(state->width>>level,1u);
+				retval += size_t(state->bandRowCount)*width*texelBytes+width*(channels*sizeof(value_t)+sizeof(uint32_t));
+			}
+			return retval;
+		}
+
+		template<class ExecutionPolicy>
+		static inline bool execute(ExecutionPolicy&& policy, state_type* state)
+		{
+			if (!validate(state))
+				return false;
+
+			SContext ctx(state);
+			const uint32_t width = state->width;
+			const size_t rowPitch = size_t(width)*ctx.texelBytes;
+
+			core::vector<uint8_t> sourceBand(size_t(state->bandRowCount)*rowPitch);
+			core::vector<value_t> decodedRow(size_t(width)*ctx.channels);
+			core::vector<uint32_t> texelIndices(width);
+			std::iota(texelIndices.begin(),texelIndices.end(),0u);
+			for (uint32_t firstRow=0u; firstRow<state->height; firstRow+=state->bandRowCount)
+			{
+				const uint32_t rowCount = core::min(state->bandRowCount,state->height-firstRow);
+				if (!state->source->readRows(firstRow,rowCount,sourceBand.data(),rowPitch))
+					return false;
+
+				for (uint32_t r=0u; r<rowCount; r++)
+				{
+					const uint8_t* const srcRow = sourceBand.data()+r*rowPitch;
+					auto decode = [&](const uint32_t& x) -> void
+					{
+						const void* srcPix[4] = {srcRow+x*ctx.texelBytes,nullptr,nullptr,nullptr};
+						value_t decoded[MaxChannels];
+						decodePixelsRuntime(ctx.format,srcPix,decoded,0u,0u);
+						std::copy_n(decoded,ctx.channels,decodedRow.data()+x*ctx.channels);
+					};
+					if (width<MinParallelRowWidth)
+						std::for_each(texelIndices.begin(),texelIndices.end(),decode);
+					else
+						std::for_each(policy,texelIndices.begin(),texelIndices.end(),decode);
+
+					if (!ctx.pushRow(policy,0u,decodedRow.data()))
+						return false;
+				}
+			}
+			return true;
+		}
+		static inline bool execute(state_type* state)
+		{
+			return execute(core::execution::seq,state);
+		}
+
+	private:
+		struct SLevel
+		{
+			uint32_t width;
+			uint32_t height;
+			// rows of this level produced so far
+			uint32_t rowsProduced = 0u;
+			// sum of the horizontally reduced rows of the previous level contributing to the next row of this level
+			core::vector<value_t> accumulator;
+			uint32_t accumulatedRows = 0u;
+			// encoded rows waiting for the sink
+			core::vector<uint8_t> band;
+			uint32_t bandFirstRow = 0u;
+			uint32_t bandRows = 0u;
+			core::vector<uint32_t> texelIndices;
+		};
+
+		struct SContext
+		{
+			SContext(state_type* _state) : state(_state), format(_state->format), channels(getFormatChannelCount(_state->format)), texelBytes(getTexelOrBlockBytesize(_state->format))
+			{
+				const uint32_t endMipLevel = state->endMipLevel ? state->endMipLevel:getFullMipChainLength(state->width,state->height);
+				levels.resize(endMipLevel);
+				for (uint32_t l=0u; l<endMipLevel; l++)
+				{
+					auto& level = levels[l];
+					level.width = core::max(state->width>>l,1u);
+					level.height = core::max(state->height>>l,1u);
+					if (l==0u)
+						continue;
+					level.accumulator.resize(size_t(level.width)*channels,value_t(0));
+					level.band.resize(size_t(state->bandRowCount)*level.width*texelBytes);
+					level.texelIndices.resize(level.width);
+					std::iota(level.texelIndices.begin(),level.texelIndices.end(),0u);
+				}
+			}
+
+			//! output texel `o` of a level of `outSize` covers `[2o,2o+2)` of the previous, the last one also takes the odd leftover
+			static inline uint32_t lastContributor(const uint32_t o, const uint32_t inSize, const uint32_t outSize)
+			{
+				return o+1u==outSize ? (inSize-1u):(2u*o+1u);
+			}
+
+			//! `row` is the next finished row of level `l`, gets encoded if it's an output level and reduced into the level after
+			template<class ExecutionPolicy>
+			inline bool pushRow(ExecutionPolicy& policy, const uint32_t l, value_t* row)
+			{
+				auto& level = levels[l];
+				const uint32_t y = level.rowsProduced++;
+				auto forEachTexel = [&policy](const SLevel& lvl, auto&& f) -> void
+				{
+					if (lvl.width<MinParallelRowWidth)
+						std::for_each(lvl.texelIndices.begin(),lvl.texelIndices.end(),f);
+					else
+						std::for_each(policy,lvl.texelIndices.begin(),lvl.texelIndices.end(),f);
+				};
+
+				if (l!=0u)
+				{
+					uint8_t* const dstRow = level.band.data()+size_t(level.bandRows++)*level.width*texelBytes;
+					forEachTexel(level,[&](const uint32_t& x) -> void
+					{
+						encodePixelsRuntime(format,dstRow+x*texelBytes,row+x*channels);
+					});
+					if (level.bandRows==state->bandRowCount || level.rowsProduced==level.height)
+					{
+						if (!state->sink(l,level.bandFirstRow,level.bandRows,level.band.data()))
+							return false;
+						level.bandFirstRow += level.bandRows;
+						level.bandRows = 0u;
+					}
+				}
+
+				if (l+1u==levels.size())
+					return true;
+
+				auto& next = levels[l+1u];
+				forEachTexel(next,[&](const uint32_t& x) -> void
+				{
+					const uint32_t end = lastContributor(x,level.width,next.width)+1u;
+					const value_t rcpCount = value_t(1)/value_t(end-core::min(2u*x,level.width-1u));
+					value_t* const acc = next.accumulator.data()+x*channels;
+					for (uint32_t i=core::min(2u*x,level.width-1u); i<end; i++)
+					for (uint32_t c=0u; c<channels; c++)
+						acc[c] += row[i*channels+c]*rcpCount;
+				});
+				next.accumulatedRows++;
+
+				if (y!=lastContributor(next.rowsProduced,level.height,next.height))
+					return true;
+
+				const value_t rcpRows = value_t(1)/value_t(next.accumulatedRows);
+				for (auto& value : next.accumulator)
+					value *= rcpRows;
+				if (!pushRow(policy,l+1u,next.accumulator.data()))
+					return false;
+				std::fill(next.accumulator.begin(),next.accumulator.end(),value_t(0));
+				next.accumulatedRows = 0u;
+				return true;
+			}
+
+			state_type* const state;
+			const E_FORMAT format;
+			const uint32_t channels;
+			const uint32_t texelBytes;
+			core::vector<SLevel> levels;
+		};
+};
+
+} // end namespace nbl::asset
+
+#endif
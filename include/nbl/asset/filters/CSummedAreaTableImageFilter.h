@@ -9,6 +9,7 @@
 
 #include <type_traits>
 #include <functional>
+#include <numeric>
 
 #include "nbl/asset/filters/CMatchedSizeInOutImageFilterCommon.h"
 #include "CConvertFormatImageFilter.h"
@@ -127,6 +128,18 @@ class CSummedAreaTableImageFilter : public CMatchedSizeInOutImageFilterCommon, p
 		}
 
 	private:
+		//! the Y and Z prefix sums get split into blocks of this many scratch values for the threads
+		static inline constexpr size_t ScanBlockElements = 1024ull;
+
+		//! with `Channels` known at compile time the running sum of a whole texel stays in registers and the channels get added together
+		template<uint32_t Channels, typename decodeType>
+		static inline void inclusiveScanTexels(decodeType* texels, const uint32_t texelCount)
+		{
+			decodeType carry[Channels] = {};
+			for (uint32_t x = 0u; x < texelCount; ++x, texels += Channels)
+			for (uint32_t c = 0u; c < Channels; ++c)
+				texels[c] = (carry[c] += texels[c]);
+		}
 
 		template<class ExecutionPolicy, typename decodeType> //!< double or uint64_t
 		static inline bool executeInterprated(ExecutionPolicy&& policy, state_type* state, decodeType* scratchMemory)
@@ -182,11 +195,15 @@ class CSummedAreaTableImageFilter : public CMatchedSizeInOutImageFilterCommon, p
 				state->layerCount = copyLayerCount;
 			};
 
-			for (uint16_t w = 0u; w < copyLayerCount; ++w) // this could be parallelized
-			{
-				std::array<decodeType, maxChannels> minDecodeValues = {};
-				std::array<decodeType, maxChannels> maxDecodeValues = {};
+			// the scratch is tightly packed, so every (y,z) row of texels is contiguous
+			const size_t rowElements = size_t(state->extent.width)*currentChannelCount;
+			const size_t sliceElements = rowElements*state->extent.height;
+			const uint32_t rowCount = state->extent.height*state->extent.depth;
+			core::vector<uint32_t> rows(rowCount);
+			std::iota(rows.begin(), rows.end(), 0u);
 
+			for (uint16_t w = 0u; w < copyLayerCount; ++w) // layers share the scratch, the parallelism is within a layer
+			{
 				{
 					const uint8_t* inData = reinterpret_cast<const uint8_t*>(state->inImage->getBuffer()->getPointer());
 					const auto blockDims = asset::getBlockDimensions(state->inImage->getCreationParameters().format);
@@ -249,138 +266,123 @@ class CSummedAreaTableImageFilter : public CMatchedSizeInOutImageFilterCommon, p
 
 					if constexpr (ExclusiveMode)
 					{
-						core::vector3du32_SIMD localCoord;
-						for (auto& z = localCoord[2] = 0u; z < state->extent.depth; ++z) // TODO: parallelize
-							for (auto& y = localCoord[1] = 0u; y < state->extent.height; ++y)
-								for (auto& x = localCoord[0] = 0u; x < state->extent.width; ++x)
-								{
-									auto resetSATMemory = [&](const core::vector3du32_SIMD& position)
-									{
-										const size_t offset = asset::IImage::SBufferCopy::getLocalByteOffset(position, scratchByteStrides);
-										memset(reinterpret_cast<uint8_t*>(scratchMemory) + offset, 0, scratchTexelByteSize);
-									};
-
-									const auto doesItMoveOnYZorXZorXY = (localCoord < movingOnYZorXZorXYCheckingVector);
-									if (doesItMoveOnYZorXZorXY.any())
-										resetSATMemory(localCoord);
-								}
+						// the first texel of every row, and whole rows of the first row/slice, didn't get written by the shifted decode
+						std::for_each(policy, rows.begin(), rows.end(), [&](const uint32_t& row) -> void
+						{
+							const uint32_t y = row%state->extent.height;
+							const uint32_t z = row/state->extent.height;
+							decodeType* const rowScratch = scratchMemory+row*rowElements;
+							if (y<movingOnYZorXZorXYCheckingVector.y || z<movingOnYZorXZorXYCheckingVector.z)
+								std::fill_n(rowScratch, rowElements, decodeType(0));
+							else
+								std::fill_n(rowScratch, currentChannelCount, decodeType(0));
+						});
 					}
 				}
 
 				{
-					auto getScratchPixel = [&](core::vector4di32_SIMD readBlockPos) -> decodeType*
-					{
-						const size_t scratchOffset = asset::IImage::SBufferCopy::getLocalByteOffset(core::vector3du32_SIMD(readBlockPos.x, readBlockPos.y, readBlockPos.z, 0), scratchByteStrides);
-						return reinterpret_cast<decodeType*>(reinterpret_cast<uint8_t*>(scratchMemory) + scratchOffset);
-					};
-
-					auto sum = [&](core::vectorSIMDi32 readBlockPos) -> void
-					{
-						decodeType* current = getScratchPixel(readBlockPos);
-
-						auto areAxisSafe = [&]()
-						{
-							const auto position = core::vectorSIMDi32(0u, 0u, 0u, 0u);
-
-							const bool shouldSumX = (state->axesToSum >> 0) & 0x1u;
-							const bool shouldSumY = (state->axesToSum >> 1) & 0x1u;
-							const bool shouldSumZ = (state->axesToSum >> 2) & 0x1u;
-
-							return core::vector4du32_SIMD
-							(
-								(readBlockPos.x > position.x) && (shouldSumX),
-								(readBlockPos.y > position.y) && (shouldSumY),
-								(readBlockPos.z > position.z) && (shouldSumZ),
-								(readBlockPos.w > position.w)
-							);
-						};
+					/*
+						The SAT is separable, so instead of an inclusion-exclusion sweep with a dependency on 7 neighbours
+						it's built as independent prefix sums along each summed axis in turn.
+						X runs along the rows (all rows in parallel), Y and Z add whole previous rows/slices
+						which is contiguous and trivially vectorizable, with the columns split into blocks for parallelism.
+					*/
+					const bool shouldSumX = (state->axesToSum >> 0) & 0x1u;
+					const bool shouldSumY = (state->axesToSum >> 1) & 0x1u;
+					const bool shouldSumZ = (state->axesToSum >> 2) & 0x1u;
 
-						auto addScratchPixelToCurrentOne = [&](const decodeType* values)
+					if (shouldSumX)
+						std::for_each(policy, rows.begin(), rows.end(), [&](const uint32_t& row) -> void
 						{
-							for (auto i = 0; i < currentChannelCount; ++i)
-								current[i] += values[i];
-						};
-						
-						auto substractScratchPixelFromCurrentOne = [&](const decodeType* values)
-						{
-							for (auto i = 0; i < currentChannelCount; ++i)
-								current[i] -= values[i];
-						};
-
-						const auto axisSafe = areAxisSafe();
+							decodeType* const rowScratch = scratchMemory+row*rowElements;
+							switch (currentChannelCount)
+							{
+								case 1:
+									inclusiveScanTexels<1u>(rowScratch, state->extent.width);
+									break;
+								case 2:
+									inclusiveScanTexels<2u>(rowScratch, state->extent.width);
+									break;
+								case 3:
+									inclusiveScanTexels<3u>(rowScratch, state->extent.width);
+									break;
+								default:
+									inclusiveScanTexels<4u>(rowScratch, state->extent.width);
+									break;
+							}
+						});
 
-						if (axisSafe.z)
-							addScratchPixelToCurrentOne(getScratchPixel(readBlockPos - core::vectorSIMDi32(0, 0, 1, 0)));					// add box x<=current_x && y<=current_y && z<current_z
-						if (axisSafe.y)
+					auto scanLines = [&](const size_t lineElements, const uint32_t lineCount, const uint32_t groupCount, const size_t groupStride) -> void
+					{
+						if (lineCount<2u)
+							return;
+						const size_t blocksPerLine = (lineElements+ScanBlockElements-1ull)/ScanBlockElements;
+						core::vector<size_t> blocks(blocksPerLine*groupCount);
+						std::iota(blocks.begin(), blocks.end(), 0ull);
+						std::for_each(policy, blocks.begin(), blocks.end(), [&](const size_t& block) -> void
 						{
-							addScratchPixelToCurrentOne(getScratchPixel(readBlockPos - core::vectorSIMDi32(0, 1, 0, 0)));					// add box x<=current_x && y<current_y && z<=current_z
-							if (axisSafe.z)
-								substractScratchPixelFromCurrentOne(getScratchPixel(readBlockPos - core::vectorSIMDi32(0, 1, 1, 0)));		// remove overlap box x<=current_x && y<current_y && z<current_z
-						}
-
-						/*
-							Now I have the sum of all layers below me in the bound x<=current_x && y<=current_y && z<current_z and the current pixel.
-							Time to add the missing top layer pixels.
-						*/
+							const size_t begin = (block%blocksPerLine)*ScanBlockElements;
+							const size_t end = core::min(begin+ScanBlockElements, lineElements);
+							decodeType* line = scratchMemory+(block/blocksPerLine)*groupStride;
+							for (uint32_t l = 1u; l < lineCount; ++l)
+							{
+								const decodeType* const prevLine = line;
+								line += lineElements;
+								for (size_t i = begin; i < end; ++i)
+									line[i] += prevLine[i];
+							}
+						});
+					};
+					if (shouldSumY)
+						scanLines(rowElements, state->extent.height, state->extent.depth, sliceElements);
+					if (shouldSumZ)
+						scanLines(sliceElements, state->extent.depth, 1u, 0ull);
 
-						if (axisSafe.x)
+					bool normalized = asset::isNormalizedFormat(inFormat);
+					if (state->normalizeImageByTotalSATValues || normalized)
+					{
+						std::array<decodeType, maxChannels> minDecodeValues = {};
+						std::array<decodeType, maxChannels> maxDecodeValues = {};
 						{
-							addScratchPixelToCurrentOne(getScratchPixel(readBlockPos - core::vectorSIMDi32(1, 0, 0, 0)));					 // add box x<current_x && y<=current_y && z<=current_z
-							if (axisSafe.z)
-								substractScratchPixelFromCurrentOne(getScratchPixel(readBlockPos - core::vectorSIMDi32(1, 0, 1, 0)));		 // remove overlap box x<current_x && y<=current_y && z<current_z
-							if (axisSafe.y)
+							core::vector<std::array<decodeType, maxChannels>> rowMin(rowCount), rowMax(rowCount);
+							std::for_each(policy, rows.begin(), rows.end(), [&](const uint32_t& row) -> void
+							{
+								auto& localMin = rowMin[row];
+								auto& localMax = rowMax[row];
+								localMin.fill(decodeType(0));
+								localMax.fill(decodeType(0));
+								const decodeType* const rowScratch = scratchMemory+row*rowElements;
+								for (size_t i = 0ull; i < rowElements; ++i)
+								{
+									const auto channel = i%currentChannelCount;
+									localMin[channel] = core::min(localMin[channel], rowScratch[i]);
+									localMax[channel] = core::max(localMax[channel], rowScratch[i]);
+								}
+							});
+							for (uint32_t row = 0u; row < rowCount; ++row)
+							for (uint8_t channel = 0; channel < currentChannelCount; ++channel)
 							{
-								substractScratchPixelFromCurrentOne(getScratchPixel(readBlockPos - core::vectorSIMDi32(1, 1, 0, 0)));		 // remove future overlap box x<current_x && y<current_y && z<=current_z
-								if (axisSafe.z)
-									addScratchPixelToCurrentOne(getScratchPixel(readBlockPos - core::vectorSIMDi32(1, 1, 1, 0)));			 // add box x<current_x && y<current_y && z<current_z
+								minDecodeValues[channel] = core::min(minDecodeValues[channel], rowMin[row][channel]);
+								maxDecodeValues[channel] = core::max(maxDecodeValues[channel], rowMax[row][channel]);
 							}
 						}
 
-						std::for_each(current, current + currentChannelCount,
-							[&](const decodeType& itrValue)
+						const bool isSigned = asset::isSignedFormat(inFormat);
+						std::for_each(policy, rows.begin(), rows.end(), [&](const uint32_t& row) -> void
+						{
+							decodeType* entryScratchAdress = scratchMemory+row*rowElements;
+							for (uint32_t x = 0u; x < state->extent.width; ++x, entryScratchAdress += currentChannelCount)
 							{
-								uint8_t offset = &itrValue - current;
-
-								if (maxDecodeValues[offset] < itrValue)
-									maxDecodeValues[offset] = itrValue;
-
-								if (minDecodeValues[offset] > itrValue)
-									minDecodeValues[offset] = itrValue;
+								if (isSigned)
+									for (uint8_t channel = 0; channel < currentChannelCount; ++channel)
+										entryScratchAdress[channel] = (2.0 * entryScratchAdress[channel] - maxDecodeValues[channel] - minDecodeValues[channel]) / (maxDecodeValues[channel] - minDecodeValues[channel]);
+								else
+									for (uint8_t channel = 0; channel < currentChannelCount; ++channel)
+										entryScratchAdress[channel] = (entryScratchAdress[channel] - minDecodeValues[channel]) / (maxDecodeValues[channel] - minDecodeValues[channel]);
 							}
-						);
-					};
-
-					{
-						core::vector3du32_SIMD localCoord;
-						for (auto& z = localCoord[2] = 0u; z < state->extent.depth; ++z)  // TODO: parallelize (will be tough!)
-							for (auto& y = localCoord[1] = 0u; y < state->extent.height; ++y)
-								for (auto& x = localCoord[0] = 0u; x < state->extent.width; ++x)
-									sum(core::vectorSIMDu32(x, y, z));
+						});
 					}
 
-					auto normalizeScratch = [&](bool isSignedFormat)
-					{
-						core::vector3du32_SIMD localCoord;
-							for (auto& z = localCoord[2] = 0u; z < state->extent.depth; ++z) // TODO: parallelize
-								for (auto& y = localCoord[1] = 0u; y < state->extent.height; ++y)
-									for (auto& x = localCoord[0] = 0u; x < state->extent.width; ++x)
-									{
-										const size_t scratchOffset = asset::IImage::SBufferCopy::getLocalByteOffset(localCoord, scratchByteStrides);
-										decodeType* entryScratchAdress = reinterpret_cast<decodeType*>(reinterpret_cast<uint8_t*>(scratchMemory) + scratchOffset);
-
-										if(isSignedFormat)
-											for (uint8_t channel = 0; channel < currentChannelCount; ++channel)
-												entryScratchAdress[channel] = (2.0 * entryScratchAdress[channel] - maxDecodeValues[channel] - minDecodeValues[channel]) / (maxDecodeValues[channel] - minDecodeValues[channel]);
-										else
-											for (uint8_t channel = 0; channel < currentChannelCount; ++channel)
-												entryScratchAdress[channel] = (entryScratchAdress[channel] - minDecodeValues[channel]) / (maxDecodeValues[channel] - minDecodeValues[channel]);
-									}
-					};
-
-					bool normalized = asset::isNormalizedFormat(inFormat);
-					if (state->normalizeImageByTotalSATValues || normalized)
-						normalizeScratch(asset::isSignedFormat(inFormat));
-
 					{
 						uint8_t* outData = reinterpret_cast<uint8_t*>(state->outImage->getBuffer()->getPointer());
 
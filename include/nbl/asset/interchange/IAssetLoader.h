@@ -88,7 +88,9 @@ class NBL_API2 IAssetLoader : public virtual core::IReferenceCounted
 			ELPF_NONE = 0,											//!< default value, it doesn't do anything
 			ELPF_RIGHT_HANDED_MESHES = 0x1,							//!< specifies that a mesh will be flipped in such a way that it'll look correctly in right-handed camera system
 			ELPF_DONT_COMPILE_GLSL = 0x2,							//!< it states that GLSL won't be compiled to SPIR-V if it is loaded or generated
-			ELPF_LOAD_METADATA_ONLY = 0x4							//!< it forces the loader to not load the entire scene for performance in special cases to fetch metadata.
+			ELPF_LOAD_METADATA_ONLY = 0x4,							//!< it forces the loader to not load the entire scene for performance in special cases to fetch metadata.
+			ELPF_ALLOW_FILE_MAPPING_REFERENCES = 0x8,				//!< loaders may return buffers referencing the (read-only) mapping of the file instead of a copy, such buffers keep the file open and must not be written to
+			ELPF_WELD_VERTICES = 0x10								//!< loaders of formats without an index buffer (like STL) merge bitwise identical vertices and create one
 		};
 
 		struct SAssetLoadParams
@@ -108,6 +110,7 @@ class NBL_API2 IAssetLoader : public virtual core::IReferenceCounted
 				cacheFlags(rhs.cacheFlags),
 				loaderFlags(rhs.loaderFlags),
 				meshManipulatorOverride(rhs.meshManipulatorOverride),
+				baseMipLevel(rhs.baseMipLevel),
 				logger(rhs.logger),
 				workingDirectory(rhs.workingDirectory)
 			{
@@ -118,6 +121,7 @@ class NBL_API2 IAssetLoader : public virtual core::IReferenceCounted
 			E_CACHING_FLAGS cacheFlags;
 			E_LOADER_PARAMETER_FLAGS loaderFlags;				//!< Flags having an impact on extraordinary tasks during loading process
 			IMeshManipulator* meshManipulatorOverride = nullptr;    //!< pointer used for specifying custom mesh manipulator to use, if nullptr - default mesh manipulator will be used
+			uint32_t baseMipLevel = 0u;							//!< image loaders which can (KTX2, DDS) skip the mip levels above this one and return an image starting at it, the cache is keyed by filename only so use ECF_DUPLICATE_TOP_LEVEL when it's not 0
 			std::filesystem::path workingDirectory = "";
 			system::logger_opt_ptr logger;
 		};
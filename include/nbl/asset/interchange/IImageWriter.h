@@ -11,6 +11,7 @@
 
 #include "nbl/asset/interchange/IImageAssetHandlerBase.h"
 #include "nbl/asset/interchange/IAssetWriter.h"
+#include "nbl/asset/interchange/SImageWriteParams.h"
 
 #include "nbl/asset/filters/CFlattenRegionsImageFilter.h"
 
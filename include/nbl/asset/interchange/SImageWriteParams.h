@@ -0,0 +1,105 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef _NBL_ASSET_S_IMAGE_WRITE_PARAMS_H_INCLUDED_
+#define _NBL_ASSET_S_IMAGE_WRITE_PARAMS_H_INCLUDED_
+
+#include <cstdint>
+
+namespace nbl::asset
+{
+
+//! Writer dependent parameters get passed as `SAssetWriteParams::userData`, every such struct begins with this header
+//! so a writer can tell whether the `userData` it got was meant for it, and ignores it otherwise.
+struct SWriteParamsHeader
+{
+	//! FourCC of the writer the parameters are for
+	uint32_t type;
+	//! `sizeof` the whole struct, guards against mismatched versions of it
+	uint32_t size;
+
+	//! returns nullptr if `userData` is null or isn't a `T`
+	template<class T>
+	static inline const T* cast(const void* userData)
+	{
+		const auto* header = reinterpret_cast<const SWriteParamsHeader*>(userData);
+		if (!header || header->type!=T::Type || header->size!=sizeof(T))
+			return nullptr;
+		return reinterpret_cast<const T*>(userData);
+	}
+};
+
+//! Parameters of the PNG writer
+/** Without them the defaults are used, with the zlib level taken from `SAssetWriteParams::compressionLevel` if it's not 0. */
+struct SPNGWriteParams
+{
+	static inline constexpr uint32_t Type = 0x20474e50u; // "PNG "
+
+	//! same values as zlib's strategies
+	enum E_STRATEGY : int32_t
+	{
+		ES_DEFAULT = 0,
+		ES_FILTERED = 1,
+		ES_HUFFMAN_ONLY = 2,
+		ES_RLE = 3,
+		ES_FIXED = 4
+	};
+	//! row filter, `ERF_ADAPTIVE` picks the one with the smallest sum of absolute differences for every row
+	enum E_ROW_FILTER : uint8_t
+	{
+		ERF_NONE = 0,
+		ERF_SUB,
+		ERF_UP,
+		ERF_AVERAGE,
+		ERF_PAETH,
+		ERF_ADAPTIVE
+	};
+
+	SWriteParamsHeader header = {Type,sizeof(SPNGWriteParams)};
+	//! zlib level from 0 (store) to 9 (smallest), -1 is zlib's default (6)
+	int32_t compressionLevel = -1;
+	E_STRATEGY strategy = ES_DEFAULT;
+	E_ROW_FILTER filter = ERF_ADAPTIVE;
+	//! Filters the rows and deflates groups of them on all threads into one zlib stream, like pigz does.
+	//! Every group is primed with the 32kB of data before it, so the ratio is barely worse than a single threaded deflate.
+	bool parallel = true;
+	//! approximate amount of filtered image data per group
+	uint32_t bytesPerGroup = 0x1u<<20u;
+	//! writes to the file are batched up to this size
+	uint32_t outputBufferSize = 0x1u<<20u;
+};
+
+//! Parameters of the OpenEXR writer
+struct SOpenEXRWriteParams
+{
+	static inline constexpr uint32_t Type = 0x20525845u; // "EXR "
+
+	//! same values as `Imf::Compression`
+	enum E_COMPRESSION : uint8_t
+	{
+		EC_NONE = 0,
+		EC_RLE,
+		EC_ZIPS,
+		EC_ZIP,
+		EC_PIZ,
+		EC_PXR24,
+		EC_B44,
+		EC_B44A,
+		EC_DWAA,
+		EC_DWAB
+	};
+
+	SWriteParamsHeader header = {Type,sizeof(SOpenEXRWriteParams)};
+	E_COMPRESSION compression = EC_ZIP;
+	//! threads compressing the scanline blocks or tiles, 0 means as many as the hardware has
+	uint32_t threadCount = 0u;
+	//! 0 writes scanlines, otherwise square tiles of this size
+	uint32_t tileSize = 0u;
+	//! writes to the file are batched up to this size
+	uint32_t outputBufferSize = 0x1u<<20u;
+};
+
+}
+
+#endif
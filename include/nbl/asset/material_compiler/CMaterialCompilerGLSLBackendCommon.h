@@ -708,6 +708,18 @@ public:
 		//one element for each input IR root node
 		core::unordered_map<const IR::INode*, instr_streams_t> streams;
 
+		//structurally identical IR roots (found by Merkle hashing) share a single set of instruction streams
+		struct dedup_stats_t
+		{
+			inline uint32_t uniqueRootCount() const { return rootCount-dedupedRootCount; }
+
+			uint32_t rootCount = 0u;
+			uint32_t dedupedRootCount = 0u;
+			//how many instructions the buffers would have additionally held without deduplication
+			size_t instructionsSaved = 0ull;
+			size_t prefetchInstructionsSaved = 0ull;
+		} dedupStats;
+
 		//has to go after #version and before required user-provided descriptors and functions
 		std::string fragmentShaderSource_declarations;
 		//has to go after required user-provided descriptors and functions and before the rest of shader (especially entry point function)
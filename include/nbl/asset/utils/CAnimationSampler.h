@@ -0,0 +1,253 @@
+// Copyright (C) 2018-2023 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_ASSET_C_ANIMATION_SAMPLER_H_INCLUDED_
+#define _NBL_ASSET_C_ANIMATION_SAMPLER_H_INCLUDED_
+
+#include "nbl/core/declarations.h"
+#include "nbl/core/execution.h"
+
+#include "nbl/asset/ICPUAnimationLibrary.h"
+#include "nbl/asset/ICPUSkeleton.h"
+
+namespace nbl::asset
+{
+
+//! CPU evaluator of skeletal animations, the counterpart of the GPU animation blends for simulation and tooling.
+/** Binds one animation of an `ICPUAnimationLibrary` to every joint of an `ICPUSkeleton` and then samples
+* any number of instances of that skeleton at their own timestamps, producing the global (model space) joint transforms.
+* Joints get visited parents-first, so the local to global propagation is a single in-place pass per instance.
+*/
+class CAnimationSampler final : public core::IReferenceCounted
+{
+	public:
+		using joint_id_t = ICPUSkeleton::joint_id_t;
+		using animation_t = ICPUAnimationLibrary::animation_t;
+		using timestamp_t = ICPUAnimationLibrary::timestamp_t;
+
+		//! `jointAnimations` holds one animation per joint of the skeleton, an animation `>=library->getAnimationCapacity()` makes the joint keep its default transform.
+		//! Returns nullptr if the parent IDs have a cycle.
+		static inline core::smart_refctd_ptr<CAnimationSampler> create(core::smart_refctd_ptr<const ICPUSkeleton>&& skeleton, core::smart_refctd_ptr<const ICPUAnimationLibrary>&& library, const std::span<const animation_t> jointAnimations)
+		{
+			if (!skeleton || !library)
+				return nullptr;
+			const joint_id_t jointCount = skeleton->getJointCount();
+			if (jointAnimations.size()!=jointCount)
+				return nullptr;
+
+			core::vector<SJoint> joints(jointCount);
+			for (joint_id_t j=0u; j<jointCount; j++)
+			{
+				auto& joint = joints[j];
+				joint.parent = skeleton->getParentJointID(j);
+				if (joint.parent>=jointCount)
+					joint.parent = ICPUSkeleton::invalid_joint_id;
+				const animation_t animation = jointAnimations[j];
+				if (animation<library->getAnimationCapacity())
+				{
+					const auto& anim = library->getAnimation(animation);
+					joint.keyframeOffset = anim.getKeyframeOffset();
+					joint.keyframeCount = anim.getKeyframeCount();
+					joint.interpolation = anim.getInterpolationMode();
+				}
+			}
+
+			// parents before children, roots in their original order
+			core::vector<joint_id_t> order;
+			order.reserve(jointCount);
+			{
+				core::vector<uint32_t> childCount(jointCount+1u,0u);
+				for (const auto& joint : joints)
+				if (joint.parent!=ICPUSkeleton::invalid_joint_id)
+					childCount[joint.parent]++;
+				// exclusive prefix sum gives the start of every joint's children
+				core::vector<uint32_t> childOffset(jointCount+1u,0u);
+				for (joint_id_t j=0u; j<jointCount; j++)
+					childOffset[j+1u] = childOffset[j]+childCount[j];
+				core::vector<joint_id_t> children(childOffset[jointCount]);
+				for (joint_id_t j=0u; j<jointCount; j++)
+				if (joints[j].parent!=ICPUSkeleton::invalid_joint_id)
+					children[childOffset[joints[j].parent]+(--childCount[joints[j].parent])] = j;
+
+				for (joint_id_t j=0u; j<jointCount; j++)
+				if (joints[j].parent==ICPUSkeleton::invalid_joint_id)
+					order.push_back(j);
+				for (size_t i=0ull; i<order.size(); i++)
+				{
+					const joint_id_t j = order[i];
+					order.insert(order.end(),children.begin()+childOffset[j],children.begin()+childOffset[j+1u]);
+				}
+				// joints that never got reached are part of a cycle
+				if (order.size()!=jointCount)
+					return nullptr;
+			}
+
+			return core::smart_refctd_ptr<CAnimationSampler>(new CAnimationSampler(std::move(skeleton),std::move(library),std::move(joints),std::move(order)),core::dont_grab);
+		}
+
+		inline joint_id_t getJointCount() const {return m_joints.size();}
+		inline const ICPUSkeleton* getSkeleton() const {return m_skeleton.get();}
+		inline const ICPUAnimationLibrary* getAnimationLibrary() const {return m_library.get();}
+
+		//! Samples every instance at `times[i]` and writes its `getJointCount()` global joint transforms at `outGlobalTransforms+i*getJointCount()`.
+		/** `keyframeCursors` is per-instance per-joint state of the same layout, zero it once and keep passing it back,
+		* then a time that moved forward by less than a keyframe costs a comparison instead of a binary search.
+		* Instances are independent and get spread over the `policy`.
+		*/
+		template<class ExecutionPolicy>
+		inline void sample(ExecutionPolicy&& policy, const std::span<const timestamp_t> times, const std::span<uint32_t> keyframeCursors, core::matrix3x4SIMD* outGlobalTransforms) const
+		{
+			const uint32_t jointCount = getJointCount();
+			assert(keyframeCursors.size()>=times.size()*jointCount);
+			std::for_each(std::forward<ExecutionPolicy>(policy),times.begin(),times.end(),[&](const timestamp_t& time) -> void
+			{
+				const size_t instance = std::distance(times.data(),&time);
+				sample(time,keyframeCursors.data()+instance*jointCount,outGlobalTransforms+instance*jointCount);
+			});
+		}
+		inline void sample(const std::span<const timestamp_t> times, const std::span<uint32_t> keyframeCursors, core::matrix3x4SIMD* outGlobalTransforms) const
+		{
+			sample(core::execution::par_unseq,times,keyframeCursors,outGlobalTransforms);
+		}
+
+		//! Single instance version, `keyframeCursors` and `outGlobalTransforms` have `getJointCount()` elements.
+		inline void sample(const timestamp_t time, uint32_t* keyframeCursors, core::matrix3x4SIMD* outGlobalTransforms) const
+		{
+			const timestamp_t* const timestamps = &m_library->getTimestamp(0u);
+			const uint32_t jointCount = getJointCount();
+			for (joint_id_t j=0u; j<jointCount; j++)
+				outGlobalTransforms[j] = sampleLocal(m_joints[j],timestamps,time,keyframeCursors[j],j);
+			for (const joint_id_t j : m_order)
+			{
+				const joint_id_t parent = m_joints[j].parent;
+				if (parent!=ICPUSkeleton::invalid_joint_id)
+					outGlobalTransforms[j] = core::matrix3x4SIMD::concatenateBFollowedByA(outGlobalTransforms[parent],outGlobalTransforms[j]);
+			}
+		}
+
+	protected:
+		struct SJoint
+		{
+			joint_id_t parent = ICPUSkeleton::invalid_joint_id;
+			ICPUAnimationLibrary::keyframe_t keyframeOffset = 0u;
+			uint32_t keyframeCount = 0u;
+			ICPUAnimationLibrary::Animation::E_INTERPOLATION_MODE interpolation = ICPUAnimationLibrary::Animation::EIM_NEAREST;
+		};
+
+		CAnimationSampler(core::smart_refctd_ptr<const ICPUSkeleton>&& skeleton, core::smart_refctd_ptr<const ICPUAnimationLibrary>&& library, core::vector<SJoint>&& joints, core::vector<joint_id_t>&& order)
+			: m_skeleton(std::move(skeleton)), m_library(std::move(library)), m_joints(std::move(joints)), m_order(std::move(order)) {}
+		~CAnimationSampler() = default;
+
+		//! index of the last keyframe not after `time` (or 0 if all are after), starting the search from `cursor` and updating it
+		static inline uint32_t findKeyframe(const timestamp_t* timestamps, const uint32_t keyframeCount, const timestamp_t time, uint32_t& cursor)
+		{
+			uint32_t k = core::min(cursor,keyframeCount-1u);
+			if (timestamps[k]<=time)
+			{
+				// common case of playing forward, stay or step to the next keyframe before giving up and searching the rest
+				if (k+1u<keyframeCount && timestamps[k+1u]<=time)
+				{
+					k++;
+					if (k+1u<keyframeCount && timestamps[k+1u]<=time)
+						k = std::distance(timestamps,std::upper_bound(timestamps+k+1u,timestamps+keyframeCount,time))-1u;
+				}
+			}
+			else
+			{
+				const auto found = std::upper_bound(timestamps,timestamps+k,time);
+				k = found!=timestamps ? (std::distance(timestamps,found)-1u):0u;
+			}
+			cursor = k;
+			return k;
+		}
+
+		inline core::matrix3x4SIMD sampleLocal(const SJoint& joint, const timestamp_t* allTimestamps, const timestamp_t time, uint32_t& cursor, const joint_id_t jointID) const
+		{
+			if (!joint.keyframeCount)
+				return m_skeleton->getDefaultTransformMatrix(jointID);
+
+			const timestamp_t* const timestamps = allTimestamps+joint.keyframeOffset;
+			const uint32_t k = findKeyframe(timestamps,joint.keyframeCount,time,cursor);
+			const auto& first = m_library->getKeyframe(joint.keyframeOffset+k);
+
+			core::matrix3x4SIMD retval;
+			// clamped at both ends of the animation
+			if (k+1u>=joint.keyframeCount || time<=timestamps[k])
+			{
+				retval.setScaleRotationAndTranslation(first.getScale(),first.getRotation(),first.getTranslation());
+				return retval;
+			}
+
+			const auto& second = m_library->getKeyframe(joint.keyframeOffset+k+1u);
+			const float fraction = float(time-timestamps[k])/float(timestamps[k+1u]-timestamps[k]);
+			switch (joint.interpolation)
+			{
+				case ICPUAnimationLibrary::Animation::EIM_NEAREST:
+				{
+					const auto& nearest = fraction<0.5f ? first:second;
+					retval.setScaleRotationAndTranslation(nearest.getScale(),nearest.getRotation(),nearest.getTranslation());
+					break;
+				}
+				case ICPUAnimationLibrary::Animation::EIM_CUBIC:
+				{
+					// keyframes store no tangents, so they're Catmull-Rom ones from the neighbouring keyframes (one sided at the ends),
+					// scaled by the spacing so unevenly spaced keyframes don't overshoot
+					const uint32_t prevK = k ? (k-1u):k;
+					const uint32_t nextK = core::min(k+2u,joint.keyframeCount-1u);
+					const auto& prev = m_library->getKeyframe(joint.keyframeOffset+prevK);
+					const auto& next = m_library->getKeyframe(joint.keyframeOffset+nextK);
+					const float interval = float(timestamps[k+1u]-timestamps[k]);
+					const float firstTangentScale = interval/float(timestamps[k+1u]-timestamps[prevK]);
+					const float secondTangentScale = interval/float(timestamps[nextK]-timestamps[k]);
+					// Hermite basis
+					const float t2 = fraction*fraction;
+					const float t3 = t2*fraction;
+					const float h00 = 2.f*t3-3.f*t2+1.f;
+					const float h10 = t3-2.f*t2+fraction;
+					const float h01 = 3.f*t2-2.f*t3;
+					const float h11 = t3-t2;
+					auto hermite = [&](const core::vectorSIMDf& p0, const core::vectorSIMDf& p1, const core::vectorSIMDf& p2, const core::vectorSIMDf& p3) -> core::vectorSIMDf
+					{
+						return p1*h00+(p2-p0)*(firstTangentScale*h10)+p2*h01+(p3-p1)*(secondTangentScale*h11);
+					};
+
+					// rotations get put in the same hemisphere as their successor and renormalized after
+					auto getRotation = [](const auto& keyframe) -> core::vectorSIMDf
+					{
+						const auto q = keyframe.getRotation();
+						return reinterpret_cast<const core::vectorSIMDf&>(q);
+					};
+					core::vectorSIMDf rotations[4] = {getRotation(prev),getRotation(first),getRotation(second),getRotation(next)};
+					for (int32_t i=2; i>=0; i--)
+					if (core::dot(rotations[i],rotations[i+1])[0]<0.f)
+						rotations[i] = -rotations[i];
+					const core::vectorSIMDf rotation = core::normalize(hermite(rotations[0],rotations[1],rotations[2],rotations[3]));
+
+					retval.setScaleRotationAndTranslation(
+						hermite(prev.getScale(),first.getScale(),second.getScale(),next.getScale()),
+						reinterpret_cast<const core::quaternion&>(rotation),
+						hermite(prev.getTranslation(),first.getTranslation(),second.getTranslation(),next.getTranslation())
+					);
+					break;
+				}
+				default:
+				{
+					const core::vectorSIMDf scale = core::mix(first.getScale(),second.getScale(),core::vectorSIMDf(fraction));
+					const core::vectorSIMDf translation = core::mix(first.getTranslation(),second.getTranslation(),core::vectorSIMDf(fraction));
+					retval.setScaleRotationAndTranslation(scale,core::quaternion::flerp(first.getRotation(),second.getRotation(),fraction),translation);
+					break;
+				}
+			}
+			return retval;
+		}
+
+		core::smart_refctd_ptr<const ICPUSkeleton> m_skeleton;
+		core::smart_refctd_ptr<const ICPUAnimationLibrary> m_library;
+		core::vector<SJoint> m_joints;
+		// topological order, every parent comes before its children
+		core::vector<joint_id_t> m_order;
+};
+
+}
+
+#endif
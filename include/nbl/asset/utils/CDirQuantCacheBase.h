@@ -17,6 +17,7 @@
 #include "vectorSIMD.h"
 
 #include "nbl/system/declarations.h"
+#include "nbl/system/SReadWriteSpinLock.h"
 
 #include "nbl/asset/format/EFormat.h"
 #include "nbl/asset/ICPUBuffer.h"
@@ -261,9 +262,11 @@ class CDirQuantCacheBase : public impl::CDirQuantCacheBase
 		template<E_FORMAT CacheFormat>
 		using cache_type_t = typename cache_type<CacheFormat>::type;
 
+		//! All cache accesses are guarded by a read-write spinlock, so multiple loaders can quantize concurrently
 		template<E_FORMAT CacheFormat>
 		inline void insertIntoCache(const Key& key, const value_type_t<CacheFormat>& value)
 		{
+			auto lk = system::write_lock_guard<>(m_lock);
 			std::get<cache_type_t<CacheFormat>>(cache).insert(std::make_pair(key,value));		
 		}
 
@@ -275,6 +278,7 @@ class CDirQuantCacheBase : public impl::CDirQuantCacheBase
 			if (!validateSerializedCache<CacheFormat>(buffer))
 				return false;
 
+			auto lk = system::write_lock_guard<>(m_lock);
 			auto& particularCache = std::get<cache_type_t<CacheFormat>>(cache);
 			cache_type_t<CacheFormat> backup;
 
@@ -332,6 +336,7 @@ class CDirQuantCacheBase : public impl::CDirQuantCacheBase
 			if (bufferSize+offset>getSerializedCacheSizeInBytes<CacheFormat>())
 				return false;
 
+			auto lk = system::read_lock_guard<>(m_lock);
 			CBufferPhmapOutputArchive buffWrap(buffer);
 			return std::get<cache_type_t<CacheFormat>>(cache).dump(buffWrap);
 		}
@@ -366,16 +371,239 @@ class CDirQuantCacheBase : public impl::CDirQuantCacheBase
 			return false;
 		}
 
+		//! Immutable caches are open addressing hash tables stored exactly as they're laid out in memory, so they can be used
+		//! straight out of a memory mapped file without any parsing, and processes mapping the same file share its pages.
+		//! A mounted immutable cache is looked up whenever the regular cache misses, new quantizations still go into the regular cache.
+		_NBL_STATIC_INLINE_CONSTEXPR uint32_t ImmutableCacheMagic = 0x4943514eu; // "NQCI"
+		_NBL_STATIC_INLINE_CONSTEXPR uint32_t ImmutableCacheVersion = 2u;
+
+		struct SImmutableCacheHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t format;
+			uint32_t slotSize;
+			// always a power of two and more than `entryCount`, so probing always terminates
+			uint64_t slotCount;
+			uint64_t entryCount;
+		};
+		template<E_FORMAT CacheFormat>
+		struct SImmutableCacheSlot
+		{
+			Key key;
+			value_type_t<CacheFormat> value;
+			uint32_t occupied;
+		};
+
+		//! Writes the union of the regular and the currently mounted immutable cache for `CacheFormat` in the immutable layout
+		template<E_FORMAT CacheFormat>
+		inline core::smart_refctd_ptr<ICPUBuffer> saveImmutableCacheToBuffer()
+		{
+			static_assert(std::is_trivially_copyable_v<Key>,"Immutable caches are memcpy-ed around!");
+			using slot_t = SImmutableCacheSlot<CacheFormat>;
+
+			auto lk = system::read_lock_guard<>(m_lock);
+			const auto& particularCache = std::get<cache_type_t<CacheFormat>>(cache);
+			const auto& immutableCache = std::get<SImmutableCache<CacheFormat>>(m_immutableCaches);
+
+			uint64_t entryCount = particularCache.size();
+			if (immutableCache.slots)
+			for (uint64_t i=0ull; i<=immutableCache.slotMask; i++)
+			if (immutableCache.slots[i].occupied && particularCache.find(immutableCache.slots[i].key)==particularCache.end())
+				entryCount++;
+			// load factor of at most a half keeps the probe sequences short
+			const uint64_t slotCount = core::roundUpToPoT<uint64_t>(entryCount*2ull+1ull);
+
+			auto buffer = core::make_smart_refctd_ptr<ICPUBuffer>(sizeof(SImmutableCacheHeader)+sizeof(slot_t)*slotCount);
+			uint8_t* const data = static_cast<uint8_t*>(buffer->getPointer());
+			{
+				const SImmutableCacheHeader header = {ImmutableCacheMagic,ImmutableCacheVersion,static_cast<uint32_t>(CacheFormat),sizeof(slot_t),slotCount,entryCount};
+				memcpy(data,&header,sizeof(header));
+			}
+			uint8_t* const slots = data+sizeof(SImmutableCacheHeader);
+			memset(slots,0,sizeof(slot_t)*slotCount);
+			auto insert = [&](const Key& key, const value_type_t<CacheFormat>& value) -> void
+			{
+				auto* slot = reinterpret_cast<slot_t*>(slots);
+				uint64_t i = getImmutableCacheSlot(key)&(slotCount-1ull);
+				while (slot[i].occupied)
+					i = (i+1ull)&(slotCount-1ull);
+				memcpy(&slot[i].key,&key,sizeof(Key));
+				memcpy(&slot[i].value,&value,sizeof(value));
+				slot[i].occupied = 1u;
+			};
+			for (const auto& entry : particularCache)
+				insert(entry.first,entry.second);
+			if (immutableCache.slots)
+			for (uint64_t i=0ull; i<=immutableCache.slotMask; i++)
+			if (immutableCache.slots[i].occupied && particularCache.find(immutableCache.slots[i].key)==particularCache.end())
+				insert(immutableCache.slots[i].key,immutableCache.slots[i].value);
+
+			return buffer;
+		}
+
+		//!
+		template<E_FORMAT CacheFormat>
+		inline bool saveImmutableCacheToFile(system::IFile* file)
+		{
+			if (!file)
+				return false;
+
+			auto buffer = saveImmutableCacheToBuffer<CacheFormat>();
+
+			system::IFile::success_t succ;
+			file->write(succ,buffer->getPointer(),0,buffer->getSize());
+			return bool(succ);
+		}
+
+		//!
+		template<E_FORMAT CacheFormat>
+		inline bool saveImmutableCacheToFile(nbl::system::ISystem* system, const system::path& path)
+		{
+			system::ISystem::future_t<core::smart_refctd_ptr<system::IFile>> future;
+			system->createFile(future,path,nbl::system::IFile::ECF_WRITE);
+			if (auto file=future.acquire())
+				return saveImmutableCacheToFile<CacheFormat>(file->get());
+			return false;
+		}
+
+		//! Validation only looks at the header, the table is used in place and the buffer is kept alive until unmounted
+		template<E_FORMAT CacheFormat>
+		inline bool mountImmutableCache(const SBufferRange<const ICPUBuffer>& buffer)
+		{
+			if (!buffer.buffer || buffer.offset+buffer.size>buffer.buffer->getSize())
+				return false;
+			const auto* data = static_cast<const uint8_t*>(buffer.buffer->getPointer())+buffer.offset;
+			return mountImmutableCache_impl<CacheFormat>(data,buffer.size,core::smart_refctd_ptr<const ICPUBuffer>(buffer.buffer));
+		}
+
+		//! Uses the file's mapping if it has one, otherwise reads it into memory first
+		template<E_FORMAT CacheFormat>
+		inline bool mountImmutableCache(core::smart_refctd_ptr<system::IFile>&& file)
+		{
+			if (!file)
+				return false;
+
+			if (const void* mapped=static_cast<const system::IFile*>(file.get())->getMappedPointer())
+			{
+				const size_t size = file->getSize();
+				return mountImmutableCache_impl<CacheFormat>(mapped,size,std::move(file));
+			}
+
+			auto buffer = core::make_smart_refctd_ptr<asset::ICPUBuffer>(file->getSize());
+
+			system::IFile::success_t succ;
+			file->read(succ, buffer->getPointer(), 0, file->getSize());
+			if (!succ)
+				return false;
+
+			asset::SBufferRange<const asset::ICPUBuffer> bufferRange;
+			bufferRange.offset = 0;
+			bufferRange.size = file->getSize();
+			bufferRange.buffer = std::move(buffer);
+			return mountImmutableCache<CacheFormat>(bufferRange);
+		}
+
+		//!
+		template<E_FORMAT CacheFormat>
+		inline bool mountImmutableCache(nbl::system::ISystem* system, const system::path& path)
+		{
+			system::ISystem::future_t<core::smart_refctd_ptr<system::IFile>> future;
+			system->createFile(future,path,core::bitflag(nbl::system::IFile::ECF_READ)|nbl::system::IFile::ECF_MAPPABLE);
+			if (auto file=future.acquire())
+				return mountImmutableCache<CacheFormat>(std::move(*file));
+			return false;
+		}
+
+		//!
+		template<E_FORMAT CacheFormat>
+		inline void unmountImmutableCache()
+		{
+			auto lk = system::write_lock_guard<>(m_lock);
+			std::get<SImmutableCache<CacheFormat>>(m_immutableCaches) = {};
+		}
+
 		//!
 		template<E_FORMAT CacheFormat>
 		inline size_t getSerializedCacheSizeInBytes()
 		{
+			auto lk = system::read_lock_guard<>(m_lock);
 			return getSerializedCacheSizeInBytes_impl<CacheFormat>(std::get<cache_type_t<CacheFormat>>(cache).capacity());
 		}
 
 	protected:
 		std::tuple<cache_type_t<Formats>...> cache;
-		
+		mutable system::SReadWriteSpinLock m_lock;
+
+		template<E_FORMAT CacheFormat>
+		struct SImmutableCache
+		{
+			// the mapped file or the buffer the slots live in
+			core::smart_refctd_ptr<const core::IReferenceCounted> backing;
+			const SImmutableCacheSlot<CacheFormat>* slots = nullptr;
+			uint64_t slotMask = 0ull;
+		};
+		std::tuple<SImmutableCache<Formats>...> m_immutableCaches;
+
+		template<E_FORMAT CacheFormat>
+		inline bool mountImmutableCache_impl(const void* data, const size_t size, core::smart_refctd_ptr<const core::IReferenceCounted>&& backing)
+		{
+			using slot_t = SImmutableCacheSlot<CacheFormat>;
+			if (size<sizeof(SImmutableCacheHeader) || reinterpret_cast<uintptr_t>(data)%alignof(slot_t))
+				return false;
+
+			SImmutableCacheHeader header;
+			memcpy(&header,data,sizeof(header));
+			if (header.magic!=ImmutableCacheMagic || header.version!=ImmutableCacheVersion || header.format!=static_cast<uint32_t>(CacheFormat) || header.slotSize!=sizeof(slot_t))
+				return false;
+			if (!core::isPoT(header.slotCount) || header.entryCount>=header.slotCount)
+				return false;
+			if ((size-sizeof(SImmutableCacheHeader))/sizeof(slot_t)<header.slotCount)
+				return false;
+			// the header could lie about the occupancy, and a table without empty slots would make a miss probe forever
+			const auto* slots = reinterpret_cast<const slot_t*>(static_cast<const uint8_t*>(data)+sizeof(SImmutableCacheHeader));
+			uint64_t occupiedCount = 0ull;
+			for (uint64_t i=0ull; i<header.slotCount; i++)
+			if (slots[i].occupied)
+				occupiedCount++;
+			if (occupiedCount!=header.entryCount)
+				return false;
+
+			auto lk = system::write_lock_guard<>(m_lock);
+			auto& immutableCache = std::get<SImmutableCache<CacheFormat>>(m_immutableCaches);
+			immutableCache.backing = std::move(backing);
+			immutableCache.slots = slots;
+			immutableCache.slotMask = header.slotCount-1ull;
+			return true;
+		}
+
+		// the quantized direction hashes have their entropy in the high bits, so they need mixing (MurmurHash3's fmix64) before being masked
+		static inline uint64_t getImmutableCacheSlot(const Key& key)
+		{
+			uint64_t h = static_cast<uint64_t>(Hash()(key));
+			h ^= h>>33ull;
+			h *= 0xff51afd7ed558ccdull;
+			h ^= h>>33ull;
+			h *= 0xc4ceb9fe1a85ec53ull;
+			h ^= h>>33ull;
+			return h;
+		}
+
+		//! needs at least a read lock to be held
+		template<E_FORMAT CacheFormat>
+		inline const SImmutableCacheSlot<CacheFormat>* findInImmutableCache(const Key& key) const
+		{
+			const auto& immutableCache = std::get<SImmutableCache<CacheFormat>>(m_immutableCaches);
+			if (!immutableCache.slots)
+				return nullptr;
+			// every slot gets visited at most once, even if the table somehow ended up full
+			uint64_t i = getImmutableCacheSlot(key)&immutableCache.slotMask;
+			for (uint64_t probe=0ull; probe<=immutableCache.slotMask && immutableCache.slots[i].occupied; probe++,i=(i+1ull)&immutableCache.slotMask)
+			if (immutableCache.slots[i].key==key)
+				return immutableCache.slots+i;
+			return nullptr;
+		}
+
 		template<uint32_t dimensions, E_FORMAT CacheFormat>
 		value_type_t<CacheFormat> quantize(const core::vectorSIMDf& value)
 		{
@@ -387,11 +615,24 @@ class CDirQuantCacheBase : public impl::CDirQuantCacheBase
 			constexpr auto quantizationBits = quantization_bits_v<CacheFormat>;
 			value_type_t<CacheFormat> quantized;
 			{
-				auto& particularCache = std::get<cache_type_t<CacheFormat>>(cache);
-				auto found = particularCache.find(key);
-				if (found != particularCache.end() && (found->first == key))
-					quantized = found->second;
-				else
+				bool cached = false;
+				{
+					auto lk = system::read_lock_guard<>(m_lock);
+					auto& particularCache = std::get<cache_type_t<CacheFormat>>(cache);
+					auto found = particularCache.find(key);
+					if (found != particularCache.end() && (found->first == key))
+					{
+						quantized = found->second;
+						cached = true;
+					}
+					else if (const auto* slot=findInImmutableCache<CacheFormat>(key))
+					{
+						quantized = slot->value;
+						cached = true;
+					}
+				}
+				// the expensive fit runs outside the lock, two threads racing on the same key will just insert the same value
+				if (!cached)
 				{
 					const core::vectorSIMDf fit = findBestFit<dimensions,quantizationBits>(absValue);
 
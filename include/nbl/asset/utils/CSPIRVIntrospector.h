@@ -22,6 +22,8 @@
 #include "nbl/core/based_offset.h"
 #include "nbl/core/based_span.h"
 
+#include "nbl/system/SReadWriteSpinLock.h"
+
 namespace spirv_cross
 {
     class ParsedIR;
@@ -379,6 +381,7 @@ class NBL_API2 CSPIRVIntrospector : public core::Uncopyable
 				struct SParams
 				{
 					std::string entryPoint;
+					//! Will be null for introspection data which was loaded with `CSPIRVIntrospector::deserializeCache`
 					core::smart_refctd_ptr<const ICPUShader> shader;
 
 					bool operator==(const SParams& rhs) const
@@ -397,6 +400,7 @@ class NBL_API2 CSPIRVIntrospector : public core::Uncopyable
 					}
 				};
 				inline const auto& getParams() const {return m_params;}
+				inline IShader::E_SHADER_STAGE getShaderStage() const {return m_shaderStage;}
 				inline const auto& getDescriptorSetInfo(const uint8_t set) const {return m_descriptorSetBindings[set];}
 				inline const auto& getInputs() const { return m_input; }
 				inline const std::span<const SFragmentOutputInterface> getFragmentShaderOutputs() const
@@ -503,6 +507,13 @@ class NBL_API2 CSPIRVIntrospector : public core::Uncopyable
 				void shaderMemBlockIntrospection(const spirv_cross::Compiler& comp, SMemoryBlock<true>* root, const spirv_cross::Resource& r);
 				void finalize(IShader::E_SHADER_STAGE stage);
 
+				//! Pointers into `m_memPool` get written out as offsets (the same form as before `finalize`), so the blob can be loaded anywhere
+				void serialize(core::vector<uint8_t>& out) const;
+				//! Consumes the bytes it read from the front of `in`, returns false if the data was truncated or points outside of its pool
+				bool deserialize(std::span<const uint8_t>& in);
+				//! Checks that every offset of the mutable form lands inside `m_memPool` and every type is reachable only once, so `finalize` is safe
+				bool validateBasedOffsets();
+
 				//! debug
 				static void printExtents(std::ostringstream& out, const SArrayInfo& count);
 				static void printType(std::ostringstream& out, const SType<false>* counts, const uint32_t depth=0);
@@ -620,6 +631,9 @@ class NBL_API2 CSPIRVIntrospector : public core::Uncopyable
 
 		//! params.cpuShader.contentType should be ECT_SPIRV
 		//! the compiled SPIRV must be compiled with IShaderCompiler::SCompilerOptions::debugInfoFlags enabling EDIF_SOURCE_BIT implicitly or explicitly, with no `spirvOptimizer` used in order to include names in introspection data
+		//! The cache is keyed on the content hash of the shader's code buffer (see `IPreHashed`), the entry point and the stage, so keep the hash up to date.
+		//! Code without a hash gets hashed only the first time it's seen, so set one before modifying the code in-place.
+		//! Safe to call from multiple threads at once, introspection itself runs outside the cache lock.
 		inline core::smart_refctd_ptr<const CStageIntrospectionData> introspect(const CStageIntrospectionData::SParams& params, bool insertToCache=true)
 		{
 			if (!params.shader)
@@ -628,19 +642,31 @@ class NBL_API2 CSPIRVIntrospector : public core::Uncopyable
 			if (params.shader->getContentType() != IShader::E_CONTENT_TYPE::ECT_SPIRV)
 				return nullptr;
 
-			// TODO: templated find!
-			auto introspectionData = m_introspectionCache.find(params);
-			if (introspectionData != m_introspectionCache.end())
-				return *introspectionData;
+			SCacheKey key = {.contentHash=getSPIRVContentHash(params.shader.get()),.entryPoint=params.entryPoint,.stage=params.shader->getStage()};
+			{
+				auto lk = system::read_lock_guard<>(m_cacheLock);
+				auto found = m_introspectionCache.find(key);
+				if (found != m_introspectionCache.end())
+					return found->second;
+			}
 
 			auto introspection = doIntrospection(params);
 
-			if (insertToCache)
-				m_introspectionCache.insert(introspectionData,introspection);
+			if (insertToCache && introspection)
+			{
+				auto lk = system::write_lock_guard<>(m_cacheLock);
+				// if another thread introspected the same shader meanwhile, hand out the one which made it into the cache
+				return m_introspectionCache.emplace(std::move(key),std::move(introspection)).first->second;
+			}
 
 			return introspection;
 		}
 
+		//! Persistent form of the introspection cache, so introspection of unchanged SPIR-V can be skipped across runs
+		core::smart_refctd_ptr<ICPUBuffer> serializeCache() const;
+		//! Adds the entries of a blob made by `serializeCache` (entries already present are kept), returns false if the blob is malformed or of a different version
+		bool deserializeCache(const std::span<const uint8_t> serializedCache);
+
 		//! creates pipeline for a single ICPUShader
 		core::smart_refctd_ptr<ICPUComputePipeline> createApproximateComputePipelineFromIntrospection(const ICPUShader::SSpecInfo& info, core::smart_refctd_ptr<ICPUPipelineLayout>&& layout = nullptr);
 
@@ -663,47 +689,35 @@ class NBL_API2 CSPIRVIntrospector : public core::Uncopyable
 		using OutputVecT = core::vector<CSPIRVIntrospector::CStageIntrospectionData::SOutputInterface>;
 		using FragmentOutputVecT = core::vector<CSPIRVIntrospector::CStageIntrospectionData::SFragmentOutputInterface>;
 
-		struct KeyHasher
-		{
-			using is_transparent = void;
-
-			inline size_t operator()(const CStageIntrospectionData::SParams& params) const
-			{
-				auto stringViewHasher = std::hash<std::string_view>();
+		constexpr static inline uint32_t SerializedCacheMagic = 0x4950534eu; // "NSPI"
+		//! bump whenever any of the structs in `CStageIntrospectionData` change layout
+		constexpr static inline uint32_t SerializedCacheVersion = 1u;
 
-				auto code = std::string_view(reinterpret_cast<const char*>(params.shader->getContent()->getPointer()),params.shader->getContent()->getSize());
-				size_t hash = stringViewHasher(code);
+		//! Returns the pre-computed hash if one was set, otherwise hashes the code and sets it on the buffer if that's mutable
+		core::blake3_hash_t getSPIRVContentHash(const ICPUShader* shader);
 
-				core::hash_combine<std::string_view>(hash, std::string_view(params.entryPoint));
-				core::hash_combine<uint32_t>(hash, static_cast<uint32_t>(params.shader->getStage()));
+		struct SCacheKey
+		{
+			inline bool operator==(const SCacheKey&) const = default;
 
-				return hash;
-			}
-			inline size_t operator()(const core::smart_refctd_ptr<const CStageIntrospectionData>& data) const
-			{
-				return operator()(data->getParams());
-			}
+			core::blake3_hash_t contentHash;
+			std::string entryPoint;
+			IShader::E_SHADER_STAGE stage;
 		};
-		struct KeyEquals
+		struct KeyHasher
 		{
-			using is_transparent = void;
-
-			inline bool operator()(const CStageIntrospectionData::SParams& lhs, const core::smart_refctd_ptr<const CStageIntrospectionData>& rhs) const
+			inline size_t operator()(const SCacheKey& key) const
 			{
-				return lhs==rhs->getParams();
-			}
-			inline bool operator()(const core::smart_refctd_ptr<const CStageIntrospectionData>& lhs, const CStageIntrospectionData::SParams& rhs) const
-			{
-				return lhs->getParams()==rhs;
-			}
-			inline bool operator()(const core::smart_refctd_ptr<const CStageIntrospectionData>& lhs, const core::smart_refctd_ptr<const CStageIntrospectionData>& rhs) const
-			{
-				return operator()(lhs,rhs->getParams());
+				size_t hash = std::hash<core::blake3_hash_t>()(key.contentHash);
+				core::hash_combine<std::string_view>(hash, std::string_view(key.entryPoint));
+				core::hash_combine<uint32_t>(hash, static_cast<uint32_t>(key.stage));
+				return hash;
 			}
 		};
 
-		using ParamsToDataMap = core::unordered_set<core::smart_refctd_ptr<const CStageIntrospectionData>,KeyHasher,KeyEquals>;
+		using ParamsToDataMap = core::unordered_map<SCacheKey,core::smart_refctd_ptr<const CStageIntrospectionData>,KeyHasher>;
 		ParamsToDataMap m_introspectionCache;
+		mutable system::SReadWriteSpinLock m_cacheLock;
 };
 
 } // nbl::asset
@@ -11,6 +11,9 @@
 
 #include "nbl/asset/filters/CMipMapGenerationImageFilter.h"
 
+#include <atomic>
+#include <mutex>
+
 namespace nbl {
 namespace asset
 {
@@ -275,154 +278,228 @@ public:
 
     }
 
-    // TODO: thread safe commits?
-    bool commit(const SMasterTextureData& _addr, const ICPUImage* _img, const IImage::SSubresourceRange& _subres, ISampler::E_TEXTURE_CLAMP _uwrap, ISampler::E_TEXTURE_CLAMP _vwrap, ISampler::E_TEXTURE_BORDER_COLOR _borderColor) override 
+    struct SCommitRequest
+    {
+        SMasterTextureData addr;
+        const ICPUImage* image;
+        IImage::SSubresourceRange subresource;
+        ISampler::E_TEXTURE_CLAMP uwrap;
+        ISampler::E_TEXTURE_CLAMP vwrap;
+        ISampler::E_TEXTURE_BORDER_COLOR borderColor;
+    };
+    //! Commits many textures at once.
+    /** The physical tiles of all requests get allocated (one `multi_alloc_addr` per storage) and the page table gets written serially,
+    * then the padded tile copies (including mip-tail levels) of all requests are spread over the threads of `policy`.
+    * Concurrent `commit` and `free` calls are safe, `alloc` and `createAlias` must still be externally synchronized against them.
+    * @returns false if any request failed validation or ran out of physical pages, the others still get committed.
+    */
+    template<class ExecutionPolicy>
+    bool commit(ExecutionPolicy&& policy, const std::span<const SCommitRequest> _requests)
     {
-        if (!validateCommit(_addr, _subres, _uwrap, _vwrap))
-            return false;
-
-        const page_tab_offset_t pgtOffset(_addr.pgTab_x, _addr.pgTab_y, _addr.pgTab_layer);
-
-        ICPUVTResidentStorage* storage = nullptr;
-        {
-            uint32_t layer = pgtOffset.z;
-            E_FORMAT format = getFormatInLayer(pgtOffset.z);
-            E_FORMAT_CLASS fc = getFormatClass(format);
-            auto found = m_storage.find(fc);
-            if (found==m_storage.end())
-                return false;
-            storage = static_cast<ICPUVTResidentStorage*>(found->second.get());
-        }
-
-        const VkExtent3D extent = {static_cast<uint32_t>(_addr.origsize_x), static_cast<uint32_t>(_addr.origsize_y), 1u};
-
-        const uint32_t levelsTakingAtLeastOnePageCount = countLevelsTakingAtLeastOnePage(extent);
-        const uint32_t levelsToPack = std::min<uint32_t>(_subres.levelCount, m_pageTable->getCreationParameters().mipLevels+m_pgSzxy_log2);
-
-        uint32_t miptailPgAddr = SPhysPgOffset::invalid_addr;
-
         using phys_pg_addr_alctr_t = ICPUVTResidentStorage::phys_pg_addr_alctr_t;
 
-        if (levelsTakingAtLeastOnePageCount < _subres.levelCount)
+        struct STileCopy
         {
-            uint32_t miptailPgAddr_tmp = phys_pg_addr_alctr_t::invalid_address;
-            const uint32_t szAndAlignment = 1u;
-            core::address_allocator_traits<phys_pg_addr_alctr_t>::multi_alloc_addr(storage->tileAlctr, 1u, &miptailPgAddr_tmp, &szAndAlignment, &szAndAlignment, nullptr);
-            miptailPgAddr_tmp = (miptailPgAddr_tmp == phys_pg_addr_alctr_t::invalid_address) ? SPhysPgOffset::invalid_addr : storage->encodePageAddress(miptailPgAddr_tmp);
-
-            miptailPgAddr = miptailPgAddr_tmp;
-        }
-
-        const bool wholeTexGoesToMiptailPage = (levelsTakingAtLeastOnePageCount == 0u);
-
-        //TODO up to this line, it's kinda common code for CPU and GPU, refactor later
+            const SCommitRequest* request;
+            ICPUVTResidentStorage* storage;
+            uint32_t physPgAddr;
+            uint32_t level;
+            uint32_t x, y;
+            uint32_t w, h;
+            // difference between `level` and the first level going to the miptail page, if non-negative
+            int32_t miptailLevel;
+        };
+        core::vector<STileCopy> copies;
 
-        // TODO: parallelize over all 3 for loops
-        for (uint32_t i = 0u; i < levelsToPack; ++i)
+        bool allSucceeded = true;
         {
-            const uint32_t w = neededPageCountForSide(extent.width, i);
-            const uint32_t h = neededPageCountForSide(extent.height, i);
+            std::lock_guard<std::mutex> lock(m_commitMutex);
 
-            for (uint32_t y = 0u; y < h; ++y)
-                for (uint32_t x = 0u; x < w; ++x)
+            struct SPendingCommit
+            {
+                const SCommitRequest* request;
+                ICPUVTResidentStorage* storage;
+                // into the storage's address array, the miptail page address (if any) comes last
+                uint32_t firstAddr;
+                uint32_t addrCount;
+                uint32_t levelsTakingAtLeastOnePageCount;
+                uint32_t levelsToPack;
+                bool hasMiptail;
+            };
+            core::vector<SPendingCommit> pending;
+            pending.reserve(_requests.size());
+            core::unordered_map<ICPUVTResidentStorage*,core::vector<uint32_t>> storageAddrs;
+            for (const auto& request : _requests)
+            {
+                if (!validateCommit(request.addr, request.subresource, request.uwrap, request.vwrap))
                 {
-                    uint32_t physPgAddr = phys_pg_addr_alctr_t::invalid_address;
-                    if (i>=levelsTakingAtLeastOnePageCount) // this `if` always executes in case of whole texture going into miptail page
-                        physPgAddr = miptailPgAddr;
-                    else
-                    {
-                        const uint32_t szAndAlignment = 1u;
-                        core::address_allocator_traits<phys_pg_addr_alctr_t>::multi_alloc_addr(storage->tileAlctr, 1u, &physPgAddr, &szAndAlignment, &szAndAlignment, nullptr);
-                        if (physPgAddr == phys_pg_addr_alctr_t::invalid_address)
-                            physPgAddr = SPhysPgOffset::invalid_addr;
-                        else
-                            physPgAddr = storage->encodePageAddress(physPgAddr);
-                    }
+                    allSucceeded = false;
+                    continue;
+                }
 
-                    if (i==(levelsTakingAtLeastOnePageCount-1u) && levelsTakingAtLeastOnePageCount<_subres.levelCount)
-                    {
-                        assert(w==1u && h==1u);
-     
-                        physPgAddr |= (miptailPgAddr<<SPhysPgOffset::PAGE_ADDR_BITLENGTH);
-                    }
-                    else  // this `else` always executes in case of whole texture going into miptail page
-                        physPgAddr |= (SPhysPgOffset::invalid_addr<<SPhysPgOffset::PAGE_ADDR_BITLENGTH);
+                auto found = m_storage.find(getFormatClass(getFormatInLayer(request.addr.pgTab_layer)));
+                if (found==m_storage.end())
+                {
+                    allSucceeded = false;
+                    continue;
+                }
+                auto* storage = static_cast<ICPUVTResidentStorage*>(found->second.get());
+
+                const VkExtent3D extent = {static_cast<uint32_t>(request.addr.origsize_x), static_cast<uint32_t>(request.addr.origsize_y), 1u};
+                SPendingCommit& commit = pending.emplace_back();
+                commit.request = &request;
+                commit.storage = storage;
+                commit.levelsTakingAtLeastOnePageCount = countLevelsTakingAtLeastOnePage(extent);
+                commit.levelsToPack = std::min<uint32_t>(request.subresource.levelCount, m_pageTable->getCreationParameters().mipLevels+m_pgSzxy_log2);
+
+                // only allocate pages for the levels which actually get packed, anything more would never be written nor freed
+                // and the miptail page is only referenced once the last level taking a full page gets packed
+                commit.hasMiptail = commit.levelsTakingAtLeastOnePageCount<request.subresource.levelCount && commit.levelsToPack>=commit.levelsTakingAtLeastOnePageCount;
+                uint32_t tileCount = 0u;
+                for (uint32_t i = 0u; i < std::min(commit.levelsTakingAtLeastOnePageCount, commit.levelsToPack); ++i)
+                    tileCount += neededPageCountForSide(extent.width, i)*neededPageCountForSide(extent.height, i);
+                if (commit.hasMiptail)
+                    tileCount++;
+
+                auto& addrs = storageAddrs[storage];
+                commit.firstAddr = addrs.size();
+                commit.addrCount = tileCount;
+                addrs.resize(addrs.size()+tileCount, phys_pg_addr_alctr_t::invalid_address);
+            }
 
-                    if (i < levelsTakingAtLeastOnePageCount)
-                    {
-                        // physical double-address to write into page table
-                        const uint32_t physAddrToWrite = physPgAddr;
-
-                        const auto texelPos = core::vectorSIMDu32(pgtOffset.x>>i, pgtOffset.y>>i, 0u, pgtOffset.z) + core::vectorSIMDu32(x, y, 0u, 0u);
-                        const auto* region = m_pageTable->getRegion(i, texelPos);
-                        const uint64_t byteoffset = region->getByteOffset(texelPos, region->getByteStrides(m_pageTable->getTexelBlockInfo()));
-                        uint8_t* bufptr = reinterpret_cast<uint8_t*>(m_pageTable->getBuffer()->getPointer()) + byteoffset;
-                        reinterpret_cast<uint32_t*>(bufptr)[0] = physAddrToWrite;
-                    }
+            for (auto& [storage,addrs] : storageAddrs)
+            {
+                const core::vector<uint32_t> szAndAlignment(addrs.size(), 1u);
+                core::address_allocator_traits<phys_pg_addr_alctr_t>::multi_alloc_addr(storage->tileAlctr, addrs.size(), addrs.data(), szAndAlignment.data(), szAndAlignment.data(), nullptr);
+                for (auto& addr : addrs)
+                    addr = (addr == phys_pg_addr_alctr_t::invalid_address) ? SPhysPgOffset::invalid_addr : storage->encodePageAddress(addr);
+            }
+
+            // page table regions of different textures are disjoint, but it's only a store per page so there's no point in fanning it out
+            auto* const pgtBufptr = reinterpret_cast<uint8_t*>(m_pageTable->getBuffer()->getPointer());
+            auto writePageTable = [&](const uint32_t level, const core::vectorSIMDu32& texelPos, const uint32_t physAddrToWrite) -> void
+            {
+                const auto* region = m_pageTable->getRegion(level, texelPos);
+                const uint64_t byteoffset = region->getByteOffset(texelPos, region->getByteStrides(m_pageTable->getTexelBlockInfo()));
+                reinterpret_cast<uint32_t*>(pgtBufptr + byteoffset)[0] = physAddrToWrite;
+            };
+            for (const auto& commit : pending)
+            {
+                const auto& request = *commit.request;
+                const page_tab_offset_t pgtOffset(request.addr.pgTab_x, request.addr.pgTab_y, request.addr.pgTab_layer);
+                const VkExtent3D extent = {static_cast<uint32_t>(request.addr.origsize_x), static_cast<uint32_t>(request.addr.origsize_y), 1u};
+                const uint32_t* addrIt = storageAddrs[commit.storage].data()+commit.firstAddr;
 
-                    if (!SPhysPgOffset(physPgAddr).valid())
-                        continue;
-
-                    core::vector3du32_SIMD physPg = ICPUVTResidentStorage::pageCoords(physPgAddr, m_pgSzxy, m_tilePadding);
-                    physPg -= core::vector2du32_SIMD(m_tilePadding, m_tilePadding);
-
-                    const core::vector2du32_SIMD miptailOffset = (i>=levelsTakingAtLeastOnePageCount) ? core::vector2du32_SIMD(m_miptailOffsets[i-levelsTakingAtLeastOnePageCount].x,m_miptailOffsets[i-levelsTakingAtLeastOnePageCount].y) : core::vector2du32_SIMD(0u,0u);
-                    physPg += miptailOffset;
-
-                    CPaddedCopyImageFilter::state_type copy;
-                    copy.outOffsetBaseLayer = (physPg).xyzz();/*physPg.z is layer*/ copy.outOffset.z = 0u;
-                    copy.inOffsetBaseLayer = core::vector2du32_SIMD(x,y)*m_pgSzxy;
-                    copy.extentLayerCount = core::vectorSIMDu32(m_pgSzxy, m_pgSzxy, 1u, 1u);
-                    copy.relativeOffset = {0u,0u,0u};
-                    if (x == w-1u)
-                        copy.extentLayerCount.x = std::max<uint32_t>(extent.width>>i,1u)-copy.inOffsetBaseLayer.x;
-                    if (y == h-1u)
-                        copy.extentLayerCount.y = std::max<uint32_t>(extent.height>>i,1u)-copy.inOffsetBaseLayer.y;
-                    memcpy(&copy.paddedExtent.width,(copy.extentLayerCount+core::vectorSIMDu32(2u*m_tilePadding)).pointer, 2u*sizeof(uint32_t));
-                    copy.paddedExtent.depth = 1u;
-                    if (w>1u)
-                        copy.extentLayerCount.x += m_tilePadding;
-                    if (x>0u && x<w-1u)
-                        copy.extentLayerCount.x += m_tilePadding;
-                    if (h>1u)
-                        copy.extentLayerCount.y += m_tilePadding;
-                    if (y>0u && y<h-1u)
-                        copy.extentLayerCount.y += m_tilePadding;
-                    if (x == 0u)
-                        copy.relativeOffset.x = m_tilePadding;
-                    else
-                        copy.inOffsetBaseLayer.x -= m_tilePadding;
-                    if (y == 0u)
-                        copy.relativeOffset.y = m_tilePadding;
-                    else
-                        copy.inOffsetBaseLayer.y -= m_tilePadding;
-                    copy.inOffsetBaseLayer.w = _subres.baseArrayLayer;
-                    copy.inMipLevel = _subres.baseMipLevel + i;
-                    copy.outMipLevel = 0u;
-                    copy.inImage = _img;
-                    copy.outImage = storage->image.get();
-                    copy.axisWraps[0] = _uwrap;
-                    copy.axisWraps[1] = _vwrap;
-                    copy.axisWraps[2] = ISampler::ETC_CLAMP_TO_EDGE;
-                    copy.borderColor = _borderColor;
-                    if (!CPaddedCopyImageFilter::execute(core::execution::par_unseq,&copy))
-                        assert(false);
+                const bool hasMiptail = commit.hasMiptail;
+                const uint32_t miptailPgAddr = hasMiptail ? addrIt[commit.addrCount-1u] : SPhysPgOffset::invalid_addr;
+
+                for (uint32_t i = 0u; i < commit.levelsToPack; ++i)
+                {
+                    const uint32_t w = neededPageCountForSide(extent.width, i);
+                    const uint32_t h = neededPageCountForSide(extent.height, i);
+
+                    for (uint32_t y = 0u; y < h; ++y)
+                        for (uint32_t x = 0u; x < w; ++x)
+                        {
+                            uint32_t physPgAddr;
+                            if (i>=commit.levelsTakingAtLeastOnePageCount) // this `if` always executes in case of whole texture going into miptail page
+                                physPgAddr = miptailPgAddr;
+                            else
+                                physPgAddr = *(addrIt++);
+                            if (!SPhysPgOffset(physPgAddr).valid())
+                                allSucceeded = false;
+
+                            if (i==(commit.levelsTakingAtLeastOnePageCount-1u) && hasMiptail)
+                            {
+                                assert(w==1u && h==1u);
+                                physPgAddr |= (miptailPgAddr<<SPhysPgOffset::PAGE_ADDR_BITLENGTH);
+                            }
+                            else  // this `else` always executes in case of whole texture going into miptail page
+                                physPgAddr |= (SPhysPgOffset::invalid_addr<<SPhysPgOffset::PAGE_ADDR_BITLENGTH);
+
+                            // physical double-address to write into page table
+                            if (i < commit.levelsTakingAtLeastOnePageCount)
+                                writePageTable(i, core::vectorSIMDu32(pgtOffset.x>>i, pgtOffset.y>>i, 0u, pgtOffset.z) + core::vectorSIMDu32(x, y, 0u, 0u), physPgAddr);
+
+                            if (SPhysPgOffset(physPgAddr).valid())
+                                copies.push_back({&request, commit.storage, physPgAddr, i, x, y, w, h, static_cast<int32_t>(i)-static_cast<int32_t>(commit.levelsTakingAtLeastOnePageCount)});
+                        }
                 }
+
+                if (commit.levelsTakingAtLeastOnePageCount == 0u) // whole texture goes to miptail page
+                    writePageTable(0u, core::vectorSIMDu32(pgtOffset.x, pgtOffset.y, 0u, pgtOffset.z), SPhysPgOffset::invalid_addr | (miptailPgAddr << SPhysPgOffset::PAGE_ADDR_BITLENGTH));
+            }
         }
 
-        if (wholeTexGoesToMiptailPage)
+        // every copy writes its own physical page (or its own rectangle of a miptail page), so they're independent
+        std::atomic_bool copiesSucceeded = true;
+        std::for_each(std::forward<ExecutionPolicy>(policy), copies.begin(), copies.end(), [&](const STileCopy& tile) -> void
         {
-            // physical double-address to write into page table
-            uint32_t physAddrToWrite = SPhysPgOffset::invalid_addr | (miptailPgAddr << SPhysPgOffset::PAGE_ADDR_BITLENGTH);
-
-            const auto texelPos = core::vectorSIMDu32(pgtOffset.x, pgtOffset.y, 0u, pgtOffset.z);
-            const auto* region = m_pageTable->getRegion(0u, texelPos);
-            const uint64_t byteoffset = region->getByteOffset(texelPos, region->getByteStrides(m_pageTable->getTexelBlockInfo()));
-            uint8_t* bufptr = reinterpret_cast<uint8_t*>(m_pageTable->getBuffer()->getPointer()) + byteoffset;
-            reinterpret_cast<uint32_t*>(bufptr)[0] = physAddrToWrite;
-        }
+            const auto& request = *tile.request;
+            const VkExtent3D extent = {static_cast<uint32_t>(request.addr.origsize_x), static_cast<uint32_t>(request.addr.origsize_y), 1u};
+            const uint32_t x = tile.x, y = tile.y, w = tile.w, h = tile.h, i = tile.level;
+
+            core::vector3du32_SIMD physPg = ICPUVTResidentStorage::pageCoords(tile.physPgAddr, m_pgSzxy, m_tilePadding);
+            physPg -= core::vector2du32_SIMD(m_tilePadding, m_tilePadding);
+
+            const core::vector2du32_SIMD miptailOffset = (tile.miptailLevel>=0) ? core::vector2du32_SIMD(m_miptailOffsets[tile.miptailLevel].x,m_miptailOffsets[tile.miptailLevel].y) : core::vector2du32_SIMD(0u,0u);
+            physPg += miptailOffset;
+
+            CPaddedCopyImageFilter::state_type copy;
+            copy.outOffsetBaseLayer = (physPg).xyzz();/*physPg.z is layer*/ copy.outOffset.z = 0u;
+            copy.inOffsetBaseLayer = core::vector2du32_SIMD(x,y)*m_pgSzxy;
+            copy.extentLayerCount = core::vectorSIMDu32(m_pgSzxy, m_pgSzxy, 1u, 1u);
+            copy.relativeOffset = {0u,0u,0u};
+            if (x == w-1u)
+                copy.extentLayerCount.x = std::max<uint32_t>(extent.width>>i,1u)-copy.inOffsetBaseLayer.x;
+            if (y == h-1u)
+                copy.extentLayerCount.y = std::max<uint32_t>(extent.height>>i,1u)-copy.inOffsetBaseLayer.y;
+            memcpy(&copy.paddedExtent.width,(copy.extentLayerCount+core::vectorSIMDu32(2u*m_tilePadding)).pointer, 2u*sizeof(uint32_t));
+            copy.paddedExtent.depth = 1u;
+            if (w>1u)
+                copy.extentLayerCount.x += m_tilePadding;
+            if (x>0u && x<w-1u)
+                copy.extentLayerCount.x += m_tilePadding;
+            if (h>1u)
+                copy.extentLayerCount.y += m_tilePadding;
+            if (y>0u && y<h-1u)
+                copy.extentLayerCount.y += m_tilePadding;
+            if (x == 0u)
+                copy.relativeOffset.x = m_tilePadding;
+            else
+                copy.inOffsetBaseLayer.x -= m_tilePadding;
+            if (y == 0u)
+                copy.relativeOffset.y = m_tilePadding;
+            else
+                copy.inOffsetBaseLayer.y -= m_tilePadding;
+            copy.inOffsetBaseLayer.w = request.subresource.baseArrayLayer;
+            copy.inMipLevel = request.subresource.baseMipLevel + i;
+            copy.outMipLevel = 0u;
+            copy.inImage = request.image;
+            copy.outImage = tile.storage->image.get();
+            copy.axisWraps[0] = request.uwrap;
+            copy.axisWraps[1] = request.vwrap;
+            copy.axisWraps[2] = ISampler::ETC_CLAMP_TO_EDGE;
+            copy.borderColor = request.borderColor;
+            // the parallelism is already over the tiles
+            if (!CPaddedCopyImageFilter::execute(core::execution::seq,&copy))
+            {
+                assert(false);
+                copiesSucceeded = false;
+            }
+        });
 
-        return true;
+        return allSucceeded && copiesSucceeded;
+    }
+    bool commit(const std::span<const SCommitRequest> _requests)
+    {
+        return commit(core::execution::par_unseq, _requests);
+    }
+
+    bool commit(const SMasterTextureData& _addr, const ICPUImage* _img, const IImage::SSubresourceRange& _subres, ISampler::E_TEXTURE_CLAMP _uwrap, ISampler::E_TEXTURE_CLAMP _vwrap, ISampler::E_TEXTURE_BORDER_COLOR _borderColor) override 
+    {
+        const SCommitRequest request = {_addr, _img, _subres, _uwrap, _vwrap, _borderColor};
+        return commit({&request, 1ull});
     }
 
     SViewAliasTextureData createAlias(const SMasterTextureData& _addr, E_FORMAT _viewingFormat, const IImage::SSubresourceRange& _subresRelativeToMaster) override
@@ -468,6 +545,8 @@ public:
         if (!storage)
             return false;
 
+        std::lock_guard<std::mutex> lock(m_commitMutex);
+
         //free physical pages
         VkExtent3D extent = {static_cast<uint32_t>(_addr.origsize_x), static_cast<uint32_t>(_addr.origsize_y), 1u};
 
@@ -593,6 +672,9 @@ protected:
     {
         return core::make_smart_refctd_ptr<ICPUSampler>(_params);
     }
+
+    // guards the physical tile allocators, the page table and `m_addrsArray`
+    std::mutex m_commitMutex;
 };
 
 }}
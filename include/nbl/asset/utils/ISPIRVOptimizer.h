@@ -6,6 +6,15 @@
 #include "nbl/asset/ICPUBuffer.h"
 
 #include "nbl/system/ILogger.h"
+#include "nbl/system/SReadWriteSpinLock.h"
+
+#include <chrono>
+#include <mutex>
+
+namespace spvtools
+{
+    class Optimizer;
+}
 
 namespace nbl::asset
 {
@@ -38,14 +47,92 @@ class ISPIRVOptimizer final : public core::IReferenceCounted
             EOP_COUNT
         };
 
-        ISPIRVOptimizer(std::initializer_list<E_OPTIMIZER_PASS> _passes) : m_passes(std::move(_passes)) {}
+        //! Optimized SPIR-V keyed by the content hash of the input, the pass list and the target environment.
+        //! Can be shared between optimizers and threads, and saved to disk so unchanged modules skip optimization across runs.
+        class CCache final : public core::IReferenceCounted
+        {
+            public:
+                constexpr static inline uint32_t MAGIC = 0x4f50534eu; // "NSPO"
+                //! bump whenever the layout or the meaning of an `E_OPTIMIZER_PASS` changes
+                constexpr static inline uint32_t VERSION = 2u;
+
+                struct SKey
+                {
+                    inline bool operator==(const SKey&) const = default;
+
+                    core::blake3_hash_t inputHash;
+                    core::vector<E_OPTIMIZER_PASS> passes;
+                    uint32_t targetEnv;
+                };
+
+                CCache() = default;
+
+                //! returns a fresh buffer with a copy of the cached SPIR-V, or nullptr on a miss
+                core::smart_refctd_ptr<ICPUBuffer> find(const SKey& key) const;
+                void insert(SKey&& key, const std::span<const uint32_t> optimized);
+
+                inline size_t size() const
+                {
+                    auto lk = system::read_lock_guard<>(m_lock);
+                    return m_container.size();
+                }
+
+                core::smart_refctd_ptr<ICPUBuffer> serialize() const;
+                //! returns nullptr if the data is truncated, isn't a serialized `CCache` or was written by a different `VERSION`
+                static core::smart_refctd_ptr<CCache> deserialize(const std::span<const uint8_t> serializedCache);
+
+            private:
+                struct KeyHasher
+                {
+                    inline size_t operator()(const SKey& key) const
+                    {
+                        size_t hash = std::hash<core::blake3_hash_t>()(key.inputHash);
+                        for (const auto pass : key.passes)
+                            core::hash_combine<uint32_t>(hash,pass);
+                        core::hash_combine<uint32_t>(hash,key.targetEnv);
+                        return hash;
+                    }
+                };
+
+                core::unordered_map<SKey,core::vector<uint32_t>,KeyHasher> m_container;
+                mutable system::SReadWriteSpinLock m_lock;
+        };
+
+        ISPIRVOptimizer(std::initializer_list<E_OPTIMIZER_PASS> _passes, core::smart_refctd_ptr<CCache>&& _cache=nullptr);
 
         core::smart_refctd_ptr<ICPUBuffer> optimize(const uint32_t* _spirv, uint32_t _dwordCount, system::logger_opt_ptr logger) const;
         core::smart_refctd_ptr<ICPUBuffer> optimize(const ICPUBuffer* _spirv, system::logger_opt_ptr logger) const;
+        //! Optimizes independent modules concurrently, every worker borrows an already set-up `spvtools::Optimizer` instead of registering all the passes again.
+        //! The output has a nullptr wherever the corresponding input failed to optimize.
+        core::vector<core::smart_refctd_ptr<ICPUBuffer>> optimize(const std::span<const ICPUBuffer* const> _spirvs, system::logger_opt_ptr logger) const;
+
+        struct SPassTiming
+        {
+            E_OPTIMIZER_PASS pass;
+            std::chrono::microseconds duration;
+            uint32_t dwordCountAfter;
+        };
+        //! Runs the passes one at a time, so every timing also contains a parse and re-serialization of the module, then logs them with `ELL_PERFORMANCE`.
+        //! Meant for finding passes that are too expensive for what they gain, doesn't use the cache.
+        core::smart_refctd_ptr<ICPUBuffer> profile(const ICPUBuffer* _spirv, core::vector<SPassTiming>& timings, system::logger_opt_ptr logger) const;
+
         const std::span<const E_OPTIMIZER_PASS> getPasses() const;
+        inline CCache* getCache() const {return m_cache.get();}
+
+        static const char* getPassName(const E_OPTIMIZER_PASS pass);
 
     protected:
+        ~ISPIRVOptimizer();
+
+        std::unique_ptr<spvtools::Optimizer> acquireOptimizer(system::logger_opt_ptr& logger) const;
+        void releaseOptimizer(std::unique_ptr<spvtools::Optimizer>&& optimizer) const;
+        core::smart_refctd_ptr<ICPUBuffer> optimize_impl(const uint32_t* _spirv, uint32_t _dwordCount, const core::blake3_hash_t* inputHash, system::logger_opt_ptr logger) const;
+
         const core::vector<E_OPTIMIZER_PASS> m_passes;
+        core::smart_refctd_ptr<CCache> m_cache;
+        // optimizers with all of `m_passes` registered, each only ever used by one thread at a time
+        mutable std::mutex m_optimizerPoolMutex;
+        mutable core::vector<std::unique_ptr<spvtools::Optimizer>> m_optimizerPool;
 };
 
 }
@@ -9,8 +9,11 @@
 #include <bitset>
 #include <cstdint>
 #include <numeric>
+#include <thread>
 
 #include "nbl/macros.h"
+#include "nbl/core/decl/Types.h"
+#include "nbl/core/execution.h"
 
 namespace nbl
 {
@@ -73,6 +76,14 @@ struct RadixSorter
 			constexpr histogram_t shift = static_cast<histogram_t>(radix_bits*pass_ix);
 			for (histogram_t i=0u; i<rangeSize; i++)
 				++histogram[comp.template operator()<shift,radix_mask>(input[i])];
+			// all keys have the same digit, the scatter wouldn't change the order so skip it and don't swap the buffers
+			if (rangeSize==0u || histogram[comp.template operator()<shift,radix_mask>(input[0])]==rangeSize)
+			{
+				if constexpr (pass_ix != last_pass)
+					return pass<RandomIt,KeyAccessor,pass_ix+1ull>(input,output,rangeSize,comp);
+				else
+					return input;
+			}
 			// prefix sum
 			std::inclusive_scan(histogram,histogram+histogram_size,histogram);
 			// scatter
@@ -91,6 +102,98 @@ struct RadixSorter
 		alignas(sizeof(histogram_t)) histogram_t histogram[histogram_size];
 };
 
+//! LSD radix sort over blocks of the range, every pass counts digits per block in parallel, turns the counts into
+//! per block scatter offsets with a digit-major scan (which keeps it stable) and scatters every block in parallel.
+//! Optionally carries a second (value) range along with the keys.
+template<size_t key_bit_count>
+struct ParallelRadixSorter
+{
+		_NBL_STATIC_INLINE_CONSTEXPR uint8_t radix_bits = 8u;
+		_NBL_STATIC_INLINE_CONSTEXPR size_t bucket_count = 0x1ull<<radix_bits;
+		_NBL_STATIC_INLINE_CONSTEXPR size_t last_pass = (key_bit_count-1ull)/size_t(radix_bits);
+		_NBL_STATIC_INLINE_CONSTEXPR uint16_t radix_mask = bucket_count-1u;
+		//! smaller blocks aren't worth a thread
+		_NBL_STATIC_INLINE_CONSTEXPR size_t min_block_size = 0x1ull<<14ull;
+
+		template<class ExecutionPolicy, class RandomIt, class ValueIt, class KeyAccessor>
+		inline std::pair<RandomIt,ValueIt> operator()(ExecutionPolicy&& policy, RandomIt input, RandomIt output, ValueIt valuesIn, ValueIt valuesOut, const size_t rangeSize, const KeyAccessor& comp)
+		{
+			constexpr bool is_seq_policy_v = std::is_same_v<std::remove_cvref_t<ExecutionPolicy>,core::execution::sequenced_policy>;
+			const size_t maxBlockCount = is_seq_policy_v ? 1ull:(size_t(std::thread::hardware_concurrency())*4ull);
+			blockCount = std::max<size_t>(std::min<size_t>((rangeSize+min_block_size-1ull)/min_block_size,maxBlockCount),1ull);
+			blocks.resize(blockCount);
+			std::iota(blocks.begin(),blocks.end(),0ull);
+			histograms.resize(blockCount*bucket_count);
+			return pass<ExecutionPolicy,RandomIt,ValueIt,KeyAccessor,0ull>(policy,input,output,valuesIn,valuesOut,rangeSize,comp);
+		}
+	private:
+		template<class ExecutionPolicy, class RandomIt, class ValueIt, class KeyAccessor, size_t pass_ix>
+		inline std::pair<RandomIt,ValueIt> pass(ExecutionPolicy& policy, RandomIt input, RandomIt output, ValueIt valuesIn, ValueIt valuesOut, const size_t rangeSize, const KeyAccessor& comp)
+		{
+			constexpr size_t shift = radix_bits*pass_ix;
+			auto blockBegin = [this,rangeSize](const size_t block) -> size_t {return (rangeSize*block)/blockCount;};
+
+			// count
+			std::for_each(policy,blocks.begin(),blocks.end(),[&](const size_t& block) -> void
+			{
+				size_t* const histogram = histograms.data()+block*bucket_count;
+				std::fill_n(histogram,bucket_count,0ull);
+				for (size_t i=blockBegin(block); i<blockBegin(block+1ull); i++)
+					++histogram[comp.template operator()<shift,radix_mask>(input[i])];
+			});
+
+			// all keys have the same digit, the scatter wouldn't change the order so skip it and don't swap the buffers
+			bool trivial = rangeSize==0ull;
+			if (!trivial)
+			{
+				const size_t digit = comp.template operator()<shift,radix_mask>(input[0]);
+				size_t digitCount = 0ull;
+				for (size_t block=0ull; block<blockCount; block++)
+					digitCount += histograms[block*bucket_count+digit];
+				trivial = digitCount==rangeSize;
+			}
+
+			if (!trivial)
+			{
+				// exclusive scan, digit-major and block-minor so equal keys keep their order
+				size_t offset = 0ull;
+				for (size_t digit=0ull; digit<bucket_count; digit++)
+				for (size_t block=0ull; block<blockCount; block++)
+				{
+					size_t& count = histograms[block*bucket_count+digit];
+					const size_t blockDigitCount = count;
+					count = offset;
+					offset += blockDigitCount;
+				}
+
+				// scatter
+				std::for_each(policy,blocks.begin(),blocks.end(),[&](const size_t& block) -> void
+				{
+					size_t* const scatterOffsets = histograms.data()+block*bucket_count;
+					for (size_t i=blockBegin(block); i<blockBegin(block+1ull); i++)
+					{
+						const size_t dst = scatterOffsets[comp.template operator()<shift,radix_mask>(input[i])]++;
+						output[dst] = input[i];
+						if constexpr (!std::is_same_v<ValueIt,std::nullptr_t>)
+							valuesOut[dst] = valuesIn[i];
+					}
+				});
+				std::swap(input,output);
+				std::swap(valuesIn,valuesOut);
+			}
+
+			if constexpr (pass_ix != last_pass)
+				return pass<ExecutionPolicy,RandomIt,ValueIt,KeyAccessor,pass_ix+1ull>(policy,input,output,valuesIn,valuesOut,rangeSize,comp);
+			else
+				return {input,valuesIn};
+		}
+
+		size_t blockCount = 0ull;
+		core::vector<size_t> blocks;
+		// one histogram per block, after the scan they hold the block's scatter offsets
+		core::vector<size_t> histograms;
+};
+
 }
 
 template<class RandomIt, class KeyAccessor>
@@ -110,7 +213,40 @@ inline RandomIt radix_sort(RandomIt input, RandomIt scratch, const size_t rangeS
 template<class RandomIt>
 inline RandomIt radix_sort(RandomIt input, RandomIt scratch, const size_t rangeSize)
 {
-	return radix_sort<RandomIt>(input,scratch,rangeSize,impl::KeyAdaptor<decltype(*input)>());
+	return radix_sort<RandomIt>(input,scratch,rangeSize,impl::KeyAdaptor<std::remove_cvref_t<decltype(*input)>>());
+}
+
+//! Parallel version, passes where every key has the same digit get skipped so the result can be in either range just like with the serial one
+template<class ExecutionPolicy, class RandomIt, class KeyAccessor>
+inline RandomIt radix_sort(ExecutionPolicy&& policy, RandomIt input, RandomIt scratch, const size_t rangeSize, const KeyAccessor& comp)
+{
+	assert(std::abs(std::distance(input,scratch))>=rangeSize);
+
+	// not worth spinning up any threads
+	if (rangeSize<impl::ParallelRadixSorter<KeyAccessor::key_bit_count>::min_block_size*2ull)
+		return radix_sort(input,scratch,rangeSize,comp);
+	return impl::ParallelRadixSorter<KeyAccessor::key_bit_count>()(std::forward<ExecutionPolicy>(policy),input,scratch,nullptr,nullptr,rangeSize,comp).first;
+}
+template<class ExecutionPolicy, class RandomIt>
+inline RandomIt radix_sort(ExecutionPolicy&& policy, RandomIt input, RandomIt scratch, const size_t rangeSize)
+{
+	return radix_sort(std::forward<ExecutionPolicy>(policy),input,scratch,rangeSize,impl::KeyAdaptor<std::remove_cvref_t<decltype(*input)>>());
+}
+
+//! Structure of Arrays version, sorts the `keys` and moves `values` (e.g. indices of the elements the keys were made from) along with them.
+//! Stable, returns where the sorted keys and values ended up, they're always both in the input ranges or both in the scratch ranges.
+template<class ExecutionPolicy, class KeyIt, class ValueIt, class KeyAccessor>
+inline std::pair<KeyIt,ValueIt> radix_sort_key_value(ExecutionPolicy&& policy, KeyIt keys, KeyIt keyScratch, ValueIt values, ValueIt valueScratch, const size_t rangeSize, const KeyAccessor& comp)
+{
+	assert(std::abs(std::distance(keys,keyScratch))>=rangeSize);
+	assert(std::abs(std::distance(values,valueScratch))>=rangeSize);
+
+	return impl::ParallelRadixSorter<KeyAccessor::key_bit_count>()(std::forward<ExecutionPolicy>(policy),keys,keyScratch,values,valueScratch,rangeSize,comp);
+}
+template<class ExecutionPolicy, class KeyIt, class ValueIt>
+inline std::pair<KeyIt,ValueIt> radix_sort_key_value(ExecutionPolicy&& policy, KeyIt keys, KeyIt keyScratch, ValueIt values, ValueIt valueScratch, const size_t rangeSize)
+{
+	return radix_sort_key_value(std::forward<ExecutionPolicy>(policy),keys,keyScratch,values,valueScratch,rangeSize,impl::KeyAdaptor<std::remove_cvref_t<decltype(*keys)>>());
 }
 
 }
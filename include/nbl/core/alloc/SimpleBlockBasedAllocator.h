@@ -136,10 +136,11 @@ class SimpleBlockBasedAllocator
 				if (!block)
 					continue;
                     
-				size_type addr = reinterpret_cast<uint8_t*>(p)-block->data();
+				// full width so a pointer from a block more than 4GB away can't alias into this one when `size_type` is 32bit
+				const size_t addr = reinterpret_cast<uintptr_t>(p)-reinterpret_cast<uintptr_t>(block->data());
 				if (addr<blockSize)
 				{
-					block->free(addr,bytes);
+					block->free(static_cast<size_type>(addr),bytes);
 					if (i>=minBlockCount && address_allocator_traits<AddressAllocator>::get_allocated_size(block->getAllocator())==size_type(0u))
 						deleteBlock(i);
 					return;
@@ -20,6 +20,7 @@ namespace nbl::core
 		constexpr based_span(size_t byteOffset, size_t size) : m_byteOffset(byteOffset), m_size(size) {}
 
 		inline bool empty() const { return m_size == 0ull; }
+		inline size_t size() const { return m_size; }
 
 		inline std::span<T> operator()(std::conditional_t<IsConst, const void*, void*> newBase) const
 		{
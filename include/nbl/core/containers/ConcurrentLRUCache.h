@@ -0,0 +1,142 @@
+// Copyright (C) 2018-2023 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef _NBL_CORE_CONCURRENT_LRU_CACHE_H_INCLUDED_
+#define _NBL_CORE_CONCURRENT_LRU_CACHE_H_INCLUDED_
+
+#include "nbl/core/containers/LRUCache.h"
+#include "nbl/core/math/intutil.h"
+
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+
+namespace nbl::core
+{
+
+// Thread-safe Key-Value Least Recently Used cache
+// Keys get distributed by hash over a power of two amount of shards, each shard being a plain `LRUCache` behind its own mutex,
+// so threads only contend when they hit the same shard. Eviction order is only LRU within a shard, not globally.
+// Because another thread may evict an entry at any moment, values are handed out by copy (or to a visitor under the shard's lock)
+// instead of by pointer like `LRUCache` does.
+template<typename Key, typename Value, typename MapHash=std::hash<Key>, typename MapEquals=std::equal_to<Key> >
+class ConcurrentLRUCache : public core::Unmovable, public core::Uncopyable
+{
+		using shard_cache_t = LRUCache<Key,Value,MapHash,MapEquals>;
+
+		struct Shard
+		{
+			Shard(const uint32_t capacity, typename shard_cache_t::disposal_func_t&& df, MapHash&& hash, MapEquals&& equals)
+				: cache(capacity,std::move(df),std::move(hash),std::move(equals)) {}
+
+			std::mutex lock;
+			shard_cache_t cache;
+		};
+
+		inline Shard& getShard(const Key& key) const
+		{
+			// the low bits of the hash already pick the bucket within the shard's own map, so use a remixed hash for the shard
+			uint64_t h = m_hash(key);
+			h ^= h>>33u;
+			h *= 0xff51afd7ed558ccdull;
+			h ^= h>>33u;
+			return *m_shards[h&(m_shards.size()-1ull)];
+		}
+
+	public:
+		using disposal_func_t = typename shard_cache_t::disposal_func_t;
+
+		//! `shardCount` of 0 picks one based on the hardware concurrency. Either way it's capped at `capacity/2` so every shard
+		//! can hold at least 2 entries, and rounded down to a power of two.
+		//! The shards' capacities add up to exactly `capacity`.
+		ConcurrentLRUCache(const uint32_t capacity, uint32_t shardCount=0u, const disposal_func_t& _df=disposal_func_t(), const MapHash& _hash=MapHash(), const MapEquals& _equals=MapEquals()) : m_hash(_hash)
+		{
+			assert(capacity>1u);
+			if (!shardCount)
+				shardCount = core::max(std::thread::hardware_concurrency(),1u)*4u;
+			shardCount = core::roundDownToPoT(core::max(core::min(shardCount,capacity/2u),1u));
+			// the remainder gets spread over the first shards
+			const uint32_t shardCapacity = capacity/shardCount;
+			const uint32_t remainder = capacity%shardCount;
+
+			m_shards.reserve(shardCount);
+			for (uint32_t i=0u; i<shardCount; i++)
+				m_shards.push_back(std::make_unique<Shard>(shardCapacity+(i<remainder ? 1u:0u),disposal_func_t(_df),MapHash(_hash),MapEquals(_equals)));
+		}
+		ConcurrentLRUCache() = delete;
+
+		inline uint32_t getShardCount() const { return m_shards.size(); }
+
+		//! The callback gets invoked while the shard is locked, it must not re-enter the cache.
+		template<typename K, typename V, std::invocable<const Value&> EvictionCallback> requires std::is_constructible_v<Value,V>
+		inline void insert(K&& k, V&& v, EvictionCallback&& evictCallback)
+		{
+			auto& shard = getShard(k);
+			std::unique_lock lk(shard.lock);
+			shard.cache.insert(std::forward<K>(k),std::forward<V>(v),std::forward<EvictionCallback>(evictCallback));
+		}
+
+		template<typename K, typename V>
+		inline void insert(K&& k, V&& v)
+		{
+			insert(std::forward<K>(k),std::forward<V>(v),[](const Value& ejected)->void{});
+		}
+
+		//get a copy of the value at an associated Key, or nullopt if Key is not contained within cache. Marks the value as most recently used
+		inline std::optional<Value> get(const Key& key)
+		{
+			std::optional<Value> retval;
+			get(key,[&retval](Value& value)->void{retval = value;});
+			return retval;
+		}
+		//invoke `visitor` on the value at an associated Key while its shard is locked, returns false if Key is not contained within cache. Marks the value as most recently used
+		template<std::invocable<Value&> Visitor>
+		inline bool get(const Key& key, Visitor&& visitor)
+		{
+			auto& shard = getShard(key);
+			std::unique_lock lk(shard.lock);
+			Value* value = shard.cache.get(key);
+			if (!value)
+				return false;
+			visitor(*value);
+			return true;
+		}
+
+		//get a copy of the value at an associated Key, or nullopt if Key is not contained within cache. Does not alter the value use order
+		inline std::optional<Value> peek(const Key& key) const
+		{
+			std::optional<Value> retval;
+			peek(key,[&retval](const Value& value)->void{retval = value;});
+			return retval;
+		}
+		//invoke `visitor` on the value at an associated Key while its shard is locked, returns false if Key is not contained within cache. Does not alter the value use order
+		template<std::invocable<const Value&> Visitor>
+		inline bool peek(const Key& key, Visitor&& visitor) const
+		{
+			auto& shard = getShard(key);
+			// even a peek needs exclusive access, `LRUCache` stashes the searched key in a member during lookup
+			std::unique_lock lk(shard.lock);
+			const Value* value = std::as_const(shard.cache).peek(key);
+			if (!value)
+				return false;
+			visitor(*value);
+			return true;
+		}
+
+		//remove element at key if present
+		inline void erase(const Key& key)
+		{
+			auto& shard = getShard(key);
+			std::unique_lock lk(shard.lock);
+			shard.cache.erase(key);
+		}
+
+	protected:
+		MapHash m_hash;
+		core::vector<std::unique_ptr<Shard>> m_shards;
+};
+
+}
+#endif
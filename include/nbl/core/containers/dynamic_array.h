@@ -10,6 +10,11 @@
 namespace nbl::core
 {
 
+//! Tag for the `dynamic_array` constructors which construct every element exactly once from the result of `generator(index)`,
+//! instead of default constructing the whole array only to overwrite the elements one by one afterwards.
+struct generate_from_index_t {};
+inline constexpr generate_from_index_t generate_from_index = {};
+
 namespace impl
 {
 	template<class allocator>
@@ -101,6 +106,12 @@ class NBL_FORCE_EBO dynamic_array : public impl::dynamic_array_base<allocator,T,
 			for (size_t i = 0ull; i < base_t::item_count; ++i)
 				std::allocator_traits<allocator>::construct(base_t::alctr,storage()+i,std::move(*(it++)));
 		}
+		template<typename Generator> requires std::is_invocable_v<Generator&,size_t>
+		inline dynamic_array(generate_from_index_t, size_t _length, Generator&& _generator, const allocator& _alctr = allocator()) : base_t( _alctr,_length )
+		{
+			for (size_t i = 0ull; i < base_t::item_count; ++i)
+				std::allocator_traits<allocator>::construct(base_t::alctr,storage()+i,_generator(i));
+		}
 
 	public:
 		_NBL_STATIC_INLINE_CONSTEXPR size_t dummy_item_count = (sizeof(base_t)+sizeof(T)-1ull)/sizeof(T);
@@ -136,6 +147,11 @@ class NBL_FORCE_EBO dynamic_array : public impl::dynamic_array_base<allocator,T,
     		auto gccHappyVar = allocator();
 				return std::allocator_traits<allocator>::allocate(gccHappyVar, this_real_type::size_of(_containter) / sizeof(T));
 		}
+		template<typename Generator>
+		static inline void* allocate_dynamic_array(generate_from_index_t, size_t length, const Generator&)
+		{
+			return allocate_dynamic_array(length);
+		}
 		static inline void* allocate_dynamic_array(size_t length, allocator& _alctr)
 		{
 			return std::allocator_traits<allocator>::allocate(_alctr,this_real_type::size_of(length)/sizeof(T));
@@ -149,6 +165,11 @@ class NBL_FORCE_EBO dynamic_array : public impl::dynamic_array_base<allocator,T,
 		{
 			return std::allocator_traits<allocator>::allocate(_alctr, this_real_type::size_of(_containter)/sizeof(T));
 		}
+		template<typename Generator>
+		static inline void* allocate_dynamic_array(generate_from_index_t, size_t length, const Generator&, allocator& _alctr)
+		{
+			return allocate_dynamic_array(length, _alctr);
+		}
 		// factory method to use instead of `new`
 		template<typename... Args>
 		static inline this_real_type* create_dynamic_array(Args&&... args)
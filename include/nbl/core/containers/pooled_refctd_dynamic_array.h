@@ -0,0 +1,150 @@
+// Copyright (C) 2018-2023 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_CORE_POOLED_REFCTD_DYNAMIC_ARRAY_H_INCLUDED_
+#define _NBL_CORE_POOLED_REFCTD_DYNAMIC_ARRAY_H_INCLUDED_
+
+#include "nbl/core/containers/refctd_dynamic_array.h"
+#include "nbl/core/containers/CMemoryPool.h"
+#include "nbl/core/alloc/PoolAddressAllocator.h"
+#include "nbl/core/math/intutil.h"
+
+namespace nbl::core
+{
+
+namespace impl
+{
+	//! Process wide, thread-safe set of fixed size-class memory pools for short `dynamic_array`s
+	/**
+		Allocations are rounded up to a power of two between `MinSizeLog2` and `MaxSizeLog2` bytes and carved out of
+		arenas belonging to that size class, anything bigger (or a pool running out of arenas) goes to the regular aligned heap.
+		The size class is stashed in a header in front of the returned pointer, because `dynamic_array::operator delete` doesn't pass the size.
+	*/
+	class dynamic_array_pool final
+	{
+		public:
+			_NBL_STATIC_INLINE_CONSTEXPR uint32_t MinSizeLog2 = 6u;
+			_NBL_STATIC_INLINE_CONSTEXPR uint32_t MaxSizeLog2 = 11u;
+			_NBL_STATIC_INLINE_CONSTEXPR uint32_t SizeClassCount = MaxSizeLog2-MinSizeLog2+1u;
+			_NBL_STATIC_INLINE_CONSTEXPR uint32_t ArenaSize = 0x1u<<18u;
+			_NBL_STATIC_INLINE_CONSTEXPR uint32_t MaxArenaCount = 64u;
+			_NBL_STATIC_INLINE_CONSTEXPR uint32_t MaxPooledAlignment = 64u;
+			_NBL_STATIC_INLINE_CONSTEXPR uint32_t HeapSizeClass = ~0u;
+
+			static inline dynamic_array_pool& get()
+			{
+				// leaked on purpose, arrays owned by other statics can get released after a function-local static would have been destroyed
+				static dynamic_array_pool* const pool = new dynamic_array_pool();
+				return *pool;
+			}
+
+			//! `alignment` must be a power of two and at least `sizeof(uint32_t)`, the same value must be passed to `deallocate`
+			inline void* allocate(const size_t bytes, const size_t alignment) noexcept
+			{
+				assert(core::isPoT(alignment) && alignment>=sizeof(uint32_t));
+				const size_t totalBytes = bytes+alignment;
+				uint32_t sizeClass = getSizeClass(totalBytes);
+				uint8_t* block = nullptr;
+				if (sizeClass!=HeapSizeClass && alignment<=MaxPooledAlignment)
+					block = reinterpret_cast<uint8_t*>(m_pools[sizeClass].allocate(getSizeClassBytes(sizeClass),alignment));
+				if (!block)
+				{
+					sizeClass = HeapSizeClass;
+					block = reinterpret_cast<uint8_t*>(_NBL_ALIGNED_MALLOC(totalBytes,alignment));
+					if (!block)
+						return nullptr;
+				}
+				uint8_t* const retval = block+alignment;
+				*(reinterpret_cast<uint32_t*>(retval)-1) = sizeClass;
+				return retval;
+			}
+			inline void deallocate(void* ptr, const size_t alignment) noexcept
+			{
+				if (!ptr)
+					return;
+				const uint32_t sizeClass = *(reinterpret_cast<const uint32_t*>(ptr)-1);
+				uint8_t* const block = reinterpret_cast<uint8_t*>(ptr)-alignment;
+				if (sizeClass!=HeapSizeClass)
+					m_pools[sizeClass].deallocate(block,getSizeClassBytes(sizeClass));
+				else
+					_NBL_ALIGNED_FREE(block);
+			}
+
+		private:
+			using pool_t = CMemoryPool<PoolAddressAllocator<uint32_t>,default_aligned_allocator,true,uint32_t>;
+
+			static inline uint32_t getSizeClass(const size_t bytes)
+			{
+				if (bytes>(0x1ull<<MaxSizeLog2))
+					return HeapSizeClass;
+				const uint32_t sizeLog2 = bytes>1ull ? (hlsl::findMSB(uint32_t(bytes-1ull))+1u):0u;
+				return core::max(sizeLog2,MinSizeLog2)-MinSizeLog2;
+			}
+			static inline uint32_t getSizeClassBytes(const uint32_t sizeClass)
+			{
+				return 0x1u<<(sizeClass+MinSizeLog2);
+			}
+
+			template<size_t... SizeClass>
+			dynamic_array_pool(std::index_sequence<SizeClass...>) : m_pools{pool_t(ArenaSize,1u,MaxArenaCount,getSizeClassBytes(SizeClass))...} {}
+			dynamic_array_pool() : dynamic_array_pool(std::make_index_sequence<SizeClassCount>()) {}
+
+			pool_t m_pools[SizeClassCount];
+	};
+}
+
+//! Stateless allocator serving `dynamic_array`s out of `impl::dynamic_array_pool`, for when lots of short lived short arrays would fragment the heap
+template <class T, size_t overAlign=_NBL_DEFAULT_ALIGNMENT(T)>
+class NBL_FORCE_EBO dynamic_array_pool_allocator : public nbl::core::AllocatorTrivialBase<T>
+{
+		static_assert(overAlign>=sizeof(uint32_t));
+
+	public:
+		typedef size_t	size_type;
+		typedef T*		pointer;
+
+		template< class U> struct rebind { typedef dynamic_array_pool_allocator<U,overAlign> other; };
+
+
+		dynamic_array_pool_allocator() {}
+		template<typename U, size_t _align = overAlign>
+		dynamic_array_pool_allocator(const dynamic_array_pool_allocator<U,_align>& other) {}
+
+		inline pointer	allocate(size_type n, const void* hint=nullptr) noexcept
+		{
+			if (n==0)
+				return nullptr;
+			return reinterpret_cast<pointer>(impl::dynamic_array_pool::get().allocate(n*sizeof(T),overAlign));
+		}
+
+		inline void		deallocate(pointer p) noexcept
+		{
+			impl::dynamic_array_pool::get().deallocate(const_cast<typename std::remove_const<T>::type*>(p),overAlign);
+		}
+		inline void		deallocate(pointer p, size_type n) noexcept
+		{
+			deallocate(p);
+		}
+
+		template<typename U, size_t _align>
+		inline bool		operator!=(const dynamic_array_pool_allocator<U,_align>& other) const noexcept
+		{
+			return false;
+		}
+		template<typename U, size_t _align>
+		inline bool		operator==(const dynamic_array_pool_allocator<U,_align>& other) const noexcept
+		{
+			return true;
+		}
+};
+
+//! Same as `refctd_dynamic_array` but the single allocation holding the refcount and elements comes from a size-class pool
+template<typename T, typename... OverAlignmentTypes>
+using pooled_refctd_dynamic_array = refctd_dynamic_array<T,dynamic_array_pool_allocator<typename std::remove_const<T>::type>,OverAlignmentTypes...>;
+
+template<typename T, typename... OverAlignmentTypes>
+using smart_pooled_refctd_dynamic_array = smart_refctd_ptr<pooled_refctd_dynamic_array<T,OverAlignmentTypes...> >;
+
+}
+
+#endif
@@ -83,6 +83,8 @@ class NBL_FORCE_EBO refctd_dynamic_array : public IReferenceCounted, public dyna
 		inline refctd_dynamic_array(const container_t& _containter, const allocator& _alctr = allocator()) : base_t(_containter, _alctr) {}
 		template<typename container_t, typename iterator_t = typename container_t::iterator>
 		inline refctd_dynamic_array(container_t&& _containter, const allocator& _alctr = allocator()) : base_t(std::move(_containter),_alctr) {}
+		template<typename Generator> requires std::is_invocable_v<Generator&,size_t>
+		inline refctd_dynamic_array(generate_from_index_t, size_t _length, Generator&& _generator, const allocator& _alctr = allocator()) : base_t(generate_from_index,_length,std::forward<Generator>(_generator),_alctr) {}
 };
 
 
@@ -96,6 +98,13 @@ inline smart_refctd_dynamic_array_type make_refctd_dynamic_array(Args&&... args)
 	return srdat(srdat::pointee::create_dynamic_array(std::forward<Args>(args)...),dont_grab);
 }
 
+//! Every element gets constructed once, in order, from `generator(index)`
+template<class smart_refctd_dynamic_array_type, typename Generator>
+inline smart_refctd_dynamic_array_type make_refctd_dynamic_array_from_generator(const size_t length, Generator&& generator)
+{
+	return make_refctd_dynamic_array<smart_refctd_dynamic_array_type>(generate_from_index,length,std::forward<Generator>(generator));
+}
+
 
 }
 
@@ -40,8 +40,10 @@
 // containers
 #include "nbl/core/containers/dynamic_array.h"
 #include "nbl/core/containers/refctd_dynamic_array.h"
+#include "nbl/core/containers/pooled_refctd_dynamic_array.h"
 #include "nbl/core/containers/FixedCapacityDoublyLinkedList.h"
 #include "nbl/core/containers/LRUCache.h"
+#include "nbl/core/containers/ConcurrentLRUCache.h"
 // hash functions
 #include "nbl/core/hash/xxHash256.h"
 #include "nbl/core/hash/blake.h"
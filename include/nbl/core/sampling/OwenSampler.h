@@ -18,7 +18,7 @@ namespace core
 	class OwenSampler : protected SequenceSampler
 	{
 	public:
-		OwenSampler(uint32_t _dimensions, uint32_t _seed) : SequenceSampler(_dimensions)
+		OwenSampler(uint32_t _dimensions, uint32_t _seed) : SequenceSampler(_dimensions), seed(_seed)
 		{
 			mersenneTwister.seed(_seed);
 			cachedFlip.resize(MAX_SAMPLES-1u);
@@ -86,6 +86,68 @@ namespace core
 			lastDim = dimension;
 		}
 
+		using layout_t = typename SequenceSampler::E_BATCH_LAYOUT;
+		//! Batched counterpart of `sample()`, dimensions can be requested in any order and are scrambled in parallel.
+		/** Every node of the Owen tree gets its flip from a hash of the constructor seed, the dimension and the node's index, so a sample
+		scrambles to the same value no matter which batch it was generated in, but it is NOT the same realization of the scramble
+		as the one the incremental `sample()` produces.
+		Only the top `k=ceil(log2(firstSample+sampleCount))` levels of the Owen tree are ever shared between samples, so their flips
+		are accumulated into `2^k` masks per dimension up front and the deeper levels get hashed per sample.
+		*/
+		template<class ExecutionPolicy>
+		inline void sampleBatch(ExecutionPolicy&& policy, uint32_t* out, const uint32_t firstDim, const uint32_t dimCount, const uint32_t firstSample, const uint32_t sampleCount, const layout_t layout) const
+		{
+			const uint32_t endSample = firstSample+sampleCount;
+			assert(endSample<=MAX_SAMPLES);
+			SequenceSampler::sampleBatch(policy,out,firstDim,dimCount,firstSample,sampleCount,layout);
+			if (!dimCount || !sampleCount)
+				return;
+
+			const uint32_t treeDepth = endSample>1u ? (hlsl::findMSB(endSample-1u)+1u):0u;
+			// tasks own contiguous dimension ranges so that sample-major rows get written a cacheline at a time
+			constexpr uint32_t DimensionsPerTask = 16u;
+			core::vector<uint32_t> tasks((dimCount-1u)/DimensionsPerTask+1u);
+			std::for_each(policy,tasks.begin(),tasks.end(),[&](uint32_t& task) -> void
+			{
+				const uint32_t localFirstDim = std::distance(tasks.data(),&task)*DimensionsPerTask;
+				const uint32_t localDimCount = core::min(dimCount-localFirstDim,DimensionsPerTask);
+
+				core::vector<uint32_t> dimKeys(localDimCount);
+				core::vector<uint32_t> flips(size_t(localDimCount)<<treeDepth);
+				for (uint32_t i=0u; i<localDimCount; i++)
+				{
+					dimKeys[i] = getDimensionKey(firstDim+localFirstDim+i);
+					generateSharedFlips(flips.data()+(size_t(i)<<treeDepth),dimKeys[i],treeDepth);
+				}
+
+				auto scramble = [treeDepth](const uint32_t dimKey, const uint32_t* dimFlips, uint32_t& x) -> void
+				{
+					uint32_t flip = dimFlips[treeDepth ? (x>>(OUT_BITS-treeDepth)):0u];
+					// levels below `treeDepth` are visited by this sample alone
+					// the root has no prefix and shifting by `OUT_BITS` is undefined
+					for (uint32_t d=treeDepth; d<MAX_SAMPLES_LOG2; d++)
+						flip |= (hashNode(dimKey,d,d ? (x>>(OUT_BITS-d)):0u)&0x1u) ? (0x80000000u>>d):0u;
+					// trailing bits are always 0 so the levels below `MAX_SAMPLES_LOG2` collapse into a single node
+					x ^= flip|(hashNode(dimKey,MAX_SAMPLES_LOG2,x>>(OUT_BITS-MAX_SAMPLES_LOG2))&(0xffffffffu>>MAX_SAMPLES_LOG2));
+				};
+				if (layout==SequenceSampler::EBL_SAMPLE_MAJOR)
+				{
+					for (uint32_t s=0u; s<sampleCount; s++)
+					{
+						uint32_t* row = out+size_t(s)*dimCount+localFirstDim;
+						for (uint32_t i=0u; i<localDimCount; i++)
+							scramble(dimKeys[i],flips.data()+(size_t(i)<<treeDepth),row[i]);
+					}
+				}
+				else for (uint32_t i=0u; i<localDimCount; i++)
+				{
+					uint32_t* column = out+size_t(localFirstDim+i)*sampleCount;
+					for (uint32_t s=0u; s<sampleCount; s++)
+						scramble(dimKeys[i],flips.data()+(size_t(i)<<treeDepth),column[s]);
+				}
+			});
+		}
+
 	protected:
 		// if we don't limit the sample count, then due to IEEE754 precision, we'll get duplicate sample coordinate values, ruining the net property
 		_NBL_STATIC_INLINE_CONSTEXPR uint32_t OUT_BITS = sizeof(uint32_t)*8u;
@@ -97,6 +159,46 @@ namespace core
 			return hlsl::findMSB(sampleNum+1u);
 		}
 
+		// Chris Wellons' lowbias32 integer hash
+		static inline uint32_t mixBits(uint32_t x)
+		{
+			x ^= x>>16u;
+			x *= 0x7feb352du;
+			x ^= x>>15u;
+			x *= 0x846ca68bu;
+			x ^= x>>16u;
+			return x;
+		}
+		inline uint32_t getDimensionKey(const uint32_t dimension) const
+		{
+			return mixBits(dimension+mixBits(seed));
+		}
+		//! random bits of the node at `depth` whose path from the root is the `depth` most significant bits of the sample
+		static inline uint32_t hashNode(const uint32_t dimKey, const uint32_t depth, const uint32_t prefix)
+		{
+			// heap numbering, unique for every depth up to and including `MAX_SAMPLES_LOG2`
+			return mixBits(((0x1u<<depth)|prefix)^dimKey);
+		}
+
+		//! Fills `2^treeDepth` masks with the accumulated flips of the inner nodes above each node at `treeDepth`
+		static inline void generateSharedFlips(uint32_t* flips, const uint32_t dimKey, const uint32_t treeDepth)
+		{
+			// the inner nodes at depth `d` only ever flip bit `OUT_BITS-1-d`, accumulate them from the root down in-place
+			flips[0] = 0u;
+			for (uint32_t d=0u; d<treeDepth; d++)
+			{
+				const uint32_t levelSize = 0x1u<<d;
+				const uint32_t nodeBit = 0x80000000u>>d;
+				for (uint32_t j=levelSize; j--;)
+				{
+					const uint32_t parent = flips[j]|((hashNode(dimKey,d,j)&0x1u) ? nodeBit:0u);
+					flips[j*2u] = parent;
+					flips[j*2u+1u] = parent;
+				}
+			}
+		}
+
+		uint32_t seed;
 		std::mt19937 mersenneTwister;
 		uint32_t lastDim;
 		core::vector<uint32_t> cachedFlip;
@@ -6,6 +6,9 @@
 #define __NBL_CORE_SOBOL_SAMPLER_H_
 
 #include "nbl/core/decl/Types.h"
+#include "nbl/core/execution.h"
+#include "nbl/core/math/intutil.h"
+#include "vectorSIMD.h"
 
 namespace nbl::core
 {
@@ -77,7 +80,7 @@ class SobolSampler
 		}
 		
 		// Idea for optimization, do PoT samples per pass, then can precompute most of the `retval`
-		inline uint32_t sample(uint32_t dim, uint32_t sampleNum)
+		inline uint32_t sample(uint32_t dim, uint32_t sampleNum) const
 		{
 			#ifdef _DEBUG
 				assert(dim<dimensions);
@@ -91,6 +94,83 @@ class SobolSampler
 			return retval;
 		}
 
+		enum E_BATCH_LAYOUT : uint8_t
+		{
+			//! `out[(dim-firstDim)*sampleCount+(sampleNum-firstSample)]`
+			EBL_DIMENSION_MAJOR,
+			//! `out[(sampleNum-firstSample)*dimCount+(dim-firstDim)]`, the layout of a sequence buffer consumed by a path tracer
+			EBL_SAMPLE_MAJOR
+		};
+		//! Generates `sampleCount` consecutive samples of `dimCount` consecutive dimensions into `out`, bit-identical to calling `sample()` in a loop.
+		/** Instead of XOR-ing up to 32 direction vectors per sample, consecutive samples are derived incrementally,
+		going from `n` to `n+1` flips the bits `0` to `findLSB(n+1)` so it's enough to XOR one precomputed prefix-XOR of the direction numbers.
+		Four dimensions are advanced together in one SIMD register and the (dimension group x sample block) tasks run under `policy`.
+		*/
+		template<class ExecutionPolicy>
+		inline void sampleBatch(ExecutionPolicy&& policy, uint32_t* out, const uint32_t firstDim, const uint32_t dimCount, const uint32_t firstSample, const uint32_t sampleCount, const E_BATCH_LAYOUT layout) const
+		{
+			assert(firstDim+dimCount<=dimensions);
+			assert(uint64_t(firstSample)+sampleCount<=(0x1ull<<SOBOL_BITS));
+			if (!dimCount || !sampleCount)
+				return;
+
+			auto vectors = *reinterpret_cast<const uint32_t(*)[][SOBOL_BITS]>(directions);
+			// lane `i` of `prefixXor[group*SOBOL_BITS+k]` holds `v[0]^v[1]^...^v[k]` of dimension `firstDim+group*4+i`
+			const uint32_t groupCount = (dimCount+3u)/4u;
+			core::vector<vectorSIMDu32> prefixXor(groupCount*SOBOL_BITS);
+			for (uint32_t group=0u; group<groupCount; group++)
+			{
+				uint32_t accumulator[4] = {0u,0u,0u,0u};
+				for (uint32_t k=0u; k<SOBOL_BITS; k++)
+				{
+					for (uint32_t i=0u; i<4u; i++)
+					{
+						const uint32_t localDim = group*4u+i;
+						if (localDim<dimCount)
+							accumulator[i] ^= vectors[firstDim+localDim][k];
+					}
+					prefixXor[group*SOBOL_BITS+k] = vectorSIMDu32(accumulator);
+				}
+			}
+
+			constexpr uint32_t SamplesPerTask = 0x1u<<12u;
+			const uint32_t blockCount = (sampleCount-1u)/SamplesPerTask+1u;
+			core::vector<uint32_t> tasks(groupCount*blockCount);
+			std::for_each(policy,tasks.begin(),tasks.end(),[&](uint32_t& task) -> void
+			{
+				const uint32_t taskID = std::distance(tasks.data(),&task);
+				const uint32_t group = taskID/blockCount;
+				const uint32_t localFirstSample = (taskID%blockCount)*SamplesPerTask;
+				const uint32_t localEndSample = core::min(localFirstSample+SamplesPerTask,sampleCount);
+
+				const uint32_t localDim = group*4u;
+				const uint32_t lanes = core::min(dimCount-localDim,4u);
+				const vectorSIMDu32* groupPrefixXor = prefixXor.data()+group*SOBOL_BITS;
+				// only the first sample of the block is computed from scratch
+				uint32_t seed[4] = {0u,0u,0u,0u};
+				for (uint32_t i=0u; i<lanes; i++)
+					seed[i] = sample(firstDim+localDim+i,firstSample+localFirstSample);
+				vectorSIMDu32 x(seed);
+
+				for (uint32_t s=localFirstSample; s<localEndSample; s++)
+				{
+					if (layout==EBL_SAMPLE_MAJOR)
+					{
+						uint32_t* dst = out+size_t(s)*dimCount+localDim;
+						if (lanes==4u)
+							_mm_storeu_si128(reinterpret_cast<__m128i*>(dst),x.getAsRegister());
+						else for (uint32_t i=0u; i<lanes; i++)
+							dst[i] = x[i];
+					}
+					else for (uint32_t i=0u; i<lanes; i++)
+						out[size_t(localDim+i)*sampleCount+s] = x[i];
+
+					if (s+1u<localEndSample)
+						x ^= groupPrefixXor[hlsl::findLSB(firstSample+s+1u)];
+				}
+			});
+		}
+
 	protected:
 		typedef struct SobolDirectionNumbers {
 			uint32_t d, s, a;
@@ -47,6 +47,14 @@ namespace MitsubaLoader
 		//
 		using shape_ass_type = core::smart_refctd_ptr<asset::ICPUMesh>;
 		core::map<const CElementShape*, shape_ass_type> shapeCache;
+		// model files get loaded in parallel up-front, each filename only once no matter how many shapes reference it
+		struct SModelFile
+		{
+			asset::SAssetBundle bundle;
+			// `.serialized` files hold many meshes, maps the `shapeIndex` to the bundle content index
+			core::unordered_map<uint32_t,uint32_t> shapeIndexToContent;
+		};
+		core::unordered_map<std::string,SModelFile> modelCache;
 		//image, sampler
 		using tex_ass_type = std::tuple<core::smart_refctd_ptr<asset::ICPUImageView>,core::smart_refctd_ptr<asset::ICPUSampler>>;
 		//image, scale
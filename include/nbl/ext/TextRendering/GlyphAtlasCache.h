@@ -0,0 +1,169 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef _NBL_EXT_TEXT_RENDERING_GLYPH_ATLAS_CACHE_H_INCLUDED_
+#define _NBL_EXT_TEXT_RENDERING_GLYPH_ATLAS_CACHE_H_INCLUDED_
+
+#include "nbl/ext/TextRendering/TextRendering.h"
+#include "nbl/ext/TextRendering/stb_rect_pack.h"
+#include "nbl/system/SReadWriteSpinLock.h"
+
+namespace nbl
+{
+namespace ext
+{
+namespace TextRendering
+{
+
+// Keeps the MSDFs of one font face's glyphs resident in fixed size atlas pages laid out with `stb_rect_pack`.
+// Missing glyphs of a `request` get generated together, the outlines are extracted serially (FreeType faces aren't thread-safe)
+// and the MSDFs are generated in parallel straight into the pages. Once `maxPageCount` pages are full, the least recently used
+// page gets evicted as a whole, because the skyline packer can't free individual rectangles.
+// `request` itself must not be called concurrently.
+class GlyphAtlasCache : public nbl::core::IReferenceCounted
+{
+public:
+
+	// Generated glyph MSDFs keyed by the font file's content hash, glyph, pixel range and extents, can be saved to disk so warm starts skip msdfgen entirely
+	// Thread-safe, and can be shared between atlases of different fonts
+	class CPersistentCache : public nbl::core::IReferenceCounted
+	{
+	public:
+		static constexpr uint32_t MAGIC = 0x4341474eu; // "NGAC"
+		static constexpr uint32_t VERSION = 3u;
+
+		struct SKey
+		{
+			bool operator==(const SKey&) const = default;
+
+			core::blake3_hash_t fontHash;
+			uint32_t glyphId;
+			uint32_t msdfPixelRange;
+			uint32_t width;
+			uint32_t height;
+		};
+
+		// copies the cached texels into `dst` whose rows are `dstRowPitch` bytes apart, returns false on a miss
+		bool find(const SKey& key, int8_t* dst, size_t dstRowPitch) const;
+		void insert(const SKey& key, const int8_t* src, size_t srcRowPitch);
+
+		size_t size() const
+		{
+			auto lk = system::read_lock_guard<>(m_lock);
+			return m_container.size();
+		}
+
+		core::smart_refctd_ptr<ICPUBuffer> serialize() const;
+		// returns nullptr if the data isn't a serialized cache, is truncated or was written by a different `VERSION`
+		static core::smart_refctd_ptr<CPersistentCache> deserialize(const std::span<const uint8_t> serializedCache);
+
+	private:
+		struct KeyHasher
+		{
+			size_t operator()(const SKey& key) const
+			{
+				size_t hash = std::hash<core::blake3_hash_t>()(key.fontHash);
+				core::hash_combine<uint32_t>(hash, key.glyphId);
+				core::hash_combine<uint32_t>(hash, key.msdfPixelRange);
+				core::hash_combine<uint32_t>(hash, key.width);
+				core::hash_combine<uint32_t>(hash, key.height);
+				return hash;
+			}
+		};
+
+		core::unordered_map<SKey, core::vector<int8_t>, KeyHasher> m_container;
+		mutable system::SReadWriteSpinLock m_lock;
+	};
+
+	struct SGlyphRequest
+	{
+		uint32_t glyphId;
+		uint32_t msdfPixelRange;
+		// size of the glyph's MSDF in texels, same meaning as `textureExtents` of `FontFace::generateGlyphMSDF`
+		uint32_t2 extents;
+	};
+
+	static constexpr uint32_t InvalidPage = ~0u;
+	// texels left empty between neighbouring glyphs so bilinear filtering doesn't bleed
+	static constexpr uint32_t GlyphPadding = 1u;
+
+	struct SGlyphLocation
+	{
+		// `InvalidPage` if the glyph is bigger than a page or couldn't fit without evicting glyphs of the same request
+		uint32_t page = InvalidPage;
+		uint32_t2 offset = uint32_t2(0u, 0u);
+		uint32_t2 extents = uint32_t2(0u, 0u);
+	};
+
+	// `system` is only needed with a `persistentCache`, to hash the font file its entries are keyed by, the persistent cache gets dropped if that fails
+	GlyphAtlasCache(core::smart_refctd_ptr<FontFace>&& face, uint32_t2 pageExtents, uint32_t maxPageCount, core::smart_refctd_ptr<CPersistentCache>&& persistentCache = nullptr, system::ISystem* system = nullptr);
+
+	// Makes all `glyphs` resident, generating (or fetching from the persistent cache) the missing ones, and returns their locations in the same order.
+	// Locations stay valid until the next call, which might evict their page.
+	core::vector<SGlyphLocation> request(const std::span<const SGlyphRequest> glyphs);
+
+	uint32_t getPageCount() const { return m_pages.size(); }
+	// `TextRenderer::MSDFTextureFormat` texels, `getPageExtents()` big with tightly packed rows
+	const ICPUBuffer* getPageBuffer(uint32_t page) const { return m_pages[page]->buffer.get(); }
+	uint32_t2 getPageExtents() const { return m_pageExtents; }
+
+	// returns the pages written to since the last call, so only those need to be re-uploaded
+	core::vector<uint32_t> takeDirtyPages();
+
+	FontFace* getFontFace() const { return m_face.get(); }
+	CPersistentCache* getPersistentCache() const { return m_persistentCache.get(); }
+
+protected:
+	struct SGlyphKey
+	{
+		bool operator==(const SGlyphKey&) const = default;
+
+		uint32_t glyphId;
+		uint32_t msdfPixelRange;
+		uint32_t width;
+		uint32_t height;
+	};
+	struct GlyphKeyHasher
+	{
+		size_t operator()(const SGlyphKey& key) const
+		{
+			size_t hash = std::hash<uint32_t>()(key.glyphId);
+			core::hash_combine<uint32_t>(hash, key.msdfPixelRange);
+			core::hash_combine<uint32_t>(hash, key.width);
+			core::hash_combine<uint32_t>(hash, key.height);
+			return hash;
+		}
+	};
+
+	struct Page
+	{
+		core::smart_refctd_ptr<ICPUBuffer> buffer;
+		// the context points into itself and `nodes`, hence pages are heap allocated and never move
+		stbrp_context packer;
+		core::vector<stbrp_node> nodes;
+		core::vector<SGlyphKey> residentGlyphs;
+		uint64_t lastUsed = 0u;
+		bool dirty = false;
+	};
+
+	std::unique_ptr<Page> createPage() const;
+	// forgets all glyphs on the page and starts packing it from scratch
+	void resetPage(Page& page);
+
+	core::smart_refctd_ptr<FontFace> m_face;
+	core::smart_refctd_ptr<CPersistentCache> m_persistentCache;
+	core::blake3_hash_t m_fontHash;
+	uint32_t2 m_pageExtents;
+	uint32_t m_maxPageCount;
+
+	core::vector<std::unique_ptr<Page>> m_pages;
+	core::unordered_map<SGlyphKey, SGlyphLocation, GlyphKeyHasher> m_resident;
+	uint64_t m_useCounter = 0u;
+};
+
+}
+}
+}
+
+#endif
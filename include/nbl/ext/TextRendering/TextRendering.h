@@ -36,6 +36,9 @@ public:
 
 	// Spits out CPUBuffer containing the image data in SNORM format
 	core::smart_refctd_ptr<ICPUBuffer> generateShapeMSDF(msdfgen::Shape glyph, uint32_t msdfPixelRange, uint32_t2 msdfExtents, float32_t2 scale, float32_t2 translate);
+	// Same as above but writes into `dst` whose rows are `dstRowPitch` bytes apart, so glyphs can go straight into an atlas page
+	// Doesn't touch FreeType, so it's safe to call concurrently for different shapes
+	void generateShapeMSDF(int8_t* dst, size_t dstRowPitch, msdfgen::Shape glyph, uint32_t msdfPixelRange, uint32_t2 msdfExtents, float32_t2 scale, float32_t2 translate);
 
 	TextRenderer()
 	{
@@ -90,6 +93,7 @@ public:
 		auto error = FT_New_Face(m_textRenderer->m_ftLibrary, path.c_str(), 0, &m_ftFace);
 		assert(!error);
 
+		m_path = path;
 		m_hash = std::hash<std::string>{}(path);
 	}
 
@@ -121,10 +125,18 @@ public:
 	// use the `getUV` to address the glyph in your texture correctly.
 	core::smart_refctd_ptr<ICPUBuffer> generateGlyphMSDF(uint32_t msdfPixelRange, uint32_t glyphId, uint32_t2 textureExtents);
 
+	// scale and translation `generateGlyphMSDF` uses to center `shape` in `textureExtents` with a margin of `msdfPixelRange`
+	static void getGlyphMSDFTransform(const msdfgen::Shape& shape, uint32_t msdfPixelRange, uint32_t2 textureExtents, float32_t2& outScale, float32_t2& outTranslate);
+
 	// transforms uv in glyph space to uv in the actual texture
 	float32_t2 getUV(float32_t2 uv, float32_t2 glyphSize, uint32_t2 textureExtents, uint32_t msdfPixelRange);
 
 	size_t getHash() { return m_hash; }
+	// BLAKE3 of the font file's contents, unlike `getHash()` it stays the same when the file moves and changes when it gets replaced
+	// The file is read through `system` on the first call only, returns nullptr if it couldn't be read
+	const core::blake3_hash_t* getContentHash(system::ISystem* system);
+
+	TextRenderer* getTextRenderer() const { return m_textRenderer.get(); }
 	
 	// TODO: make these protected, it's only used for customized tests such as building shapes for hatches
 	FT_GlyphSlot getGlyphSlot(uint32_t glyphId)
@@ -137,10 +149,12 @@ public:
 	msdfgen::Shape generateGlyphShape(uint32_t glyphId);
 
 protected:
-
 	core::smart_refctd_ptr<TextRenderer> m_textRenderer;
 	FT_Face m_ftFace;
+	std::string m_path;
 	size_t m_hash;
+	std::mutex m_contentHashLock;
+	std::optional<core::blake3_hash_t> m_contentHash;
 };
 
 // Helper class for building an msdfgen shape from a glyph
@@ -0,0 +1,115 @@
+// Copyright (C) 2018-2023 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef _NBL_SCENE_C_CPU_TRANSFORM_TREE_H_INCLUDED_
+#define _NBL_SCENE_C_CPU_TRANSFORM_TREE_H_INCLUDED_
+
+#include "nbl/core/declarations.h"
+
+namespace nbl::scene
+{
+
+//! Host-only transform hierarchy with the same node model as the GPU `ITransformTree`
+/** Every node has a parent, a relative transform with a modified stamp and a global transform with a recomputed stamp.
+* Node handles stay stable, but the properties live in Structure of Arrays storage which gets re-laid out breadth-first
+* (sorted by depth, siblings contiguous) whenever the topology changed, so that `recomputeGlobalTransforms` can update one
+* depth level at a time in parallel and never read a parent's global transform before it's final.
+* Only subtrees under modified nodes get recomputed, unless they cover so much of the tree that a plain linear sweep is cheaper.
+* Not thread-safe, all the parallelism is internal to `recomputeGlobalTransforms`.
+*/
+class CCPUTransformTree final : public core::IReferenceCounted
+{
+	public:
+		using node_t = uint32_t;
+		static inline constexpr node_t invalid_node = 0xdeadbeefu;
+
+		using timestamp_t = uint32_t;
+		// two timestamp values are reserved for initialization
+		static inline constexpr timestamp_t min_timestamp = 0u;
+		static inline constexpr timestamp_t max_timestamp = 0xfffffffcu;
+		static inline constexpr timestamp_t initial_modified_timestamp = 0xfffffffdu;
+		static inline constexpr timestamp_t initial_recomputed_timestamp = 0xfffffffeu;
+
+		using parent_t = node_t;
+		using relative_transform_t = core::matrix3x4SIMD;
+		using modified_stamp_t = timestamp_t;
+		using global_transform_t = core::matrix3x4SIMD;
+		using recomputed_stamp_t = timestamp_t;
+
+		//! when the subtrees of the modified nodes are estimated to cover more than this fraction of the tree, every node gets recomputed
+		static inline constexpr float FullSweepRatio = 0.5f;
+		//! depth levels with fewer nodes to update than this are processed on the calling thread
+		static inline constexpr uint32_t MinParallelLevelSize = 256u;
+
+		CCPUTransformTree() = default;
+
+		//
+		inline uint32_t getNodeCount() const {return m_nodeCount;}
+
+		//! `parents` and `relativeTransforms` are either empty (root nodes, identity transforms) or as long as `outNodes`
+		//! a parent must already exist or come earlier in the same call
+		void addNodes(const std::span<node_t> outNodes, const std::span<const parent_t> parents={}, const std::span<const relative_transform_t> relativeTransforms={});
+		//! children of removed nodes become roots
+		void removeNodes(const std::span<const node_t> nodes);
+		//! removes all nodes in the hierarchy
+		void clearNodes();
+
+		//
+		inline parent_t getParent(const node_t node) const {return m_parents[node];}
+		//! returns false and doesn't change anything if `parent` is in the subtree of `node`
+		bool setParent(const node_t node, const parent_t parent);
+
+		//
+		inline const relative_transform_t& getRelativeTransform(const node_t node) const {return m_relativeTransforms[m_nodeToSlot[node]];}
+		inline modified_stamp_t getModifiedStamp(const node_t node) const {return m_modifiedStamps[m_nodeToSlot[node]];}
+		//! stamps the node with the current timestamp, the new global transforms get computed by the next `recomputeGlobalTransforms`
+		void setRelativeTransform(const node_t node, const relative_transform_t& transform);
+
+		//! only valid when `getRecomputedStamp(node)==getModifiedStamp(node)`, or right after `recomputeGlobalTransforms`
+		inline const global_transform_t& getGlobalTransform(const node_t node) const {return m_globalTransforms[m_nodeToSlot[node]];}
+		inline recomputed_stamp_t getRecomputedStamp(const node_t node) const {return m_recomputedStamps[m_nodeToSlot[node]];}
+
+		//! the stamp the next relative transform modifications will get
+		inline timestamp_t getCurrentTimestamp() const {return m_currentTimestamp;}
+
+		//! brings the global transforms of all modified nodes and their descendants up to date, then advances the current timestamp
+		void recomputeGlobalTransforms();
+
+	protected:
+		~CCPUTransformTree() = default;
+
+		static inline constexpr uint32_t invalid_slot = ~0u;
+
+		uint32_t appendSlot(const node_t node, const relative_transform_t& transform);
+		void relayout();
+
+		// per node handle
+		core::vector<uint32_t> m_nodeToSlot;
+		core::vector<parent_t> m_parents;
+		core::vector<node_t> m_freeNodes;
+		// per slot, breadth-first order after `relayout`, dead slots have `invalid_node`
+		core::vector<node_t> m_slotToNode;
+		core::vector<uint32_t> m_parentSlots;
+		core::vector<relative_transform_t> m_relativeTransforms;
+		core::vector<modified_stamp_t> m_modifiedStamps;
+		core::vector<global_transform_t> m_globalTransforms;
+		core::vector<recomputed_stamp_t> m_recomputedStamps;
+		core::vector<uint32_t> m_firstChildSlots;
+		core::vector<uint32_t> m_childCounts;
+		core::vector<uint32_t> m_subtreeSizes;
+		// slot ranges of each depth, `m_levelBegin.back()` is the slot count
+		core::vector<uint32_t> m_levelBegin;
+		// nodes whose relative transform (or parent) changed since the last recompute
+		core::vector<node_t> m_modifiedNodes;
+		// scratch for deduplicating the sparse update frontier, always all zero outside of `recomputeGlobalTransforms`
+		core::vector<uint8_t> m_queued;
+
+		uint32_t m_nodeCount = 0u;
+		timestamp_t m_currentTimestamp = min_timestamp;
+		bool m_topologyChanged = false;
+};
+
+} // end namespace nbl::scene
+
+#endif
@@ -8,6 +8,7 @@
 //
 #include "nbl/scene/CLevelOfDetailLibrary.h"
 #include "nbl/scene/ITransformTreeManager.h"
+#include "nbl/scene/CCPUTransformTree.h"
 
 #include "nbl/scene/ICullingLoDSelectionSystem.h"
 
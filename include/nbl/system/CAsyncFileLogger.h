@@ -0,0 +1,38 @@
+#ifndef _NBL_SYSTEM_C_ASYNC_FILE_LOGGER_INCLUDED_
+#define _NBL_SYSTEM_C_ASYNC_FILE_LOGGER_INCLUDED_
+
+#include "nbl/system/IAsyncLogger.h"
+#include "nbl/system/IFile.h"
+
+namespace nbl::system
+{
+
+//! Same output as `CFileLogger`, but the lines get written by a background thread with one `IFile::write` per batch
+class CAsyncFileLogger : public IAsyncLogger
+{
+	public:
+		CAsyncFileLogger(core::smart_refctd_ptr<IFile>&& _file, const bool append, const core::bitflag<E_LOG_LEVEL> logLevelMask=ILogger::DefaultLogMask(), const E_OVERFLOW_POLICY overflowPolicy=EOP_BLOCK, const uint32_t ringByteSize=DefaultRingByteSize)
+			: IAsyncLogger(logLevelMask,overflowPolicy,ringByteSize), m_file(std::move(_file)), m_pos(append ? m_file->getSize():0ull)
+		{
+		}
+
+	protected:
+		~CAsyncFileLogger()
+		{
+			terminate();
+		}
+
+		virtual void flush_impl(const std::string_view batch) override
+		{
+			IFile::success_t succ;
+			m_file->write(succ,batch.data(),m_pos,batch.size());
+			m_pos += succ.getBytesProcessed();
+		}
+
+		core::smart_refctd_ptr<IFile> m_file;
+		size_t m_pos;
+};
+
+}
+
+#endif
@@ -0,0 +1,73 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_SYSTEM_C_GROWABLE_MEMORY_FILE_H_INCLUDED_
+#define _NBL_SYSTEM_C_GROWABLE_MEMORY_FILE_H_INCLUDED_
+
+
+#include "nbl/system/IFile.h"
+
+
+namespace nbl::system
+{
+
+//! In-memory file which grows with every write past its end, for encoding something before it goes anywhere (one big write, an archive, a network)
+/** It's not mappable, because the storage moves when it grows, reads and writes complete immediately on the calling thread.
+* Not thread-safe.
+*/
+class CGrowableMemoryFile final : public IFile
+{
+	public:
+		inline CGrowableMemoryFile(path&& _name, const size_t initialCapacity=0ull) : IFile(std::move(_name),ECF_READ_WRITE,time_point_t::clock::now())
+		{
+			m_data.reserve(initialCapacity);
+		}
+
+		inline size_t getSize() const override {return m_data.size();}
+
+		//
+		inline const core::vector<uint8_t>& getData() const {return m_data;}
+		//! leaves the file empty
+		inline core::vector<uint8_t> releaseData() {return std::move(m_data);}
+
+	protected:
+		~CGrowableMemoryFile() = default;
+
+		inline void* getMappedPointer_impl() override {return nullptr;}
+		inline const void* getMappedPointer_impl() const override {return nullptr;}
+
+		inline void unmappedRead(ISystem::future_t<size_t>& fut, void* buffer, size_t offset, size_t sizeToRead) override
+		{
+			if (offset>=m_data.size())
+				sizeToRead = 0ull;
+			else if (offset+sizeToRead>m_data.size())
+				sizeToRead = m_data.size()-offset;
+			if (sizeToRead)
+				memcpy(buffer,m_data.data()+offset,sizeToRead);
+			SFutureManipulator().set_result(fut,sizeToRead);
+		}
+		inline void unmappedWrite(ISystem::future_t<size_t>& fut, const void* buffer, size_t offset, size_t sizeToWrite) override
+		{
+			if (offset+sizeToWrite>m_data.size())
+			{
+				// amortized growth, `resize` alone would grow by exactly what's needed on some implementations
+				if (offset+sizeToWrite>m_data.capacity())
+					m_data.reserve(core::max(offset+sizeToWrite,m_data.capacity()*2ull));
+				m_data.resize(offset+sizeToWrite);
+			}
+			memcpy(m_data.data()+offset,buffer,sizeToWrite);
+			SFutureManipulator().set_result(fut,sizeToWrite);
+		}
+
+		// `IFile` inherits the manipulator privately
+		struct SFutureManipulator final : ISystem::IFutureManipulator
+		{
+			using ISystem::IFutureManipulator::set_result;
+		};
+
+		core::vector<uint8_t> m_data;
+};
+
+}
+
+#endif
@@ -0,0 +1,342 @@
+#ifndef _NBL_SYSTEM_I_ASYNC_LOGGER_INCLUDED_
+#define _NBL_SYSTEM_I_ASYNC_LOGGER_INCLUDED_
+
+#include "nbl/system/ILogger.h"
+#include "nbl/core/decl/Types.h"
+#include "nbl/core/math/intutil.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+
+namespace nbl::system
+{
+
+//! Logger which keeps the timestamp formatting, the ordering and the I/O off the logging threads.
+/** Every thread that logs gets its own single producer single consumer ring buffer of records (timestamp, level, message),
+* pushing a record takes no locks and no allocations (except for the first message of a thread, which registers its ring).
+* A background thread drains all rings, orders the batch by timestamp, formats the full log lines and hands them to `flush_impl` at once.
+* The message itself still gets `vsnprintf`-ed by the caller because a `va_list` has lost the types of its arguments
+* and `%s` arguments need not outlive the call, so the format can't be deferred.
+* Memory is bounded by `ringByteSize` per logging thread, when a ring is full the message either gets dropped (and counted)
+* or the caller waits for the background thread, depending on the `E_OVERFLOW_POLICY`.
+* Derived classes must call `terminate()` in their destructor, so that the last batch is flushed while they still exist.
+*/
+class IAsyncLogger : public ILogger
+{
+	public:
+		enum E_OVERFLOW_POLICY : uint8_t
+		{
+			EOP_DROP = 0,
+			EOP_BLOCK
+		};
+
+		//! per logging thread
+		static inline constexpr uint32_t DefaultRingByteSize = 0x1u<<16u;
+		//! messages longer than this get formatted a second time straight into the ring, instead of being copied from the stack
+		static inline constexpr uint32_t StackMessageByteSize = 512u;
+
+		//! blocks until everything logged before the call has been passed to `flush_impl`, never call from within `flush_impl`
+		inline void flush()
+		{
+			if (!m_thread.joinable())
+				return;
+			const uint64_t target = m_epoch.fetch_add(1u,std::memory_order_acq_rel)+1u;
+			m_epoch.notify_one();
+			for (uint64_t drained=m_drainedEpoch.load(std::memory_order_acquire); drained<target; drained=m_drainedEpoch.load(std::memory_order_acquire))
+				m_drainedEpoch.wait(drained,std::memory_order_acquire);
+		}
+
+		inline E_OVERFLOW_POLICY getOverflowPolicy() const {return m_overflowPolicy;}
+		inline uint32_t getRingByteSize() const {return m_ringByteSize;}
+
+	protected:
+		IAsyncLogger(const core::bitflag<E_LOG_LEVEL> logLevelMask, const E_OVERFLOW_POLICY overflowPolicy=EOP_BLOCK, const uint32_t ringByteSize=DefaultRingByteSize)
+			: ILogger(logLevelMask), m_overflowPolicy(overflowPolicy), m_ringByteSize(core::roundUpToPoT(core::max(ringByteSize,4u*StackMessageByteSize)))
+		{
+			// `flush_impl` only ever gets called after the first message, so the derived object is complete by then
+			m_thread = std::thread(&IAsyncLogger::run,this);
+		}
+		virtual ~IAsyncLogger()
+		{
+			terminate();
+		}
+
+		//! Called on the background thread only, with a batch of complete, newline terminated log lines.
+		virtual void flush_impl(const std::string_view batch) = 0;
+
+		//! Flushes everything logged so far and stops the background thread, messages logged afterwards get dropped.
+		inline void terminate()
+		{
+			if (!m_thread.joinable())
+				return;
+			m_quit.store(true,std::memory_order_release);
+			m_epoch.fetch_add(1u,std::memory_order_release);
+			m_epoch.notify_one();
+			m_thread.join();
+		}
+
+		inline void log_impl(const std::string_view& fmtString, E_LOG_LEVEL logLevel, va_list args) override final
+		{
+			using namespace std::chrono;
+			const int64_t timestamp = duration_cast<microseconds>(system_clock::now().time_since_epoch()).count();
+			if (logLevel==ELL_NONE)
+				return;
+			SRing& ring = getThreadRing();
+
+			va_list argsCopy; // in case the message doesn't fit on the stack
+			va_copy(argsCopy,args);
+			char stackMessage[StackMessageByteSize];
+			const int formattedLength = vsnprintf(stackMessage,StackMessageByteSize,fmtString.data(),args);
+			if (formattedLength>=0)
+			{
+				// a single message is never allowed to take up more than half the ring
+				const uint32_t messageLength = core::min<uint32_t>(formattedLength,m_ringByteSize/2u-sizeof(SRecordHeader)-alignof(SRecordHeader));
+				const uint32_t recordByteSize = core::roundUp<uint32_t>(sizeof(SRecordHeader)+messageLength+1u,alignof(SRecordHeader));
+				uint32_t byteSize = recordByteSize;
+				if (uint8_t* const record=reserve(ring,byteSize))
+				{
+					auto* const header = reinterpret_cast<SRecordHeader*>(record);
+					header->timestamp = timestamp;
+					header->byteSize = recordByteSize;
+					header->messageLength = messageLength;
+					header->level = logLevel;
+					char* const message = reinterpret_cast<char*>(header+1);
+					if (formattedLength<StackMessageByteSize)
+						memcpy(message,stackMessage,messageLength);
+					else
+						vsnprintf(message,messageLength+1u,fmtString.data(),argsCopy);
+					commit(ring,byteSize);
+				}
+			}
+			va_end(argsCopy);
+		}
+
+	private:
+		struct SRecordHeader
+		{
+			// microseconds since the epoch of `std::chrono::system_clock`
+			int64_t timestamp;
+			// of the whole record, including the message and its padding
+			uint32_t byteSize;
+			uint32_t messageLength;
+			// `ELL_NONE` marks the unused tail of the ring before a record that wrapped around
+			E_LOG_LEVEL level;
+		};
+
+		struct SRing
+		{
+			SRing(const uint32_t _byteSize) : storage(std::make_unique<uint64_t[]>(_byteSize/sizeof(uint64_t))), mask(_byteSize-1u) {}
+
+			inline uint8_t* data() {return reinterpret_cast<uint8_t*>(storage.get());}
+			inline uint32_t byteSize() const {return mask+1u;}
+
+			std::unique_ptr<uint64_t[]> storage;
+			const uint32_t mask;
+			// monotonic byte offsets, only the logging thread writes `writeOffset` and only the background thread `readOffset`
+			alignas(64) std::atomic<uint64_t> writeOffset = 0ull;
+			alignas(64) std::atomic<uint64_t> readOffset = 0ull;
+			std::atomic<uint32_t> droppedCount = 0u;
+		};
+
+		struct SRecordView
+		{
+			int64_t timestamp;
+			E_LOG_LEVEL level;
+			std::string_view message;
+		};
+
+		//! The rings are shared between the logger and a `thread_local` registry, so that a ring outlives neither its thread nor its logger needlessly.
+		inline SRing& getThreadRing()
+		{
+			thread_local core::vector<std::pair<const IAsyncLogger*,std::shared_ptr<SRing>>> threadRings;
+			for (const auto& entry : threadRings)
+			if (entry.first==this && entry.second.use_count()>1)
+				return *entry.second;
+
+			// first message of this thread, also forget the rings of loggers which are gone (one could have had the same address)
+			std::erase_if(threadRings,[](const auto& entry)->bool{return entry.second.use_count()==1;});
+			auto ring = std::make_shared<SRing>(m_ringByteSize);
+			{
+				std::lock_guard<std::mutex> lock(m_ringsMutex);
+				m_rings.push_back(ring);
+			}
+			threadRings.emplace_back(this,ring);
+			return *ring;
+		}
+
+		//! Returns where to write a record of `byteSize` or nullptr if it got dropped, `byteSize` grows by the skipped tail of the ring if it had to wrap around.
+		inline uint8_t* reserve(SRing& ring, uint32_t& byteSize)
+		{
+			const uint64_t writeOffset = ring.writeOffset.load(std::memory_order_relaxed);
+			const uint32_t pos = writeOffset&ring.mask;
+			// records are contiguous, if one doesn't fit before the end of the ring, the rest of it gets skipped
+			const uint32_t tailByteSize = ring.byteSize()-pos;
+			const uint32_t padding = tailByteSize<byteSize ? tailByteSize:0u;
+			while (writeOffset+padding+byteSize-ring.readOffset.load(std::memory_order_acquire)>ring.byteSize())
+			{
+				if (m_overflowPolicy==EOP_DROP || m_quit.load(std::memory_order_acquire))
+				{
+					ring.droppedCount.fetch_add(1u,std::memory_order_relaxed);
+					return nullptr;
+				}
+				std::this_thread::yield();
+			}
+			// too short a tail for a header gets skipped by the reader without one
+			if (padding>=sizeof(SRecordHeader))
+			{
+				auto* const header = reinterpret_cast<SRecordHeader*>(ring.data()+pos);
+				header->byteSize = padding;
+				header->level = ELL_NONE;
+			}
+			byteSize += padding;
+			return ring.data()+((writeOffset+padding)&ring.mask);
+		}
+		inline void commit(SRing& ring, const uint32_t byteSize)
+		{
+			ring.writeOffset.store(ring.writeOffset.load(std::memory_order_relaxed)+byteSize,std::memory_order_release);
+			m_epoch.fetch_add(1u,std::memory_order_release);
+			m_epoch.notify_one();
+		}
+
+		static inline const char* getLevelString(const E_LOG_LEVEL logLevel)
+		{
+			switch (logLevel)
+			{
+				case ELL_DEBUG:
+					return "[DEBUG]";
+				case ELL_INFO:
+					return "[INFO]";
+				case ELL_WARNING:
+					return "[WARNING]";
+				case ELL_PERFORMANCE:
+					return "[PERFORMANCE]";
+				case ELL_ERROR:
+					return "[ERROR]";
+				default:
+					break;
+			}
+			return "";
+		}
+
+		//! same layout as `ILogger::constructLogString`
+		inline void appendLogLine(std::string& batch, const int64_t timestamp, const E_LOG_LEVEL logLevel, const std::string_view message)
+		{
+			const std::time_t seconds = timestamp/1000000;
+			// `localtime` is slow, but log lines tend to come in bursts within the same second
+			if (seconds!=m_cachedSeconds)
+			{
+				m_cachedTime = *std::localtime(&seconds);
+				m_cachedSeconds = seconds;
+			}
+			char prefix[64];
+			const int prefixLength = snprintf(prefix,sizeof(prefix),"[%02d.%02d.%d %02d:%02d:%02d:%06d]%s: ",
+				m_cachedTime.tm_mday,m_cachedTime.tm_mon+1,1900+m_cachedTime.tm_year,m_cachedTime.tm_hour,m_cachedTime.tm_min,m_cachedTime.tm_sec,int(timestamp%1000000),getLevelString(logLevel)
+			);
+			batch.append(prefix,core::max(prefixLength,0));
+			batch.append(message);
+			batch.push_back('\n');
+		}
+
+		void run()
+		{
+			core::vector<std::shared_ptr<SRing>> rings;
+			core::vector<uint64_t> newReadOffsets;
+			core::vector<SRecordView> records;
+			std::string batch;
+			while (true)
+			{
+				const uint64_t epoch = m_epoch.load(std::memory_order_acquire);
+				rings.clear();
+				{
+					std::lock_guard<std::mutex> lock(m_ringsMutex);
+					// rings whose threads exited and which got fully drained
+					std::erase_if(m_rings,[](const std::shared_ptr<SRing>& ring)->bool
+					{
+						return ring.use_count()==1 && ring->readOffset.load(std::memory_order_relaxed)==ring->writeOffset.load(std::memory_order_acquire);
+					});
+					rings = m_rings;
+				}
+
+				records.clear();
+				newReadOffsets.resize(rings.size());
+				uint32_t droppedCount = 0u;
+				for (size_t i=0ull; i<rings.size(); i++)
+				{
+					SRing& ring = *rings[i];
+					droppedCount += ring.droppedCount.exchange(0u,std::memory_order_relaxed);
+					const uint64_t writeOffset = ring.writeOffset.load(std::memory_order_acquire);
+					uint64_t readOffset = ring.readOffset.load(std::memory_order_relaxed);
+					while (readOffset<writeOffset)
+					{
+						const uint32_t pos = readOffset&ring.mask;
+						if (ring.byteSize()-pos<sizeof(SRecordHeader))
+						{
+							readOffset += ring.byteSize()-pos;
+							continue;
+						}
+						const auto* const header = reinterpret_cast<const SRecordHeader*>(ring.data()+pos);
+						if (header->level!=ELL_NONE)
+							records.push_back({header->timestamp,header->level,std::string_view(reinterpret_cast<const char*>(header+1),header->messageLength)});
+						readOffset += header->byteSize;
+					}
+					newReadOffsets[i] = readOffset;
+				}
+				// every thread's records are already in order
+				std::stable_sort(records.begin(),records.end(),[](const SRecordView& lhs, const SRecordView& rhs)->bool{return lhs.timestamp<rhs.timestamp;});
+
+				batch.clear();
+				for (const auto& record : records)
+					appendLogLine(batch,record.timestamp,record.level,record.message);
+				if (droppedCount)
+				{
+					using namespace std::chrono;
+					char message[96];
+					const int messageLength = snprintf(message,sizeof(message),"%u log messages were dropped because the ring buffers were full",droppedCount);
+					appendLogLine(batch,duration_cast<microseconds>(system_clock::now().time_since_epoch()).count(),ELL_WARNING,std::string_view(message,core::max(messageLength,0)));
+				}
+				// the records point into the rings, so they only get released once formatted
+				for (size_t i=0ull; i<rings.size(); i++)
+					rings[i]->readOffset.store(newReadOffsets[i],std::memory_order_release);
+
+				if (!batch.empty())
+					flush_impl(batch);
+				m_drainedEpoch.store(epoch,std::memory_order_release);
+				m_drainedEpoch.notify_all();
+
+				if (records.empty() && !droppedCount)
+				{
+					if (m_quit.load(std::memory_order_acquire))
+						break;
+					m_epoch.wait(epoch,std::memory_order_acquire);
+				}
+			}
+		}
+
+		const E_OVERFLOW_POLICY m_overflowPolicy;
+		const uint32_t m_ringByteSize;
+
+		std::mutex m_ringsMutex;
+		core::vector<std::shared_ptr<SRing>> m_rings;
+		// bumped by every message, the background thread sleeps on it
+		std::atomic<uint64_t> m_epoch = 0ull;
+		// last value of `m_epoch` whose messages all got flushed
+		std::atomic<uint64_t> m_drainedEpoch = 0ull;
+		std::atomic_bool m_quit = false;
+
+		// only used by the background thread
+		std::time_t m_cachedSeconds = -1;
+		std::tm m_cachedTime = {};
+
+		// Must be last member!
+		std::thread m_thread;
+};
+
+}
+
+#endif
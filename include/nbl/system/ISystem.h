@@ -5,6 +5,7 @@
 #include "nbl/core/declarations.h"
 #include "nbl/core/util/bitflag.h"
 
+#include <atomic>
 #include <variant>
 
 #include "nbl/system/IFileArchive.h"
@@ -66,6 +67,11 @@ class NBL_API2 ISystem : public core::IReferenceCounted
             m_loaders.vector.push_back(std::move(loader));
         }
 
+        //! Off by default. When on, opening a `.tar` with at least 1024 members writes its member list to a `.nblidx` file next to it,
+        //! so the next open can skip scanning every header. The sidecar gets ignored and rewritten when the archive's size or last write time changes.
+        inline void setTarIndexSidecarsEnabled(const bool enabled) {m_tarIndexSidecars.store(enabled,std::memory_order_relaxed);}
+        inline bool areTarIndexSidecarsEnabled() const {return m_tarIndexSidecars.load(std::memory_order_relaxed);}
+
         // `flags` is the intended usage of the file
         bool exists(const system::path& filename, const core::bitflag<IFileBase::E_CREATE_FLAGS> flags) const;
 
@@ -209,6 +215,7 @@ class NBL_API2 ISystem : public core::IReferenceCounted
         } m_loaders;
         //
         core::CMultiObjectCache<system::path,core::smart_refctd_ptr<IFileArchive>> m_cachedArchiveFiles;
+        std::atomic_bool m_tarIndexSidecars = false;
 
     private:
         struct SRequestParams_NOOP
@@ -86,6 +86,12 @@
 #include "nbl/asset/interchange/CBufferLoaderBIN.h"
 #include "nbl/asset/utils/CGeometryCreator.h"
 #include "nbl/asset/utils/CMeshManipulator.h"
+#include "nbl/system/CGrowableMemoryFile.h"
+
+#include <condition_variable>
+#include <deque>
+#include <optional>
+#include <thread>
 
 
 using namespace nbl;
@@ -131,6 +137,187 @@ IMeshManipulator* IAssetManager::getMeshManipulator()
 	return m_meshManipulator.get();
 }
 
+// Encoding is CPU bound and independent per asset, so it goes wide, while the writes are funneled into the `ISystem`'s (serial) dispatch thread
+struct IAssetManager::SAsyncWriteQueue
+{
+	struct SJob
+	{
+		SAsyncWriteRequest request;
+		std::promise<bool> promise;
+	};
+	struct SEncoded
+	{
+		system::path filename;
+		core::smart_refctd_ptr<system::CGrowableMemoryFile> file;
+		std::promise<bool> promise;
+	};
+
+	SAsyncWriteQueue(IAssetManager* _manager, const uint32_t workerCount) : manager(_manager), runningWorkers(workerCount)
+	{
+		workers.reserve(workerCount);
+		for (uint32_t i=0u; i<workerCount; i++)
+			workers.emplace_back(&SAsyncWriteQueue::encode,this);
+		flusher = std::thread(&SAsyncWriteQueue::flush,this);
+	}
+	~SAsyncWriteQueue()
+	{
+		{
+			std::unique_lock lock(mutex);
+			exiting = true;
+		}
+		jobReady.notify_all();
+		// workers drain the job queue first, then the flusher drains what they encoded
+		for (auto& worker : workers)
+			worker.join();
+		flusher.join();
+	}
+
+	inline void push(core::vector<SJob>&& newJobs)
+	{
+		{
+			std::unique_lock lock(mutex);
+			for (auto& job : newJobs)
+				jobs.push_back(std::move(job));
+		}
+		jobReady.notify_all();
+	}
+
+	void encode()
+	{
+		while (true)
+		{
+			// the write params have no default constructor
+			std::optional<SJob> pending;
+			{
+				std::unique_lock lock(mutex);
+				jobReady.wait(lock,[this]()->bool{return exiting || !jobs.empty();});
+				if (jobs.empty())
+				{
+					if (--runningWorkers==0u)
+						encodedReady.notify_one();
+					return;
+				}
+				pending.emplace(std::move(jobs.front()));
+				jobs.pop_front();
+			}
+			auto& job = *pending;
+
+			// same path as the synchronous `writeAsset` would create, writers get picked by its extension
+			auto file = core::make_smart_refctd_ptr<system::CGrowableMemoryFile>(system::path(job.request.params.workingDirectory.generic_string()+job.request.filename));
+			// an exception escaping the thread would terminate, so it's handed over to whoever waits on the future
+			try
+			{
+				if (!manager->writeAsset(file.get(),job.request.params,job.request.override))
+				{
+					job.promise.set_value(false);
+					continue;
+				}
+			}
+			catch (...)
+			{
+				job.promise.set_exception(std::current_exception());
+				continue;
+			}
+
+			const size_t size = file->getSize();
+			{
+				std::unique_lock lock(mutex);
+				budgetFreed.wait(lock,[&]()->bool{return pendingBytes==0ull || pendingBytes+size<=manager->getMaxPendingAsyncWriteBytes();});
+				pendingBytes += size;
+				auto filename = file->getFileName();
+				encoded.push_back({std::move(filename),std::move(file),std::move(job.promise)});
+			}
+			encodedReady.notify_one();
+		}
+	}
+
+	void flush()
+	{
+		while (true)
+		{
+			SEncoded item;
+			{
+				std::unique_lock lock(mutex);
+				encodedReady.wait(lock,[this]()->bool{return !encoded.empty() || runningWorkers==0u;});
+				if (encoded.empty())
+					return;
+				item = std::move(encoded.front());
+				encoded.pop_front();
+			}
+
+			const auto& data = item.file->getData();
+			try
+			{
+				bool success = false;
+				system::ISystem::future_t<core::smart_refctd_ptr<system::IFile>> future;
+				manager->m_system->createFile(future,item.filename,system::IFile::ECF_WRITE);
+				if (auto file=future.acquire())
+				if (*file)
+				{
+					system::IFile::success_t written;
+					file->get()->write(written,data.data(),0ull,data.size());
+					success = bool(written);
+				}
+				item.promise.set_value(success);
+			}
+			catch (...)
+			{
+				item.promise.set_exception(std::current_exception());
+			}
+
+			const size_t size = data.size();
+			item.file = nullptr;
+			{
+				std::unique_lock lock(mutex);
+				pendingBytes -= size;
+			}
+			budgetFreed.notify_all();
+		}
+	}
+
+	IAssetManager* const manager;
+	std::mutex mutex;
+	std::condition_variable jobReady;
+	std::condition_variable encodedReady;
+	std::condition_variable budgetFreed;
+	std::deque<SJob> jobs;
+	std::deque<SEncoded> encoded;
+	size_t pendingBytes = 0ull;
+	uint32_t runningWorkers;
+	bool exiting = false;
+	core::vector<std::thread> workers;
+	std::thread flusher;
+};
+
+core::vector<std::future<bool>> IAssetManager::writeAssetsAsync(const std::span<const SAsyncWriteRequest> requests)
+{
+	std::call_once(m_asyncWriteQueueCreated,[this]()->void
+	{
+		m_asyncWriteQueue = std::make_unique<SAsyncWriteQueue>(this,core::max(std::thread::hardware_concurrency(),1u));
+	});
+
+	core::vector<std::future<bool>> futures;
+	futures.reserve(requests.size());
+	core::vector<SAsyncWriteQueue::SJob> jobs;
+	jobs.reserve(requests.size());
+	for (const auto& request : requests)
+	{
+		auto& job = jobs.emplace_back(SAsyncWriteQueue::SJob{request,{}});
+		futures.push_back(job.promise.get_future());
+	}
+	m_asyncWriteQueue->push(std::move(jobs));
+	return futures;
+}
+
+IAssetManager::~IAssetManager()
+{
+	// outstanding writes still need the writers and the system
+	m_asyncWriteQueue = nullptr;
+	for (size_t i = 0u; i < m_assetCache.size(); ++i)
+		if (m_assetCache[i])
+			delete m_assetCache[i];
+}
+
 void IAssetManager::addLoadersAndWriters()
 {
 #ifdef _NBL_COMPILE_WITH_STL_LOADER_
@@ -50,6 +50,8 @@ core::smart_refctd_ptr<IAsset> ICPUDescriptorSet::clone(uint32_t _depth) const
 	for (uint32_t t = 0u; t < static_cast<uint32_t>(IDescriptor::E_TYPE::ET_COUNT); ++t)
 	{
 		const auto type = static_cast<IDescriptor::E_TYPE>(t);
+		if (!m_descriptorInfos[t])
+			continue;
 
 		for (uint32_t i = 0u; i < m_descriptorInfos[t]->size(); ++i)
 		{
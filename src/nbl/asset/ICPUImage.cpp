@@ -156,30 +156,28 @@ public:
 		if (!isFullyFlatten) // TODO: we may think of even better optimization if we have mixed regions for mips (eg. a few flattened, some others not and left empty)
 		{
 			// create own regions & hook tight buffer with no gaps from scratch
-			auto regions = core::make_refctd_dynamic_array<core::smart_refctd_dynamic_array<IImage::SBufferCopy>>(parameters.mipLevels);
+			size_t bufferSize = 0ull;
+			auto regions = core::make_refctd_dynamic_array_from_generator<core::smart_refctd_dynamic_array<IImage::SBufferCopy>>(parameters.mipLevels,[&](const size_t _miplevel) -> IImage::SBufferCopy
 			{
-				size_t bufferSize = 0ull;
-
-				for (auto rit = regions->begin(); rit != regions->end(); rit++)
-				{
-					auto miplevel = static_cast<uint32_t>(std::distance(regions->begin(), rit));
-					auto localExtent = state->inImage->getMipSize(miplevel);
-					rit->bufferOffset = bufferSize;
-					rit->bufferRowLength = localExtent.x; // could round up to multiple of 8 bytes in the future
-					rit->bufferImageHeight = localExtent.y;
-					rit->imageSubresource.aspectMask = IImage::E_ASPECT_FLAGS::EAF_COLOR_BIT; // otherwise won't pass validaiton 
-					rit->imageSubresource.mipLevel = miplevel;
-					rit->imageSubresource.baseArrayLayer = 0u;
-					rit->imageSubresource.layerCount = parameters.arrayLayers;
-					rit->imageOffset = { 0u,0u,0u };
-					rit->imageExtent = { localExtent.x,localExtent.y,localExtent.z };
-					auto levelSize = info.roundToBlockSize(localExtent);
-					auto memsize = levelSize[0] * levelSize[1] * levelSize[2] * parameters.arrayLayers * bytesPerPixel;
-
-					assert(memsize.getNumerator() % memsize.getDenominator() == 0u);
-					bufferSize += memsize.getIntegerApprox();
-				}
-			}
+				const auto miplevel = static_cast<uint32_t>(_miplevel);
+				const auto localExtent = state->inImage->getMipSize(miplevel);
+				IImage::SBufferCopy region = {};
+				region.bufferOffset = bufferSize;
+				region.bufferRowLength = localExtent.x; // could round up to multiple of 8 bytes in the future
+				region.bufferImageHeight = localExtent.y;
+				region.imageSubresource.aspectMask = IImage::E_ASPECT_FLAGS::EAF_COLOR_BIT; // otherwise won't pass validaiton 
+				region.imageSubresource.mipLevel = miplevel;
+				region.imageSubresource.baseArrayLayer = 0u;
+				region.imageSubresource.layerCount = parameters.arrayLayers;
+				region.imageOffset = { 0u,0u,0u };
+				region.imageExtent = { localExtent.x,localExtent.y,localExtent.z };
+				auto levelSize = info.roundToBlockSize(localExtent);
+				auto memsize = levelSize[0] * levelSize[1] * levelSize[2] * parameters.arrayLayers * bytesPerPixel;
+
+				assert(memsize.getNumerator() % memsize.getDenominator() == 0u);
+				bufferSize += memsize.getIntegerApprox();
+				return region;
+			});
 
 			auto out = ICPUImage::create(IImage::SCreationParams(parameters));
 			out->setBufferAndRegions(core::smart_refctd_ptr(getScratchAsBuffer(scratch.flatten.size, scratch.flatten.offset)), std::move(regions));
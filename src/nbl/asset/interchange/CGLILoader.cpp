@@ -39,11 +39,574 @@ namespace nbl
 		static inline void assignGLIDataToRegion(void* regionData, const gli::texture& texture, const uint16_t layer, const uint16_t face, const uint16_t level, const uint64_t sizeOfData);
 		static inline bool performLoadingAsIFile(gli::texture& texture, system::IFile* file, const system::logger_opt_ptr logger);
 
+		// Native DDS and KTX2 parsing, the regions get laid out straight over the file's texel data so it needs no rearranging
+		namespace
+		{
+			//! Adopts a range of a file's mapping, the file stays open for as long as the buffer lives
+			class CFileMappedCPUBuffer final : public ICPUBuffer
+			{
+				public:
+					CFileMappedCPUBuffer(core::smart_refctd_ptr<system::IFile>&& file, const size_t offset, const size_t size)
+						: ICPUBuffer(size,const_cast<uint8_t*>(reinterpret_cast<const uint8_t*>(static_cast<const system::IFile*>(file.get())->getMappedPointer()))+offset), m_file(std::move(file)) {}
+
+				protected:
+					~CFileMappedCPUBuffer()
+					{
+						freeData();
+					}
+
+					inline void freeData() override
+					{
+						ICPUBuffer::data = nullptr;
+						ICPUBuffer::m_creationParams.size = 0ull;
+						m_file = nullptr;
+					}
+
+					core::smart_refctd_ptr<system::IFile> m_file;
+			};
+
+			struct SNativeImageLayout
+			{
+				ICPUImage::SCreationParams params = {};
+				ICPUImageView::E_TYPE viewType = ICPUImageView::ET_COUNT;
+				// formats without a native equivalent (luminance, alpha only, no alpha) get stored in one with the channels remapped
+				ICPUImageView::SComponentMapping components = {};
+				// `bufferOffset`s are file offsets until the buffer gets made
+				core::vector<ICPUImage::SBufferCopy> regions;
+				// byte range of the file covering all the regions
+				uint64_t dataOffset = ~0ull;
+				uint64_t dataEnd = 0ull;
+
+				inline void addRegion(const uint32_t mipLevel, const uint32_t baseArrayLayer, const uint32_t layerCount, const uint64_t fileOffset, const uint64_t byteSize)
+				{
+					auto& region = regions.emplace_back();
+					region.bufferOffset = fileOffset;
+					region.bufferRowLength = 0u;
+					region.bufferImageHeight = 0u;
+					region.imageSubresource.aspectMask = IImage::E_ASPECT_FLAGS::EAF_COLOR_BIT;
+					region.imageSubresource.mipLevel = mipLevel;
+					region.imageSubresource.baseArrayLayer = baseArrayLayer;
+					region.imageSubresource.layerCount = layerCount;
+					region.imageOffset = {0u,0u,0u};
+					region.imageExtent.width = core::max(params.extent.width>>mipLevel,1u);
+					region.imageExtent.height = core::max(params.extent.height>>mipLevel,1u);
+					region.imageExtent.depth = core::max(params.extent.depth>>mipLevel,1u);
+					dataOffset = core::min(dataOffset,fileOffset);
+					dataEnd = core::max(dataEnd,fileOffset+byteSize);
+				}
+			};
+
+			//! tightly packed, like both DDS and KTX2 store them
+			static inline uint64_t getMipByteSize(const E_FORMAT format, const VkExtent3D& extent, const uint32_t mipLevel)
+			{
+				const auto blockDims = getBlockDimensions(format);
+				const uint64_t blocksX = (core::max(extent.width>>mipLevel,1u)+blockDims.x-1u)/blockDims.x;
+				const uint64_t blocksY = (core::max(extent.height>>mipLevel,1u)+blockDims.y-1u)/blockDims.y;
+				const uint64_t blocksZ = (core::max(extent.depth>>mipLevel,1u)+blockDims.z-1u)/blockDims.z;
+				return blocksX*blocksY*blocksZ*getTexelOrBlockBytesize(format);
+			}
+
+			static inline IImage::E_TYPE getImageType(const ICPUImageView::E_TYPE viewType)
+			{
+				switch (viewType)
+				{
+					case ICPUImageView::ET_1D:
+					case ICPUImageView::ET_1D_ARRAY:
+						return IImage::ET_1D;
+					case ICPUImageView::ET_3D:
+						return IImage::ET_3D;
+					default:
+						break;
+				}
+				return IImage::ET_2D;
+			}
+
+			// Vulkan's format enum is E_FORMAT's order, except for where the depth formats and ETC2/EAC are
+			static inline E_FORMAT getFormatFromVkFormat(const uint32_t vkFormat)
+			{
+				static_assert(EF_E5B9G9R9_UFLOAT_PACK32-EF_R4G4_UNORM_PACK8==122 && EF_D32_SFLOAT_S8_UINT-EF_D16_UNORM==6);
+				static_assert(EF_BC7_SRGB_BLOCK-EF_BC1_RGB_UNORM_BLOCK==15 && EF_EAC_R11G11_SNORM_BLOCK-EF_ETC2_R8G8B8_UNORM_BLOCK==9 && EF_ASTC_12x12_SRGB_BLOCK-EF_ASTC_4x4_UNORM_BLOCK==27);
+				static_assert(EF_PVRTC2_4BPP_SRGB_BLOCK_IMG-EF_PVRTC1_2BPP_UNORM_BLOCK_IMG==7);
+				if (vkFormat>=1u && vkFormat<=123u) // VK_FORMAT_R4G4_UNORM_PACK8 to VK_FORMAT_E5B9G9R9_UFLOAT_PACK32
+					return static_cast<E_FORMAT>(EF_R4G4_UNORM_PACK8+vkFormat-1u);
+				if (vkFormat>=124u && vkFormat<=130u) // VK_FORMAT_D16_UNORM to VK_FORMAT_D32_SFLOAT_S8_UINT
+					return static_cast<E_FORMAT>(EF_D16_UNORM+vkFormat-124u);
+				if (vkFormat>=131u && vkFormat<=146u) // VK_FORMAT_BC1_RGB_UNORM_BLOCK to VK_FORMAT_BC7_SRGB_BLOCK
+					return static_cast<E_FORMAT>(EF_BC1_RGB_UNORM_BLOCK+vkFormat-131u);
+				if (vkFormat>=147u && vkFormat<=156u) // VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK to VK_FORMAT_EAC_R11G11_SNORM_BLOCK
+					return static_cast<E_FORMAT>(EF_ETC2_R8G8B8_UNORM_BLOCK+vkFormat-147u);
+				if (vkFormat>=157u && vkFormat<=184u) // VK_FORMAT_ASTC_4x4_UNORM_BLOCK to VK_FORMAT_ASTC_12x12_SRGB_BLOCK
+					return static_cast<E_FORMAT>(EF_ASTC_4x4_UNORM_BLOCK+vkFormat-157u);
+				if (vkFormat>=1000054000u && vkFormat<=1000054007u) // VK_IMG_format_pvrtc
+					return static_cast<E_FORMAT>(EF_PVRTC1_2BPP_UNORM_BLOCK_IMG+vkFormat-1000054000u);
+				return EF_UNKNOWN;
+			}
+
+			static inline E_FORMAT getFormatFromDXGIFormat(const uint32_t dxgiFormat, ICPUImageView::SComponentMapping& components)
+			{
+				switch (dxgiFormat)
+				{
+					case 2u: return EF_R32G32B32A32_SFLOAT;
+					case 3u: return EF_R32G32B32A32_UINT;
+					case 4u: return EF_R32G32B32A32_SINT;
+					case 6u: return EF_R32G32B32_SFLOAT;
+					case 7u: return EF_R32G32B32_UINT;
+					case 8u: return EF_R32G32B32_SINT;
+					case 10u: return EF_R16G16B16A16_SFLOAT;
+					case 11u: return EF_R16G16B16A16_UNORM;
+					case 12u: return EF_R16G16B16A16_UINT;
+					case 13u: return EF_R16G16B16A16_SNORM;
+					case 14u: return EF_R16G16B16A16_SINT;
+					case 16u: return EF_R32G32_SFLOAT;
+					case 17u: return EF_R32G32_UINT;
+					case 18u: return EF_R32G32_SINT;
+					case 24u: return EF_A2B10G10R10_UNORM_PACK32;
+					case 25u: return EF_A2B10G10R10_UINT_PACK32;
+					case 26u: return EF_B10G11R11_UFLOAT_PACK32;
+					case 28u: return EF_R8G8B8A8_UNORM;
+					case 29u: return EF_R8G8B8A8_SRGB;
+					case 30u: return EF_R8G8B8A8_UINT;
+					case 31u: return EF_R8G8B8A8_SNORM;
+					case 32u: return EF_R8G8B8A8_SINT;
+					case 34u: return EF_R16G16_SFLOAT;
+					case 35u: return EF_R16G16_UNORM;
+					case 36u: return EF_R16G16_UINT;
+					case 37u: return EF_R16G16_SNORM;
+					case 38u: return EF_R16G16_SINT;
+					case 40u: return EF_D32_SFLOAT;
+					case 41u: return EF_R32_SFLOAT;
+					case 42u: return EF_R32_UINT;
+					case 43u: return EF_R32_SINT;
+					case 45u: return EF_D24_UNORM_S8_UINT;
+					case 49u: return EF_R8G8_UNORM;
+					case 50u: return EF_R8G8_UINT;
+					case 51u: return EF_R8G8_SNORM;
+					case 52u: return EF_R8G8_SINT;
+					case 54u: return EF_R16_SFLOAT;
+					case 55u: return EF_D16_UNORM;
+					case 56u: return EF_R16_UNORM;
+					case 57u: return EF_R16_UINT;
+					case 58u: return EF_R16_SNORM;
+					case 59u: return EF_R16_SINT;
+					case 61u: return EF_R8_UNORM;
+					case 62u: return EF_R8_UINT;
+					case 63u: return EF_R8_SNORM;
+					case 64u: return EF_R8_SINT;
+					case 65u: // A8_UNORM
+						components = {ICPUImageView::SComponentMapping::ES_ZERO,ICPUImageView::SComponentMapping::ES_ZERO,ICPUImageView::SComponentMapping::ES_ZERO,ICPUImageView::SComponentMapping::ES_R};
+						return EF_R8_UNORM;
+					case 67u: return EF_E5B9G9R9_UFLOAT_PACK32;
+					case 71u: return EF_BC1_RGBA_UNORM_BLOCK;
+					case 72u: return EF_BC1_RGBA_SRGB_BLOCK;
+					case 74u: return EF_BC2_UNORM_BLOCK;
+					case 75u: return EF_BC2_SRGB_BLOCK;
+					case 77u: return EF_BC3_UNORM_BLOCK;
+					case 78u: return EF_BC3_SRGB_BLOCK;
+					case 80u: return EF_BC4_UNORM_BLOCK;
+					case 81u: return EF_BC4_SNORM_BLOCK;
+					case 83u: return EF_BC5_UNORM_BLOCK;
+					case 84u: return EF_BC5_SNORM_BLOCK;
+					case 85u: return EF_R5G6B5_UNORM_PACK16;
+					case 86u: return EF_A1R5G5B5_UNORM_PACK16;
+					case 87u: return EF_B8G8R8A8_UNORM;
+					case 91u: return EF_B8G8R8A8_SRGB;
+					case 95u: return EF_BC6H_UFLOAT_BLOCK;
+					case 96u: return EF_BC6H_SFLOAT_BLOCK;
+					case 98u: return EF_BC7_UNORM_BLOCK;
+					case 99u: return EF_BC7_SRGB_BLOCK;
+					default:
+						break;
+				}
+				return EF_UNKNOWN;
+			}
+
+			constexpr uint32_t makeFourCC(const char a, const char b, const char c, const char d)
+			{
+				return uint32_t(uint8_t(a))|(uint32_t(uint8_t(b))<<8u)|(uint32_t(uint8_t(c))<<16u)|(uint32_t(uint8_t(d))<<24u);
+			}
+
+			constexpr uint32_t DDSMagic = makeFourCC('D','D','S',' ');
+			constexpr std::array<uint8_t,12> KTX2Identifier = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+
+			struct SDDSPixelFormat
+			{
+				uint32_t size;
+				uint32_t flags;
+				uint32_t fourCC;
+				uint32_t rgbBitCount;
+				uint32_t rBitMask;
+				uint32_t gBitMask;
+				uint32_t bBitMask;
+				uint32_t aBitMask;
+			};
+			struct SDDSHeader
+			{
+				uint32_t size;
+				uint32_t flags;
+				uint32_t height;
+				uint32_t width;
+				uint32_t pitchOrLinearSize;
+				uint32_t depth;
+				uint32_t mipMapCount;
+				uint32_t reserved1[11];
+				SDDSPixelFormat pixelFormat;
+				uint32_t caps;
+				uint32_t caps2;
+				uint32_t caps3;
+				uint32_t caps4;
+				uint32_t reserved2;
+			};
+			static_assert(sizeof(SDDSHeader)==124u);
+			struct SDDSHeaderDX10
+			{
+				uint32_t dxgiFormat;
+				uint32_t resourceDimension;
+				uint32_t miscFlag;
+				uint32_t arraySize;
+				uint32_t miscFlags2;
+			};
+
+			struct SKTX2Header
+			{
+				uint8_t identifier[12];
+				uint32_t vkFormat;
+				uint32_t typeSize;
+				uint32_t pixelWidth;
+				uint32_t pixelHeight;
+				uint32_t pixelDepth;
+				uint32_t layerCount;
+				uint32_t faceCount;
+				uint32_t levelCount;
+				uint32_t supercompressionScheme;
+				uint32_t dfdByteOffset;
+				uint32_t dfdByteLength;
+				uint32_t kvdByteOffset;
+				uint32_t kvdByteLength;
+				uint64_t sgdByteOffset;
+				uint64_t sgdByteLength;
+			};
+			static_assert(sizeof(SKTX2Header)==80u);
+			struct SKTX2Level
+			{
+				uint64_t byteOffset;
+				uint64_t byteLength;
+				uint64_t uncompressedByteLength;
+			};
+
+			template<typename T>
+			static inline bool readStruct(system::IFile* file, const size_t offset, T* out, const size_t count=1ull)
+			{
+				system::IFile::success_t success;
+				file->read(success,out,offset,sizeof(T)*count);
+				return bool(success);
+			}
+
+			//! same channel mappings as GLI gives these formats
+			static inline E_FORMAT getFormatFromLegacyDDSPixelFormat(const SDDSPixelFormat& pf, ICPUImageView::SComponentMapping& components)
+			{
+				constexpr uint32_t DDPF_ALPHAPIXELS = 0x1u;
+				constexpr uint32_t DDPF_ALPHA = 0x2u;
+				constexpr uint32_t DDPF_FOURCC = 0x4u;
+				constexpr uint32_t DDPF_RGB = 0x40u;
+				constexpr uint32_t DDPF_LUMINANCE = 0x20000u;
+				using swizzle_t = ICPUImageView::SComponentMapping;
+				if (pf.flags&DDPF_FOURCC)
+				{
+					switch (pf.fourCC)
+					{
+						case makeFourCC('D','X','T','1'): return EF_BC1_RGBA_UNORM_BLOCK;
+						case makeFourCC('D','X','T','2'): [[fallthrough]];
+						case makeFourCC('D','X','T','3'): return EF_BC2_UNORM_BLOCK;
+						case makeFourCC('D','X','T','4'): [[fallthrough]];
+						case makeFourCC('D','X','T','5'): return EF_BC3_UNORM_BLOCK;
+						case makeFourCC('A','T','I','1'): [[fallthrough]];
+						case makeFourCC('B','C','4','U'): return EF_BC4_UNORM_BLOCK;
+						case makeFourCC('B','C','4','S'): return EF_BC4_SNORM_BLOCK;
+						case makeFourCC('A','T','I','2'): [[fallthrough]];
+						case makeFourCC('B','C','5','U'): return EF_BC5_UNORM_BLOCK;
+						case makeFourCC('B','C','5','S'): return EF_BC5_SNORM_BLOCK;
+						// D3DFMT values
+						case 36u: return EF_R16G16B16A16_UNORM;
+						case 110u: return EF_R16G16B16A16_SNORM;
+						case 111u: return EF_R16_SFLOAT;
+						case 112u: return EF_R16G16_SFLOAT;
+						case 113u: return EF_R16G16B16A16_SFLOAT;
+						case 114u: return EF_R32_SFLOAT;
+						case 115u: return EF_R32G32_SFLOAT;
+						case 116u: return EF_R32G32B32A32_SFLOAT;
+						default:
+							break;
+					}
+				}
+				else if (pf.flags&DDPF_RGB)
+				{
+					// X8R8G8B8 and X8B8G8R8 leave the fourth byte undefined
+					if (pf.rgbBitCount==32u && !((pf.flags&DDPF_ALPHAPIXELS) && pf.aBitMask))
+						components.a = swizzle_t::ES_ONE;
+					if (pf.rgbBitCount==32u && pf.rBitMask==0x00ff0000u && pf.gBitMask==0x0000ff00u && pf.bBitMask==0x000000ffu)
+						return EF_B8G8R8A8_UNORM;
+					if (pf.rgbBitCount==32u && pf.rBitMask==0x000000ffu && pf.gBitMask==0x0000ff00u && pf.bBitMask==0x00ff0000u)
+						return EF_R8G8B8A8_UNORM;
+					if (pf.rgbBitCount==24u && pf.rBitMask==0xff0000u && pf.gBitMask==0x00ff00u && pf.bBitMask==0x0000ffu)
+						return EF_B8G8R8_UNORM;
+					if (pf.rgbBitCount==16u && pf.rBitMask==0xf800u && pf.gBitMask==0x07e0u && pf.bBitMask==0x001fu)
+						return EF_R5G6B5_UNORM_PACK16;
+				}
+				else if (pf.flags&DDPF_LUMINANCE)
+				{
+					if (pf.flags&DDPF_ALPHAPIXELS)
+					{
+						components = {swizzle_t::ES_R,swizzle_t::ES_R,swizzle_t::ES_R,swizzle_t::ES_G};
+						if (pf.rgbBitCount==16u && pf.rBitMask==0x00ffu && pf.aBitMask==0xff00u)
+							return EF_R8G8_UNORM;
+						if (pf.rgbBitCount==32u && pf.rBitMask==0x0000ffffu && pf.aBitMask==0xffff0000u)
+							return EF_R16G16_UNORM;
+					}
+					else
+					{
+						components = {swizzle_t::ES_R,swizzle_t::ES_R,swizzle_t::ES_R,swizzle_t::ES_ONE};
+						if (pf.rgbBitCount==8u && pf.rBitMask==0xffu)
+							return EF_R8_UNORM;
+						if (pf.rgbBitCount==16u && pf.rBitMask==0xffffu)
+							return EF_R16_UNORM;
+					}
+				}
+				else if (pf.flags&DDPF_ALPHA)
+				{
+					components = {swizzle_t::ES_ZERO,swizzle_t::ES_ZERO,swizzle_t::ES_ZERO,swizzle_t::ES_R};
+					if (pf.rgbBitCount==8u && pf.aBitMask==0xffu)
+						return EF_R8_UNORM;
+				}
+				return EF_UNKNOWN;
+			}
+
+			//! false means it's for GLI to try, DDS stores every array layer's whole mip chain one after the other, only `[baseMipLevel,mipMapCount)` get laid out
+			static inline bool parseDDS(system::IFile* file, const uint32_t baseMipLevel, SNativeImageLayout& layout)
+			{
+				uint32_t magic;
+				SDDSHeader header;
+				if (!readStruct(file,0ull,&magic) || magic!=DDSMagic || !readStruct(file,sizeof(magic),&header) || header.size!=sizeof(SDDSHeader))
+					return false;
+
+				constexpr uint32_t DDSD_MIPMAPCOUNT = 0x20000u;
+				constexpr uint32_t DDSD_DEPTH = 0x800000u;
+				constexpr uint32_t DDSCAPS2_CUBEMAP = 0x200u;
+				constexpr uint32_t DDSCAPS2_CUBEMAP_ALLFACES = 0xfc00u;
+				constexpr uint32_t DDSCAPS2_VOLUME = 0x200000u;
+
+				uint64_t dataOffset = sizeof(magic)+sizeof(SDDSHeader);
+				E_FORMAT format;
+				uint32_t layerCount = 1u;
+				bool cube = false;
+				bool volume = false;
+				bool oneDimensional = false;
+				bool array = false;
+				if ((header.pixelFormat.flags&0x4u) && header.pixelFormat.fourCC==makeFourCC('D','X','1','0'))
+				{
+					SDDSHeaderDX10 dx10;
+					if (!readStruct(file,dataOffset,&dx10))
+						return false;
+					dataOffset += sizeof(SDDSHeaderDX10);
+					format = getFormatFromDXGIFormat(dx10.dxgiFormat,layout.components);
+					oneDimensional = dx10.resourceDimension==2u;
+					volume = dx10.resourceDimension==4u;
+					cube = dx10.miscFlag&0x4u;
+					layerCount = core::max(dx10.arraySize,1u);
+					array = dx10.arraySize>1u;
+				}
+				else
+				{
+					format = getFormatFromLegacyDDSPixelFormat(header.pixelFormat,layout.components);
+					volume = (header.caps2&DDSCAPS2_VOLUME) && (header.flags&DDSD_DEPTH);
+					cube = header.caps2&DDSCAPS2_CUBEMAP;
+					// GLI deals with the partial cubemaps
+					if (cube && (header.caps2&DDSCAPS2_CUBEMAP_ALLFACES)!=DDSCAPS2_CUBEMAP_ALLFACES)
+						return false;
+				}
+				if (format==EF_UNKNOWN || isPlanarFormat(format))
+					return false;
+
+				const VkExtent3D fullExtent = {core::max(header.width,1u),oneDimensional ? 1u:core::max(header.height,1u),volume ? core::max(header.depth,1u):1u};
+				// writers are allowed to leave `mipMapCount` as garbage when the flag isn't set, and it can't exceed the length of a full chain
+				const uint32_t fullChainLength = hlsl::findMSB(core::max(core::max(fullExtent.width,fullExtent.height),fullExtent.depth))+1u;
+				const uint32_t mipMapCount = (header.flags&DDSD_MIPMAPCOUNT) ? core::min(core::max(header.mipMapCount,1u),fullChainLength):1u;
+				if (baseMipLevel>=mipMapCount)
+					return false;
+
+				auto& params = layout.params;
+				params.format = format;
+				params.extent = {core::max(fullExtent.width>>baseMipLevel,1u),core::max(fullExtent.height>>baseMipLevel,1u),core::max(fullExtent.depth>>baseMipLevel,1u)};
+				params.mipLevels = mipMapCount-baseMipLevel;
+				params.arrayLayers = layerCount*(cube ? 6u:1u);
+				if (cube)
+					layout.viewType = array ? ICPUImageView::ET_CUBE_MAP_ARRAY:ICPUImageView::ET_CUBE_MAP;
+				else if (volume)
+					layout.viewType = ICPUImageView::ET_3D;
+				else if (oneDimensional)
+					layout.viewType = array ? ICPUImageView::ET_1D_ARRAY:ICPUImageView::ET_1D;
+				else
+					layout.viewType = array ? ICPUImageView::ET_2D_ARRAY:ICPUImageView::ET_2D;
+
+				for (uint32_t layer=0u; layer<params.arrayLayers; layer++)
+				for (uint32_t mipLevel=0u; mipLevel<mipMapCount; mipLevel++)
+				{
+					const uint64_t byteSize = getMipByteSize(format,fullExtent,mipLevel);
+					if (mipLevel>=baseMipLevel)
+						layout.addRegion(mipLevel-baseMipLevel,layer,1u,dataOffset,byteSize);
+					dataOffset += byteSize;
+				}
+				return dataOffset<=file->getSize();
+			}
+
+			//! KTX2 keeps all layers and faces of a mip level together and the smallest mips first, only `[baseMipLevel,levelCount)` get laid out
+			static inline bool parseKTX2(system::IFile* file, const uint32_t baseMipLevel, SNativeImageLayout& layout, const system::logger_opt_ptr logger)
+			{
+				SKTX2Header header;
+				if (!readStruct(file,0ull,&header) || memcmp(header.identifier,KTX2Identifier.data(),KTX2Identifier.size())!=0)
+					return false;
+				if (header.supercompressionScheme!=0u)
+				{
+					logger.log("LOAD GLI: Supercompressed KTX2 files (scheme %d) are not supported!", system::ILogger::ELL_ERROR, header.supercompressionScheme);
+					return false;
+				}
+				const E_FORMAT format = getFormatFromVkFormat(header.vkFormat);
+				if (format==EF_UNKNOWN || isPlanarFormat(format))
+				{
+					logger.log("LOAD GLI: Unsupported KTX2 VkFormat %d!", system::ILogger::ELL_ERROR, header.vkFormat);
+					return false;
+				}
+
+				// 0 levels means the mip chain is to be generated, there's still one level in the file
+				const uint32_t levelCount = core::max(header.levelCount,1u);
+				if (baseMipLevel>=levelCount)
+					return false;
+				core::vector<SKTX2Level> levels(levelCount);
+				if (!readStruct(file,sizeof(SKTX2Header),levels.data(),levels.size()))
+					return false;
+
+				const bool cube = header.faceCount==6u;
+				const bool array = header.layerCount!=0u;
+				auto& params = layout.params;
+				params.format = format;
+				params.extent = {
+					core::max(header.pixelWidth>>baseMipLevel,1u),
+					header.pixelHeight ? core::max(header.pixelHeight>>baseMipLevel,1u):1u,
+					header.pixelDepth ? core::max(header.pixelDepth>>baseMipLevel,1u):1u
+				};
+				params.mipLevels = levelCount-baseMipLevel;
+				params.arrayLayers = core::max(header.layerCount,1u)*(cube ? 6u:1u);
+				if (cube)
+					layout.viewType = array ? ICPUImageView::ET_CUBE_MAP_ARRAY:ICPUImageView::ET_CUBE_MAP;
+				else if (header.pixelDepth)
+					layout.viewType = ICPUImageView::ET_3D;
+				else if (!header.pixelHeight)
+					layout.viewType = array ? ICPUImageView::ET_1D_ARRAY:ICPUImageView::ET_1D;
+				else
+					layout.viewType = array ? ICPUImageView::ET_2D_ARRAY:ICPUImageView::ET_2D;
+
+				for (uint32_t mipLevel=0u; mipLevel<params.mipLevels; mipLevel++)
+				{
+					const auto& level = levels[baseMipLevel+mipLevel];
+					if (level.byteLength<getMipByteSize(format,params.extent,mipLevel)*params.arrayLayers || level.byteOffset+level.byteLength>file->getSize())
+						return false;
+					layout.addRegion(mipLevel,0u,params.arrayLayers,level.byteOffset,level.byteLength);
+				}
+				return true;
+			}
+
+			static inline core::smart_refctd_ptr<ICPUImageView> createImageViewFromLayout(system::IFile* file, SNativeImageLayout&& layout, const bool allowMappingReferences)
+			{
+				auto& params = layout.params;
+				params.type = getImageType(layout.viewType);
+				params.samples = ICPUImage::E_SAMPLE_COUNT_FLAGS::ESCF_1_BIT;
+				params.flags = (layout.viewType==ICPUImageView::ET_CUBE_MAP || layout.viewType==ICPUImageView::ET_CUBE_MAP_ARRAY) ? ICPUImage::E_CREATE_FLAGS::ECF_CUBE_COMPATIBLE_BIT:static_cast<ICPUImage::E_CREATE_FLAGS>(0u);
+				params.usage = IImage::EUF_SAMPLED_BIT;
+
+				const uint64_t dataSize = layout.dataEnd-layout.dataOffset;
+				core::smart_refctd_ptr<ICPUBuffer> texelBuffer;
+				const auto* const mapping = static_cast<const system::IFile*>(file)->getMappedPointer();
+				if (allowMappingReferences && mapping)
+				{
+					// regions have to start at texel block aligned addresses, the mapping itself is page aligned
+					const uint32_t alignment = getTexelOrBlockBytesize(params.format);
+					const bool aligned = std::all_of(layout.regions.begin(),layout.regions.end(),[alignment](const ICPUImage::SBufferCopy& region)->bool{return region.bufferOffset%alignment==0ull;});
+					if (aligned)
+						texelBuffer = core::make_smart_refctd_ptr<CFileMappedCPUBuffer>(core::smart_refctd_ptr<system::IFile>(file),layout.dataOffset,dataSize);
+				}
+				if (!texelBuffer)
+				{
+					// one read (or copy out of the mapping) straight into the final buffer
+					texelBuffer = core::make_smart_refctd_ptr<ICPUBuffer>(dataSize);
+					system::IFile::success_t success;
+					file->read(success,texelBuffer->getPointer(),layout.dataOffset,dataSize);
+					if (!success)
+						return nullptr;
+				}
+
+				auto regions = core::make_refctd_dynamic_array<core::smart_refctd_dynamic_array<ICPUImage::SBufferCopy>>(layout.regions.size());
+				std::transform(layout.regions.begin(),layout.regions.end(),regions->begin(),[&layout](ICPUImage::SBufferCopy region)->ICPUImage::SBufferCopy
+				{
+					region.bufferOffset -= layout.dataOffset;
+					return region;
+				});
+
+				auto image = ICPUImage::create(params);
+				if (!image || !image->setBufferAndRegions(std::move(texelBuffer),regions))
+					return nullptr;
+				image->setContentHash(image->computeContentHash());
+
+				ICPUImageView::SCreationParams imageViewInfo = {};
+				imageViewInfo.image = std::move(image);
+				imageViewInfo.format = params.format;
+				imageViewInfo.viewType = layout.viewType;
+				imageViewInfo.components = layout.components;
+				imageViewInfo.flags = static_cast<ICPUImageView::E_CREATE_FLAGS>(0u);
+				imageViewInfo.subresourceRange.aspectMask = IImage::E_ASPECT_FLAGS::EAF_COLOR_BIT;
+				imageViewInfo.subresourceRange.baseArrayLayer = 0u;
+				imageViewInfo.subresourceRange.baseMipLevel = 0u;
+				imageViewInfo.subresourceRange.layerCount = params.arrayLayers;
+				imageViewInfo.subresourceRange.levelCount = params.mipLevels;
+				return ICPUImageView::create(std::move(imageViewInfo));
+			}
+
+			static inline bool isKTX2(system::IFile* file)
+			{
+				std::remove_const_t<decltype(KTX2Identifier)> identifier;
+				return readStruct(file,0ull,identifier.data(),identifier.size()) && identifier==KTX2Identifier;
+			}
+		}
+
+		core::smart_refctd_ptr<ICPUImageView> CGLILoader::loadKTX2MipTail(system::IFile* file, const uint32_t baseMipLevel, const bool allowMappingReferences, const system::logger_opt_ptr logger)
+		{
+			SNativeImageLayout layout;
+			if (!file || !parseKTX2(file,baseMipLevel,layout,logger))
+				return nullptr;
+			return createImageViewFromLayout(file,std::move(layout),allowMappingReferences);
+		}
+
 		asset::SAssetBundle CGLILoader::loadAsset(system::IFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override, uint32_t _hierarchyLevel)
 		{
 			if (!_file)
 				return {};
 
+			// DDS and KTX2 get their regions laid out over the file's own texel data, GLI can't do KTX2 at all
+			const bool allowMappingReferences = _params.loaderFlags&IAssetLoader::ELPF_ALLOW_FILE_MAPPING_REFERENCES;
+			if (isKTX2(_file))
+			{
+				if (auto imageView=loadKTX2MipTail(_file,_params.baseMipLevel,allowMappingReferences,_params.logger))
+					return SAssetBundle(nullptr,{std::move(imageView)});
+				_params.logger.log("LOADING GLI: failed to load the file %s", system::ILogger::ELL_ERROR, _file->getFileName().string().c_str());
+				return {};
+			}
+			{
+				SNativeImageLayout layout;
+				if (parseDDS(_file,_params.baseMipLevel,layout))
+				if (auto imageView=createImageViewFromLayout(_file,std::move(layout),allowMappingReferences))
+					return SAssetBundle(nullptr,{std::move(imageView)});
+			}
+			if (_params.baseMipLevel)
+				_params.logger.log("LOADING GLI: %s can't start at mip level %u, loading the whole chain", system::ILogger::ELL_WARNING, _file->getFileName().string().c_str(), _params.baseMipLevel);
+
 			gli::texture texture;
 			
 
@@ -268,7 +831,14 @@ namespace nbl
 
 			// TODO: try to read the headers regardless of extension
 			system::IFile::success_t success;
-			if (fileName.rfind(".dds") != std::string::npos)
+			if (fileName.rfind(".ktx2") != std::string::npos)
+			{
+				if (isKTX2(_file))
+					return true;
+				else
+					logger.log("LOAD GLI: Invalid (non-KTX2) file!", system::ILogger::ELL_ERROR);
+			}
+			else if (fileName.rfind(".dds") != std::string::npos)
 			{
 				std::remove_const<decltype(ddsMagic)>::type tmpBuffer;
 				_file->read(success, &tmpBuffer, 0, sizeof(ddsMagic));
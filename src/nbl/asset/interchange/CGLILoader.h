@@ -17,7 +17,10 @@ namespace nbl
 namespace asset
 {
 
-//! Texture loader capable of loading in .ktx, .dds and .kmg file extensions
+//! Texture loader capable of loading in .ktx, .ktx2, .dds and .kmg file extensions
+/** KTX2 and most DDS files get parsed natively, with the image regions pointing straight at the texel data as it's stored in the file,
+* which with `ELPF_ALLOW_FILE_MAPPING_REFERENCES` and a mapped file means no copy at all. The rest goes through GLI.
+*/
 class CGLILoader final : public asset::IAssetLoader
 {
 	protected:
@@ -30,7 +33,7 @@ class CGLILoader final : public asset::IAssetLoader
 
 		const char** getAssociatedFileExtensions() const override
 		{
-			static const char* extensions[]{ "ktx", "dds", "kmg", nullptr };
+			static const char* extensions[]{ "ktx", "ktx2", "dds", "kmg", nullptr };
 			return extensions;
 		}
 
@@ -38,6 +41,10 @@ class CGLILoader final : public asset::IAssetLoader
 
 		asset::SAssetBundle loadAsset(system::IFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override = nullptr, uint32_t _hierarchyLevel = 0u) override;
 
+		//! KTX2 stores the smallest mip levels first, so the levels from `baseMipLevel` down only need a prefix of the file read (for streaming the rest in later)
+		/** The returned view's image has `baseMipLevel` as its first mip level. Through the asset manager it's `SAssetLoadParams::baseMipLevel`. */
+		static core::smart_refctd_ptr<ICPUImageView> loadKTX2MipTail(system::IFile* file, const uint32_t baseMipLevel, const bool allowMappingReferences=false, const system::logger_opt_ptr logger=nullptr);
+
 	private:
 
 		static inline bool doesItHaveFaces(const IImageView<ICPUImage>::E_TYPE& type)
@@ -5,7 +5,9 @@
 
 #include <algorithm>
 #include <iostream>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
 
 #include "nbl/asset/filters/CRegionBlockFunctorFilter.h"
@@ -16,6 +18,7 @@
 
 
 #include "ImfOutputFile.h"
+#include "ImfTiledOutputFile.h"
 #include "ImfChannelList.h"
 #include "ImfChannelListAttribute.h"
 #include "ImfStringAttribute.h"
@@ -24,6 +27,7 @@
 
 #include "ImfFrameBuffer.h"
 #include "ImfHeader.h"
+#include "ImfThreading.h"
 
 #include "ImfNamespace.h"
 
@@ -41,9 +45,15 @@ namespace nbl::asset::impl
 	class nblOStream : public IMF::OStream
 	{
 	public:
-		nblOStream(system::IFile* _nblFile)
-			: IMF::OStream(getFileName(_nblFile).c_str()), nblFile(_nblFile) {}
-		virtual ~nblOStream() {}
+		nblOStream(system::IFile* _nblFile, const size_t bufferSize)
+			: IMF::OStream(getFileName(_nblFile).c_str()), nblFile(_nblFile)
+		{
+			buffer.reserve(bufferSize);
+		}
+		virtual ~nblOStream()
+		{
+			flush();
+		}
 
 		//----------------------------------------------------------
 		// Write to the stream:
@@ -55,9 +65,17 @@ namespace nbl::asset::impl
 
 		virtual void write(const char c[/*n*/], int n) override
 		{
-			system::IFile::success_t success;
-			nblFile->write(success, c, fileOffset, n);
-			fileOffset += success.getBytesProcessed();
+			// OpenEXR writes every line offset, block header and compressed block separately
+			if (buffer.size()+size_t(n)>buffer.capacity())
+			{
+				flush();
+				if (size_t(n)>=buffer.capacity())
+				{
+					writeToFile(c, n);
+					return;
+				}
+			}
+			buffer.insert(buffer.end(), c, c+n);
 		}
 
 		//---------------------------------------------------------
@@ -69,7 +87,7 @@ namespace nbl::asset::impl
 
 		virtual uint64_t tellp() override
 		{
-			return static_cast<uint64_t>(fileOffset);
+			return static_cast<uint64_t>(fileOffset+buffer.size());
 		}
 
 		//-------------------------------------------
@@ -79,14 +97,27 @@ namespace nbl::asset::impl
 
 		virtual void seekp(uint64_t pos) override
 		{
+			flush();
 			fileOffset = static_cast<decltype(fileOffset)>(pos);
 		}
 
 		void resetFileOffset()
 		{
+			flush();
 			fileOffset = 0u;
 		}
 
+		//! returns false if any write so far failed
+		bool flush()
+		{
+			if (!buffer.empty())
+			{
+				writeToFile(buffer.data(), buffer.size());
+				buffer.clear();
+			}
+			return !failed;
+		}
+
 	private:
 		const std::string getFileName(system::IFile* _nblFile)
 		{
@@ -95,15 +126,25 @@ namespace nbl::asset::impl
 			return filename.string() + extension.string();
 		}
 
+		void writeToFile(const char* data, const size_t size)
+		{
+			system::IFile::success_t success;
+			nblFile->write(success, data, fileOffset, size);
+			fileOffset += success.getBytesProcessed();
+			failed = failed || !success;
+		}
+
 		system::IFile* nblFile;
 		size_t fileOffset = {};
+		core::vector<char> buffer;
+		bool failed = false;
 	};
 }
 
 constexpr uint8_t availableChannels = 4;
 
 template<typename ilmType>
-bool createAndWriteImage(std::array<ilmType*, availableChannels>& pixelsArrayIlm, const asset::ICPUImage* image, system::IFile* _file)
+bool createAndWriteImage(std::array<ilmType*, availableChannels>& pixelsArrayIlm, const asset::ICPUImage* image, system::IFile* _file, const CImageWriterOpenEXR::SWriteParams& writeParams)
 {
 	const auto& creationParams = image->getCreationParameters();
 	auto getIlmType = [&creationParams]()
@@ -121,6 +162,9 @@ bool createAndWriteImage(std::array<ilmType*, availableChannels>& pixelsArrayIlm
 	const auto width = creationParams.extent.width;
 	const auto height = creationParams.extent.height;
 	Header header(width, height);
+	header.compression() = static_cast<Compression>(writeParams.compression);
+	if (writeParams.tileSize)
+		header.setTileDescription(TileDescription(writeParams.tileSize, writeParams.tileSize, ONE_LEVEL));
 	const PixelType pixelType = getIlmType();
 	FrameBuffer frameBuffer;
 
@@ -173,18 +217,35 @@ bool createAndWriteImage(std::array<ilmType*, availableChannels>& pixelsArrayIlm
 		);
 	}
 
-	IMF::OStream* nblOStream = _NBL_NEW(asset::impl::nblOStream, _file);
+	// scanline blocks and tiles get compressed on OpenEXR's own thread pool, which has no threads until someone sizes it
+	const int threadCount = writeParams.threadCount ? writeParams.threadCount:core::max(std::thread::hardware_concurrency(), 1u);
+	{
+		// only ever grow it, shrinking would stall other writes already queued on it
+		static std::mutex globalThreadCountMutex;
+		std::lock_guard lock(globalThreadCountMutex);
+		if (IMF::globalThreadCount() < threadCount)
+			IMF::setGlobalThreadCount(threadCount);
+	}
+	auto* nblOStream = _NBL_NEW(asset::impl::nblOStream, _file, writeParams.outputBufferSize);
+	if (writeParams.tileSize)
+	{ // brackets are needed because of TiledOutputFile's destructor
+		TiledOutputFile file(*nblOStream, header, threadCount);
+		file.setFrameBuffer(frameBuffer);
+		file.writeTiles(0, file.numXTiles()-1, 0, file.numYTiles()-1);
+	}
+	else
 	{ // brackets are needed because of OutputFile's destructor
-		OutputFile file(*nblOStream, header);
+		OutputFile file(*nblOStream, header, threadCount);
 		file.setFrameBuffer(frameBuffer);
 		file.writePixels(height);
 	}
+	const bool success = nblOStream->flush();
 
 	for (auto channelPixelsPtr : pixelsArrayIlm)
 		_NBL_DELETE_ARRAY(channelPixelsPtr, width * height);
 	_NBL_DELETE(nblOStream);
 
-	return true;
+	return success;
 }
 
 bool CImageWriterOpenEXR::writeAsset(system::IFile* _file, const SAssetWriteParams& _params, IAssetWriterOverride* _override)
@@ -203,10 +264,12 @@ bool CImageWriterOpenEXR::writeAsset(system::IFile* _file, const SAssetWritePara
 	if (!file)
 		return false;
 
-	return writeImageBinary(file, image);
+	const auto* userParams = SWriteParamsHeader::cast<SWriteParams>(_params.userData);
+	const SWriteParams writeParams = userParams ? *userParams:SWriteParams{};
+	return writeImageBinary(file, image, writeParams);
 }
 
-bool CImageWriterOpenEXR::writeImageBinary(system::IFile* file, const asset::ICPUImage* image)
+bool CImageWriterOpenEXR::writeImageBinary(system::IFile* file, const asset::ICPUImage* image, const SWriteParams& writeParams)
 {
 	const auto& params = image->getCreationParameters();
 
@@ -215,11 +278,11 @@ bool CImageWriterOpenEXR::writeImageBinary(system::IFile* file, const asset::ICP
 	std::array<uint32_t*, availableChannels> uint32_tPixelMapArray = { nullptr, nullptr, nullptr, nullptr };
 
 	if (params.format == EF_R16G16B16A16_SFLOAT)
-		createAndWriteImage(halfPixelMapArray, image, file);
+		return createAndWriteImage(halfPixelMapArray, image, file, writeParams);
 	else if (params.format == EF_R32G32B32A32_SFLOAT)
-		createAndWriteImage(fullFloatPixelMapArray, image, file);
+		return createAndWriteImage(fullFloatPixelMapArray, image, file, writeParams);
 	else if (params.format == EF_R32G32B32A32_UINT)
-		createAndWriteImage(uint32_tPixelMapArray, image, file);
+		return createAndWriteImage(uint32_tPixelMapArray, image, file, writeParams);
 
 	return true;
 }
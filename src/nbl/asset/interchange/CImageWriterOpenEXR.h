@@ -23,6 +23,9 @@ class CImageWriterOpenEXR final : public IImageWriter
 		~CImageWriterOpenEXR(){}
 
 	public:
+		//! pass a pointer to one as `SAssetWriteParams::userData`, anything else there gets ignored
+		using SWriteParams = SOpenEXRWriteParams;
+
 		CImageWriterOpenEXR(){}
 
 		const char** getAssociatedFileExtensions() const override
@@ -41,7 +44,7 @@ class CImageWriterOpenEXR final : public IImageWriter
 
 	private:
 
-		bool writeImageBinary(system::IFile* file, const asset::ICPUImage* image);
+		bool writeImageBinary(system::IFile* file, const asset::ICPUImage* image, const SWriteParams& writeParams);
 };
 
 }
@@ -11,7 +11,6 @@
 
 #include "nbl/system/IFile.h"
 
-
 #include "nbl/asset/ICPUImageView.h"
 #include "nbl/asset/interchange/IImageAssetHandlerBase.h"
 
@@ -19,11 +18,50 @@
 
 #ifdef _NBL_COMPILE_WITH_LIBPNG_
 	#include "libpng/png.h"
+	#include <zlib/zlib.h>
 #endif // _NBL_COMPILE_WITH_LIBPNG_
 
+#include "nbl/core/execution.h"
+
+#include <numeric>
+
 namespace nbl::asset
 {
 
+bool CImageWriterPNG::SContext::write(const void* data, const size_t size)
+{
+	if (buffer.size()+size>buffer.capacity())
+	{
+		if (!flush())
+			return false;
+		if (size>=buffer.capacity())
+		{
+			system::IFile::success_t success;
+			file->write(success, data, file_pos, size);
+			if (!success)
+				return false;
+			file_pos += success.getBytesProcessed();
+			return true;
+		}
+	}
+	const auto* bytes = reinterpret_cast<const uint8_t*>(data);
+	buffer.insert(buffer.end(), bytes, bytes+size);
+	return true;
+}
+
+bool CImageWriterPNG::SContext::flush()
+{
+	if (buffer.empty())
+		return true;
+	system::IFile::success_t success;
+	file->write(success, buffer.data(), file_pos, buffer.size());
+	if (!success)
+		return false;
+	file_pos += success.getBytesProcessed();
+	buffer.clear();
+	return true;
+}
+
 #ifdef _NBL_COMPILE_WITH_LIBPNG_
 
 const system::logger_opt_ptr getLogger(png_structp png_ptr)
@@ -43,22 +81,77 @@ static void png_cpexcept_warning(png_structp png_ptr, png_const_charp msg)
 	getLogger(png_ptr).log("PNG warning %s", system::ILogger::ELL_WARNING, msg);
 }
 
-// PNG function for file writing
+// PNG function for file writing, libpng hands over every deflate output chunk separately so they get batched
 void PNGAPI user_write_data_fcn(png_structp png_ptr, png_bytep data, png_size_t length)
 {
-	png_size_t check;
+	auto usrData = (CImageWriterPNG::SContext*)png_get_user_chunk_ptr(png_ptr);
+	if (!usrData->write(data, length))
+		png_error(png_ptr, "Write Error");
+}
 
-	system::IFile* file=(system::IFile*)png_get_io_ptr(png_ptr);
-	//check=(png_size_t) file->write((const void*)data,(uint32_t)length);
+void PNGAPI user_flush_data_fcn(png_structp png_ptr)
+{
 	auto usrData = (CImageWriterPNG::SContext*)png_get_user_chunk_ptr(png_ptr);
-	
-	system::IFile::success_t success;
-	file->write(success, data, usrData->file_pos, length);
-	if (!success)
+	if (!usrData->flush())
 		png_error(png_ptr, "Write Error");
+}
 
-	usrData->file_pos += success.getBytesToProcess();
-	png_set_read_user_chunk_fn(png_ptr, usrData, nullptr);
+static inline uint8_t paethPredictor(const uint8_t a, const uint8_t b, const uint8_t c)
+{
+	const int32_t p = int32_t(a)+int32_t(b)-int32_t(c);
+	const int32_t pa = std::abs(p-int32_t(a));
+	const int32_t pb = std::abs(p-int32_t(b));
+	const int32_t pc = std::abs(p-int32_t(c));
+	if (pa<=pb && pa<=pc)
+		return a;
+	return pb<=pc ? b:c;
+}
+
+//! `prev` is the unfiltered previous row or nullptr for the first one, `out` gets the filter type byte followed by the filtered row
+static inline void applyRowFilter(const CImageWriterPNG::SWriteParams::E_ROW_FILTER filter, const uint8_t* row, const uint8_t* prev, const uint32_t lineWidth, const uint32_t bpp, uint8_t* out)
+{
+	*(out++) = filter;
+	for (uint32_t i=0u; i<lineWidth; i++)
+	{
+		const uint8_t left = i>=bpp ? row[i-bpp]:0u;
+		const uint8_t up = prev ? prev[i]:0u;
+		const uint8_t upLeft = prev && i>=bpp ? prev[i-bpp]:0u;
+		switch (filter)
+		{
+			case CImageWriterPNG::SWriteParams::ERF_SUB:
+				out[i] = row[i]-left;
+				break;
+			case CImageWriterPNG::SWriteParams::ERF_UP:
+				out[i] = row[i]-up;
+				break;
+			case CImageWriterPNG::SWriteParams::ERF_AVERAGE:
+				out[i] = row[i]-uint8_t((uint32_t(left)+uint32_t(up))>>1u);
+				break;
+			case CImageWriterPNG::SWriteParams::ERF_PAETH:
+				out[i] = row[i]-paethPredictor(left,up,upLeft);
+				break;
+			default:
+				out[i] = row[i];
+				break;
+		}
+	}
+}
+
+//! the heuristic libpng uses too, filtered bytes treated as signed should be as close to 0 as possible
+static inline uint64_t getRowFilterCost(const uint8_t* filtered, const uint32_t lineWidth)
+{
+	uint64_t cost = 0ull;
+	for (uint32_t i=0u; i<lineWidth; i++)
+		cost += std::abs(int32_t(int8_t(filtered[i])));
+	return cost;
+}
+
+static inline void writeBigEndian(uint8_t* out, const uint32_t value)
+{
+	out[0] = value>>24u;
+	out[1] = value>>16u;
+	out[2] = value>>8u;
+	out[3] = value;
 }
 #endif // _NBL_COMPILE_WITH_LIBPNG_
 
@@ -85,30 +178,11 @@ bool CImageWriterPNG::writeAsset(system::IFile* _file, const SAssetWriteParams&
 	if (!file || !imageView)
 		return false;
 
-	// Allocate the png write struct
-	png_structp png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING,
-		nullptr, (png_error_ptr)png_cpexcept_error, (png_error_ptr)png_cpexcept_warning);
-	if (!png_ptr)
-	{
-		_params.logger.log("PNGWriter: Internal PNG create write struct failure\n%s", system::ILogger::ELL_ERROR, file->getFileName().string().c_str());
-		return false;
-	}
-
-	// Allocate the png info struct
-	png_infop info_ptr = png_create_info_struct(png_ptr);
-	if (!info_ptr)
-	{
-		_params.logger.log("PNGWriter: Internal PNG create info struct failure\n%s", system::ILogger::ELL_ERROR, file->getFileName().string().c_str());
-		png_destroy_write_struct(&png_ptr, nullptr);
-		return false;
-	}
-
-	// for proper error handling
-	if (setjmp(png_jmpbuf(png_ptr)))
-	{
-		png_destroy_write_struct(&png_ptr, &info_ptr);
-		return false;
-	}
+	SWriteParams writeParams;
+	if (const auto* userParams = SWriteParamsHeader::cast<SWriteParams>(_params.userData))
+		writeParams = *userParams;
+	else if (_params.compressionLevel>0.f)
+		writeParams.compressionLevel = core::round<float,int32_t>(core::min(_params.compressionLevel,1.f)*float(Z_BEST_COMPRESSION));
 
 	core::smart_refctd_ptr<ICPUImage> convertedImage;
 	{
@@ -127,57 +201,101 @@ bool CImageWriterPNG::writeAsset(system::IFile* _file, const SAssetWriteParams&
 
 	assert(convertedRegion->bufferRowLength && convertedRegion->bufferImageHeight); //Detected changes in createImageDataForCommonWriting!
 	auto trueExtent = core::vector3du32_SIMD(convertedRegion->bufferRowLength, convertedRegion->bufferImageHeight, convertedRegion->imageExtent.depth);
-	
-	png_set_write_fn(png_ptr, file, user_write_data_fcn, nullptr);
-	
-	// Set info
+
+	uint32_t channelCount;
+	int32_t colorType;
 	switch (convertedFormat)
 	{
+		case asset::EF_R8_SRGB:
+			channelCount = 1u;
+			colorType = PNG_COLOR_TYPE_GRAY;
+			break;
 		case asset::EF_R8G8B8_SRGB:
-			png_set_IHDR(png_ptr, info_ptr,
-				trueExtent.X, trueExtent.Y,
-				8, PNG_COLOR_TYPE_RGB, PNG_INTERLACE_NONE,
-				PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+			channelCount = 3u;
+			colorType = PNG_COLOR_TYPE_RGB;
 			break;
 		case asset::EF_R8G8B8A8_SRGB:
-			png_set_IHDR(png_ptr, info_ptr,
-				trueExtent.X, trueExtent.Y,
-				8, PNG_COLOR_TYPE_RGB_ALPHA, PNG_INTERLACE_NONE,
-				PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
-		break;
-		case asset::EF_R8_SRGB:
-			png_set_IHDR(png_ptr, info_ptr,
-				trueExtent.X, trueExtent.Y,
-				8, PNG_COLOR_TYPE_GRAY, PNG_INTERLACE_NONE,
-				PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
-		break;
+			channelCount = 4u;
+			colorType = PNG_COLOR_TYPE_RGB_ALPHA;
+			break;
 		default:
 			{
 				_params.logger.log("Unsupported color format, operation aborted.", system::ILogger::ELL_ERROR);
 				return false;
 			}
 	}
+	const int32_t lineWidth = trueExtent.X*channelCount;
+	
+	uint8_t* data = (uint8_t*)convertedImage->getBuffer()->getPointer();
 
-	int32_t lineWidth = trueExtent.X;
-	switch (convertedFormat)
+	// declared before any `setjmp` so a `longjmp` never skips its destructor
+	SContext usrData(m_system.get(), file, _params.logger, writeParams.outputBufferSize);
+	if (writeParams.parallel)
 	{
-		case asset::EF_R8_SRGB:
-			lineWidth *= 1;
+		if (writeParallel(usrData, writeParams, data, trueExtent.X, trueExtent.Y, channelCount))
+			return true;
+		_params.logger.log("PNGWriter: Parallel write failed\n%s", system::ILogger::ELL_ERROR, file->getFileName().string().c_str());
+		return false;
+	}
+
+	// Allocate the png write struct
+	png_structp png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING,
+		nullptr, (png_error_ptr)png_cpexcept_error, (png_error_ptr)png_cpexcept_warning);
+	if (!png_ptr)
+	{
+		_params.logger.log("PNGWriter: Internal PNG create write struct failure\n%s", system::ILogger::ELL_ERROR, file->getFileName().string().c_str());
+		return false;
+	}
+	// the error callbacks need it for the logger
+	png_set_read_user_chunk_fn(png_ptr, &usrData, nullptr);
+
+	// Allocate the png info struct
+	png_infop info_ptr = png_create_info_struct(png_ptr);
+	if (!info_ptr)
+	{
+		_params.logger.log("PNGWriter: Internal PNG create info struct failure\n%s", system::ILogger::ELL_ERROR, file->getFileName().string().c_str());
+		png_destroy_write_struct(&png_ptr, nullptr);
+		return false;
+	}
+
+	// for proper error handling
+	if (setjmp(png_jmpbuf(png_ptr)))
+	{
+		png_destroy_write_struct(&png_ptr, &info_ptr);
+		return false;
+	}
+	
+	png_set_write_fn(png_ptr, file, user_write_data_fcn, user_flush_data_fcn);
+	
+	// Set info
+	png_set_IHDR(png_ptr, info_ptr,
+		trueExtent.X, trueExtent.Y,
+		8, colorType, PNG_INTERLACE_NONE,
+		PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+
+	png_set_compression_level(png_ptr, writeParams.compressionLevel);
+	png_set_compression_strategy(png_ptr, writeParams.strategy);
+	switch (writeParams.filter)
+	{
+		case SWriteParams::ERF_NONE:
+			png_set_filter(png_ptr, PNG_FILTER_TYPE_BASE, PNG_FILTER_NONE);
 			break;
-		case asset::EF_R8G8B8_SRGB:
-			lineWidth *= 3;
+		case SWriteParams::ERF_SUB:
+			png_set_filter(png_ptr, PNG_FILTER_TYPE_BASE, PNG_FILTER_SUB);
 			break;
-		case asset::EF_R8G8B8A8_SRGB:
-			lineWidth *= 4;
+		case SWriteParams::ERF_UP:
+			png_set_filter(png_ptr, PNG_FILTER_TYPE_BASE, PNG_FILTER_UP);
+			break;
+		case SWriteParams::ERF_AVERAGE:
+			png_set_filter(png_ptr, PNG_FILTER_TYPE_BASE, PNG_FILTER_AVG);
+			break;
+		case SWriteParams::ERF_PAETH:
+			png_set_filter(png_ptr, PNG_FILTER_TYPE_BASE, PNG_FILTER_PAETH);
 			break;
 		default:
-			{
-				_params.logger.log("Unsupported color format, operation aborted.", system::ILogger::ELL_ERROR);
-				return false;
-			}
+			png_set_filter(png_ptr, PNG_FILTER_TYPE_BASE, PNG_ALL_FILTERS);
+			break;
 	}
-	
-	uint8_t* data = (uint8_t*)convertedImage->getBuffer()->getPointer();
 
 	constexpr uint32_t maxPNGFileHeight = 16u * 1024u; // arbitrary limit
 	if (trueExtent.Y>maxPNGFileHeight)
@@ -196,27 +314,170 @@ bool CImageWriterPNG::writeAsset(system::IFile* _file, const SAssetWriteParams&
 		RowPointers[i] = reinterpret_cast<png_bytep>(data);
 		data += lineWidth;
 	}
-	
-	// for proper error handling
-	if (setjmp(png_jmpbuf(png_ptr)))
-	{
-		png_destroy_write_struct(&png_ptr, &info_ptr);
-		return false;
-	}
 
-	SContext usrData(m_system.get(), _params.logger);
-	png_set_read_user_chunk_fn(png_ptr, &usrData, nullptr);
 	png_set_rows(png_ptr, info_ptr, RowPointers);
 	png_write_png(png_ptr, info_ptr, PNG_TRANSFORM_IDENTITY, nullptr);
 
 	png_destroy_write_struct(&png_ptr, &info_ptr);
-	return true;
+	return usrData.flush();
 #else
 	_NBL_DEBUG_BREAK_IF(true);
 	return false;
 #endif//defined(_NBL_COMPILE_WITH_LIBPNG_)
 }
 
+bool CImageWriterPNG::writeParallel(SContext& ctx, const SWriteParams& writeParams, const uint8_t* data, const uint32_t width, const uint32_t height, const uint32_t channelCount)
+{
+#if defined(_NBL_COMPILE_WITH_LIBPNG_)
+	if (!width || !height)
+		return false;
+	const uint32_t lineWidth = width*channelCount;
+	const size_t filteredRowSize = lineWidth+1ull;
+
+	// filter every row, they only depend on the unfiltered data
+	core::vector<uint8_t> filtered(filteredRowSize*height);
+	{
+		core::vector<uint32_t> rows(height);
+		std::iota(rows.begin(), rows.end(), 0u);
+		std::for_each(core::execution::par_unseq, rows.begin(), rows.end(), [&](const uint32_t y) -> void
+		{
+			const uint8_t* row = data+size_t(y)*lineWidth;
+			const uint8_t* prev = y ? (row-lineWidth):nullptr;
+			uint8_t* out = filtered.data()+y*filteredRowSize;
+			if (writeParams.filter!=SWriteParams::ERF_ADAPTIVE)
+			{
+				applyRowFilter(writeParams.filter, row, prev, lineWidth, channelCount, out);
+				return;
+			}
+			thread_local core::vector<uint8_t> candidate;
+			candidate.resize(filteredRowSize);
+			uint64_t bestCost = ~0ull;
+			for (uint8_t filter=SWriteParams::ERF_NONE; filter<SWriteParams::ERF_ADAPTIVE; filter++)
+			{
+				applyRowFilter(static_cast<SWriteParams::E_ROW_FILTER>(filter), row, prev, lineWidth, channelCount, candidate.data());
+				const uint64_t cost = getRowFilterCost(candidate.data()+1u, lineWidth);
+				if (cost<bestCost)
+				{
+					bestCost = cost;
+					std::copy(candidate.begin(), candidate.end(), out);
+				}
+			}
+		});
+	}
+
+	// every group becomes the payload of one IDAT chunk, a raw deflate stream ending on a byte boundary (sync flush) except for the last
+	constexpr uint32_t maxDictionarySize = 0x1u<<15u;
+	const uint32_t rowsPerGroup = core::max<uint32_t>(writeParams.bytesPerGroup/filteredRowSize, 1u);
+	const uint32_t groupCount = (height+rowsPerGroup-1u)/rowsPerGroup;
+	struct SGroup
+	{
+		core::vector<uint8_t> chunk;
+		uLong adler;
+		bool success = false;
+	};
+	core::vector<SGroup> groups(groupCount);
+	std::for_each(core::execution::par, groups.begin(), groups.end(), [&](SGroup& group) -> void
+	{
+		const uint32_t groupIx = std::distance(groups.data(), &group);
+		const bool first = groupIx==0u;
+		const bool last = groupIx==groupCount-1u;
+		const size_t begin = size_t(groupIx)*rowsPerGroup*filteredRowSize;
+		const size_t end = core::min<size_t>(begin+size_t(rowsPerGroup)*filteredRowSize, filtered.size());
+
+		z_stream stream = {};
+		if (deflateInit2(&stream, writeParams.compressionLevel, Z_DEFLATED, -MAX_WBITS, 8, writeParams.strategy)!=Z_OK)
+			return;
+		if (!first)
+		{
+			const uint32_t dictionarySize = core::min<size_t>(begin, maxDictionarySize);
+			deflateSetDictionary(&stream, filtered.data()+begin-dictionarySize, dictionarySize);
+		}
+		stream.next_in = filtered.data()+begin;
+		stream.avail_in = end-begin;
+
+		// chunk length and type go in front, the zlib header too for the first group
+		const size_t prefixSize = first ? 10ull:8ull;
+		group.chunk.resize(prefixSize+deflateBound(&stream, end-begin)+16ull);
+		size_t produced = prefixSize;
+		int ret;
+		do
+		{
+			if (produced==group.chunk.size())
+				group.chunk.resize(group.chunk.size()*2ull);
+			stream.next_out = group.chunk.data()+produced;
+			stream.avail_out = group.chunk.size()-produced;
+			ret = deflate(&stream, last ? Z_FINISH:Z_SYNC_FLUSH);
+			produced = group.chunk.size()-stream.avail_out;
+		} while (ret==Z_OK && stream.avail_out==0u);
+		deflateEnd(&stream);
+		group.chunk.resize(produced);
+
+		group.adler = adler32(adler32(0ul, Z_NULL, 0u), filtered.data()+begin, end-begin);
+		group.success = last ? (ret==Z_STREAM_END):(ret==Z_OK);
+	});
+	if (!std::all_of(groups.begin(), groups.end(), [](const SGroup& group) -> bool {return group.success;}))
+		return false;
+
+	// zlib header and the Adler-32 of all the data the stream inflates to
+	{
+		const int32_t level = writeParams.compressionLevel<0 ? Z_DEFAULT_COMPRESSION:writeParams.compressionLevel;
+		const uint8_t compressionMethodAndFlags = 0x78u; // deflate with a 32kB window
+		uint8_t flags = (level==Z_DEFAULT_COMPRESSION || level==6 ? 2u:(level<2 ? 0u:(level<6 ? 1u:3u)))<<6u;
+		flags += 31u-((uint32_t(compressionMethodAndFlags)<<8u)+flags)%31u;
+		groups.front().chunk[8] = compressionMethodAndFlags;
+		groups.front().chunk[9] = flags;
+
+		uLong adler = groups.front().adler;
+		for (uint32_t g=1u; g<groupCount; g++)
+		{
+			const size_t begin = size_t(g)*rowsPerGroup*filteredRowSize;
+			const size_t end = core::min<size_t>(begin+size_t(rowsPerGroup)*filteredRowSize, filtered.size());
+			adler = adler32_combine(adler, groups[g].adler, end-begin);
+		}
+		auto& lastChunk = groups.back().chunk;
+		lastChunk.resize(lastChunk.size()+4ull);
+		writeBigEndian(lastChunk.data()+lastChunk.size()-4ull, adler);
+	}
+	std::for_each(core::execution::par_unseq, groups.begin(), groups.end(), [](SGroup& group) -> void
+	{
+		auto& chunk = group.chunk;
+		writeBigEndian(chunk.data(), chunk.size()-8ull);
+		memcpy(chunk.data()+4u, "IDAT", 4u);
+		const uint32_t crc = crc32(crc32(0ul, Z_NULL, 0u), chunk.data()+4u, chunk.size()-4ull);
+		chunk.resize(chunk.size()+4ull);
+		writeBigEndian(chunk.data()+chunk.size()-4ull, crc);
+	});
+
+	auto writeChunk = [&ctx](const char* type, const uint8_t* payload, const uint32_t size) -> bool
+	{
+		uint8_t header[8];
+		writeBigEndian(header, size);
+		memcpy(header+4u, type, 4u);
+		uint8_t crc[4];
+		writeBigEndian(crc, crc32(crc32(crc32(0ul, Z_NULL, 0u), header+4u, 4u), payload, size));
+		return ctx.write(header, sizeof(header)) && ctx.write(payload, size) && ctx.write(crc, sizeof(crc));
+	};
+
+	constexpr uint8_t signature[8] = { 0x89u, 'P', 'N', 'G', '\r', '\n', 0x1Au, '\n' };
+	uint8_t ihdr[13];
+	writeBigEndian(ihdr, width);
+	writeBigEndian(ihdr+4u, height);
+	ihdr[8] = 8u; // bit depth
+	ihdr[9] = channelCount==1u ? PNG_COLOR_TYPE_GRAY:(channelCount==3u ? PNG_COLOR_TYPE_RGB:PNG_COLOR_TYPE_RGB_ALPHA);
+	ihdr[10] = PNG_COMPRESSION_TYPE_BASE;
+	ihdr[11] = PNG_FILTER_TYPE_BASE;
+	ihdr[12] = PNG_INTERLACE_NONE;
+	if (!ctx.write(signature, sizeof(signature)) || !writeChunk("IHDR", ihdr, sizeof(ihdr)))
+		return false;
+	for (const auto& group : groups)
+	if (!ctx.write(group.chunk.data(), group.chunk.size()))
+		return false;
+	return writeChunk("IEND", nullptr, 0u) && ctx.flush();
+#else
+	return false;
+#endif//defined(_NBL_COMPILE_WITH_LIBPNG_)
+}
+
 } // namespace nbl::video
 
 #endif
\ No newline at end of file
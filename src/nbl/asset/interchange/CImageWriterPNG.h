@@ -11,6 +11,7 @@
 #ifdef _NBL_COMPILE_WITH_PNG_WRITER_
 
 #include "nbl/asset/interchange/IAssetWriter.h"
+#include "nbl/asset/interchange/SImageWriteParams.h"
 
 namespace nbl
 {
@@ -21,11 +22,24 @@ class CImageWriterPNG : public asset::IAssetWriter
 {
     core::smart_refctd_ptr<system::ISystem> m_system;
 public:
+    //! pass a pointer to one as `SAssetWriteParams::userData`, anything else there gets ignored
+    using SWriteParams = SPNGWriteParams;
+
     struct SContext
     {
-        SContext(system::ISystem* sys, const system::logger_opt_ptr log) : system(sys), logger(log) {}
+        SContext(system::ISystem* sys, system::IFile* _file, const system::logger_opt_ptr log, const size_t bufferSize) : system(sys), file(_file), logger(log)
+        {
+            buffer.reserve(bufferSize);
+        }
+
+        //! batches small writes, ones bigger than the buffer go straight to the file
+        bool write(const void* data, const size_t size);
+        bool flush();
+
         system::ISystem* system;
+        system::IFile* file;
         size_t file_pos = 0;
+        core::vector<uint8_t> buffer;
         system::logger_opt_ptr logger;
     };
     //! constructor
@@ -44,6 +58,10 @@ public:
     virtual uint32_t getForcedFlags() { return asset::EWF_BINARY; }
     
     virtual bool writeAsset(system::IFile* _file, const SAssetWriteParams& _params, IAssetWriterOverride* _override = nullptr) override;
+
+private:
+    //! the `SWriteParams::parallel` path, doesn't use libpng at all
+    static bool writeParallel(SContext& ctx, const SWriteParams& writeParams, const uint8_t* data, const uint32_t width, const uint32_t height, const uint32_t channelCount);
 };
 
 } // namespace video
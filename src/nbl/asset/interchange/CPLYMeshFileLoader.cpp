@@ -8,10 +8,12 @@
 #ifdef _NBL_COMPILE_WITH_PLY_LOADER_
 
 #include <numeric>
+#include <charconv>
 
 #include "nbl/asset/IAssetManager.h"
 #include "nbl/system/ISystem.h"
 #include "nbl/system/IFile.h"
+#include "nbl/core/execution.h"
 #include "nbl/asset/utils/IMeshManipulator.h"
 
 namespace nbl
@@ -402,11 +404,12 @@ asset::SAssetBundle CPLYMeshFileLoader::loadAsset(system::IFile* _file, const as
 						}			
 					}
 
-					// loop through vertex properties
-					for (uint32_t j=0; j<ctx.ElementList[i]->Count; ++j)
-						hasNormals &= readVertex(ctx, plyVertexElement, attributes, j, _params);
+					// ASCII element bodies get parsed all at once after the buffers are ready
+					if (ctx.IsBinaryFile)
+						for (uint32_t j=0; j<ctx.ElementList[i]->Count; ++j)
+							hasNormals &= readVertex(ctx, plyVertexElement, attributes, j, _params);
 				}
-				else if (ctx.ElementList[i]->Name == "face")
+				else if (ctx.IsBinaryFile && ctx.ElementList[i]->Name == "face")
 				{
 					const size_t indicesCount = ctx.ElementList[i]->Count;
 
@@ -414,7 +417,7 @@ asset::SAssetBundle CPLYMeshFileLoader::loadAsset(system::IFile* _file, const as
 					for (uint32_t j=0; j < indicesCount; ++j)
 						readFace(ctx, *ctx.ElementList[i], indices);
 				}
-				else
+				else if (ctx.IsBinaryFile)
 				{
 					// skip these elements
 					for (uint32_t j=0; j < ctx.ElementList[i]->Count; ++j)
@@ -422,14 +425,26 @@ asset::SAssetBundle CPLYMeshFileLoader::loadAsset(system::IFile* _file, const as
 				}
 			}
 
+			core::smart_refctd_ptr<ICPUBuffer> indexBuffer;
+			if (!ctx.IsBinaryFile)
+			{
+				if (!readASCIIBody(ctx, attributes, indexBuffer))
+					return {};
+			}
+			else if (indices.size())
+			{
+				indexBuffer = core::make_smart_refctd_ptr<asset::ICPUBuffer>(indices.size() * sizeof(uint32_t));
+				memcpy(indexBuffer->getPointer(), indices.data(), indexBuffer->getSize());
+			}
+
 			mb->setPositionAttributeIx(0);
 
-            if (indices.size())
+            if (indexBuffer)
             {
-				asset::SBufferBinding<ICPUBuffer> indexBinding = { 0, core::make_smart_refctd_ptr<asset::ICPUBuffer>(indices.size() * sizeof(uint32_t)) };
-				memcpy(indexBinding.buffer->getPointer(), indices.data(), indexBinding.buffer->getSize());
+				const size_t indexCount = indexBuffer->getSize() / sizeof(uint32_t);
+				asset::SBufferBinding<ICPUBuffer> indexBinding = { 0, std::move(indexBuffer) };
 				
-				mb->setIndexCount(indices.size());
+				mb->setIndexCount(indexCount);
 				mb->setIndexBufferBinding(std::move(indexBinding));
 				mb->setIndexType(asset::EIT_32BIT);
 
@@ -670,6 +685,278 @@ bool CPLYMeshFileLoader::readFace(SContext& _ctx, const SPLYElement& Element, co
 }
 
 
+namespace
+{
+// whitespace separated tokens of a single line of an ASCII PLY body
+struct SASCIILineTokenizer
+{
+	inline bool isSeparator(const char c) const {return c==' ' || c=='\t' || c=='\r';}
+
+	// returns false when the line has no more tokens
+	inline bool skipSeparators()
+	{
+		while (it<end && isSeparator(*it))
+			it++;
+		return it<end;
+	}
+	inline void skipToken()
+	{
+		skipSeparators();
+		while (it<end && !isSeparator(*it))
+			it++;
+	}
+	// tokens which can't be parsed read as 0, like they did with `atof` and `atoi`
+	template<typename T>
+	inline T next()
+	{
+		T value = T(0);
+		if (skipSeparators())
+		{
+			it = std::from_chars(it,end,value).ptr;
+			while (it<end && !isSeparator(*it))
+				it++;
+		}
+		return value;
+	}
+
+	const char* it;
+	const char* end;
+};
+
+// calls `func` with every line which isn't blank, without its line break
+template<typename F>
+inline void forEachASCIILine(const char* it, const char* const end, F&& func)
+{
+	while (it<end)
+	{
+		const char* lineEnd = reinterpret_cast<const char*>(memchr(it,'\n',end-it));
+		if (!lineEnd)
+			lineEnd = end;
+		SASCIILineTokenizer tokens = {it,lineEnd};
+		if (tokens.skipSeparators())
+			func(tokens);
+		it = lineEnd<end ? (lineEnd+1):end;
+	}
+}
+}
+
+bool CPLYMeshFileLoader::readASCIIBody(SContext& _ctx, asset::SBufferBinding<asset::ICPUBuffer> outAttributes[4], core::smart_refctd_ptr<ICPUBuffer>& outIndices)
+{
+	system::IFile* const file = _ctx.inner.mainFile;
+	const auto& logger = _ctx.inner.params.logger;
+
+	// the header got read through the refill buffer, whose end is at `fileOffset` in the file
+	const char* const headerEnd = _ctx.LineEndPointer+1;
+	const size_t bodyOffset = _ctx.fileOffset-(headerEnd<_ctx.EndPointer ? size_t(_ctx.EndPointer-headerEnd):0ull);
+	const size_t bodySize = file->getSize()>bodyOffset ? (file->getSize()-bodyOffset):0ull;
+
+	// no refills, the body gets used straight from the mapping or read with one call
+	const char* body = reinterpret_cast<const char*>(static_cast<const system::IFile*>(file)->getMappedPointer());
+	core::vector<char> bodyStorage;
+	if (body)
+		body += bodyOffset;
+	else
+	{
+		bodyStorage.resize(bodySize);
+		system::IFile::success_t success;
+		file->read(success, bodyStorage.data(), bodyOffset, bodySize);
+		if (!success)
+			return false;
+		body = bodyStorage.data();
+	}
+	const char* const bodyEnd = body+bodySize;
+
+	struct SChunk
+	{
+		const char* begin;
+		const char* end;
+		// global index of the first non-blank line
+		size_t firstLine = 0ull;
+		size_t lineCount = 0ull;
+		// faces don't all have the same amount of vertices, so they get triangulated into chunk local storage first
+		core::vector<uint32_t> indices = {};
+		size_t firstIndex = 0ull;
+	};
+	core::vector<SChunk> chunks;
+	for (const char* it=body; it<bodyEnd;)
+	{
+		const char* end = it+core::min<size_t>(ASCIIChunkSize,bodyEnd-it);
+		end = std::find(end,bodyEnd,'\n');
+		if (end!=bodyEnd)
+			end++;
+		chunks.push_back({it,end});
+		it = end;
+	}
+
+	// every line is one element, so the line index is enough to know which element and which slice of the output it is
+	std::for_each(core::execution::par, chunks.begin(), chunks.end(), [](SChunk& chunk) -> void
+	{
+		forEachASCIILine(chunk.begin, chunk.end, [&chunk](const SASCIILineTokenizer&) -> void {chunk.lineCount++;});
+	});
+	size_t lineCount = 0ull;
+	for (auto& chunk : chunks)
+	{
+		chunk.firstLine = lineCount;
+		lineCount += chunk.lineCount;
+	}
+	const uint32_t elementCount = _ctx.ElementList.size();
+	core::vector<size_t> elementFirstLine(elementCount+1u,0ull);
+	for (uint32_t i=0u; i<elementCount; i++)
+		elementFirstLine[i+1u] = elementFirstLine[i]+_ctx.ElementList[i]->Count;
+	if (lineCount<elementFirstLine.back())
+	{
+		logger.log("PLY file %s ends before all of its elements", system::ILogger::ELL_ERROR, file->getFileName().string().c_str());
+		return false;
+	}
+
+	// where each property of a vertex element goes, resolved once instead of comparing names for every vertex
+	struct SVertexProperty
+	{
+		// first vertex's component, null for properties which get skipped
+		float* out = nullptr;
+		// in floats
+		uint32_t stride = 0u;
+		float scale = 1.f;
+		bool isList = false;
+	};
+	const bool rightHanded = _ctx.inner.params.loaderFlags&E_LOADER_PARAMETER_FLAGS::ELPF_RIGHT_HANDED_MESHES;
+	auto getTarget = [outAttributes](const E_TYPE type, const uint32_t component, const uint32_t componentCount, const float scale) -> SVertexProperty
+	{
+		return {reinterpret_cast<float*>(outAttributes[type].buffer->getPointer())+component,componentCount,scale};
+	};
+	core::vector<core::vector<SVertexProperty>> vertexProperties(elementCount);
+	for (uint32_t i=0u; i<elementCount; i++)
+	{
+		const auto& element = *_ctx.ElementList[i];
+		if (element.Name!="vertex")
+			continue;
+
+		for (const auto& property : element.Properties)
+		{
+			const float colorScale = property.isFloat() ? 1.f:(1.f/255.f);
+			SVertexProperty target;
+			if (property.Name=="x")
+				target = getTarget(ET_POS,0u,3u,rightHanded ? -1.f:1.f);
+			else if (property.Name=="y")
+				target = getTarget(ET_POS,1u,3u,1.f);
+			else if (property.Name=="z")
+				target = getTarget(ET_POS,2u,3u,1.f);
+			else if (property.Name=="nx")
+				target = getTarget(ET_NORM,0u,3u,rightHanded ? -1.f:1.f);
+			else if (property.Name=="ny")
+				target = getTarget(ET_NORM,1u,3u,1.f);
+			else if (property.Name=="nz")
+				target = getTarget(ET_NORM,2u,3u,1.f);
+			else if (property.Name=="u" || property.Name=="s")
+				target = getTarget(ET_UV,0u,2u,1.f);
+			else if (property.Name=="v" || property.Name=="t")
+				target = getTarget(ET_UV,1u,2u,1.f);
+			else if (property.Name=="red")
+				target = getTarget(ET_COL,0u,4u,colorScale);
+			else if (property.Name=="green")
+				target = getTarget(ET_COL,1u,4u,colorScale);
+			else if (property.Name=="blue")
+				target = getTarget(ET_COL,2u,4u,colorScale);
+			else if (property.Name=="alpha")
+				target = getTarget(ET_COL,3u,4u,colorScale);
+			else
+				target.isList = property.Type==EPLYPT_LIST;
+			vertexProperties[i].push_back(target);
+		}
+	}
+
+	auto skipList = [](SASCIILineTokenizer& tokens) -> void
+	{
+		for (uint32_t count=tokens.next<uint32_t>(); count; count--)
+			tokens.skipToken();
+	};
+	auto readVertexLine = [&](SASCIILineTokenizer& tokens, const core::vector<SVertexProperty>& properties, const size_t vertex) -> void
+	{
+		for (const auto& property : properties)
+		{
+			if (property.out)
+				property.out[vertex*property.stride] = tokens.next<float>()*property.scale;
+			else if (property.isList)
+				skipList(tokens);
+			else
+				tokens.skipToken();
+		}
+	};
+	auto readFaceLine = [&](SASCIILineTokenizer& tokens, const SPLYElement& element, core::vector<uint32_t>& outIndices) -> void
+	{
+		for (const auto& property : element.Properties)
+		{
+			if ((property.Name=="vertex_indices" || property.Name=="vertex_index") && property.Type==EPLYPT_LIST)
+			{
+				const bool floatItems = property.Data.List.ItemType==EPLYPT_FLOAT32 || property.Data.List.ItemType==EPLYPT_FLOAT64;
+				auto nextIndex = [&]() -> uint32_t {return floatItems ? uint32_t(tokens.next<double>()):tokens.next<uint32_t>();};
+
+				const uint32_t count = tokens.next<uint32_t>();
+				if (count<3u)
+				{
+					for (uint32_t j=0u; j<count; j++)
+						tokens.skipToken();
+					continue;
+				}
+				// same fan triangulation as `readFace`
+				const uint32_t a = nextIndex();
+				uint32_t b = nextIndex(), c = nextIndex();
+				outIndices.insert(outIndices.end(),{a,b,c});
+				for (uint32_t j=3u; j<count; j++)
+				{
+					b = c;
+					c = nextIndex();
+					outIndices.insert(outIndices.end(),{a,c,b});
+				}
+			}
+			else if (property.Type==EPLYPT_LIST)
+				skipList(tokens);
+			else
+				tokens.skipToken();
+		}
+	};
+
+	std::for_each(core::execution::par, chunks.begin(), chunks.end(), [&](SChunk& chunk) -> void
+	{
+		size_t line = chunk.firstLine;
+		uint32_t element = 0u;
+		forEachASCIILine(chunk.begin, chunk.end, [&](SASCIILineTokenizer& tokens) -> void
+		{
+			while (element<elementCount && line>=elementFirstLine[element+1u])
+				element++;
+			// anything past the last element is ignored
+			if (element<elementCount)
+			{
+				const auto& plyElement = *_ctx.ElementList[element];
+				if (plyElement.Name=="vertex")
+					readVertexLine(tokens, vertexProperties[element], line-elementFirstLine[element]);
+				else if (plyElement.Name=="face")
+					readFaceLine(tokens, plyElement, chunk.indices);
+			}
+			line++;
+		});
+	});
+
+	size_t indexCount = 0ull;
+	for (auto& chunk : chunks)
+	{
+		chunk.firstIndex = indexCount;
+		indexCount += chunk.indices.size();
+	}
+	if (indexCount)
+	{
+		outIndices = core::make_smart_refctd_ptr<asset::ICPUBuffer>(indexCount*sizeof(uint32_t));
+		uint32_t* const indices = reinterpret_cast<uint32_t*>(outIndices->getPointer());
+		std::for_each(core::execution::par_unseq, chunks.begin(), chunks.end(), [indices](const SChunk& chunk) -> void
+		{
+			if (!chunk.indices.empty())
+				memcpy(indices+chunk.firstIndex, chunk.indices.data(), chunk.indices.size()*sizeof(uint32_t));
+		});
+	}
+	return true;
+}
+
+
 // skips an element and all properties. return false on EOF
 void CPLYMeshFileLoader::skipElement(SContext& _ctx, const SPLYElement& Element)
 {
@@ -194,6 +194,12 @@ private:
  	bool readVertex(SContext& _ctx, const SPLYElement &Element, asset::SBufferBinding<asset::ICPUBuffer> outAttributes[4], const uint32_t& currentVertexIndex, const IAssetLoader::SAssetLoadParams& _params);
 	bool readFace(SContext& _ctx, const SPLYElement &Element, core::vector<uint32_t>& _outIndices);
 
+	// ASCII element data gets split into chunks of roughly this size at line breaks, which are tokenized and parsed in parallel
+	static inline constexpr size_t ASCIIChunkSize = 0x1ull<<20u;
+	//! parses everything after `end_header` of an ASCII file in one go, vertices get written straight into their slice of `outAttributes`
+	//! and the triangulated faces into `outIndices`, which stays null when the file has no faces
+	bool readASCIIBody(SContext& _ctx, asset::SBufferBinding<asset::ICPUBuffer> outAttributes[4], core::smart_refctd_ptr<ICPUBuffer>& outIndices);
+
 	void skipElement(SContext& _ctx, const SPLYElement &Element);
 	void skipProperty(SContext& _ctx, const SPLYProperty &Property);
 	float getFloat(SContext& _ctx, E_PLY_PROPERTY_TYPE t);
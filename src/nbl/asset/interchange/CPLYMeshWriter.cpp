@@ -10,6 +10,9 @@
 #include "nbl/system/ISystem.h"
 #include "nbl/system/IFile.h"
 #include "nbl/asset/utils/CMeshManipulator.h"
+#include "nbl/core/execution.h"
+
+#include <charconv>
 
 namespace nbl
 {
@@ -47,6 +50,19 @@ static asset::E_FORMAT getCorrespondingIntegerFormat(asset::E_FORMAT _fmt)
     default: return EF_UNKNOWN;
     }
 }
+
+// formats the same way as `std::fixed` with `std::setprecision(6)` did for floats, followed by a space
+template<typename T>
+static inline char* formatValue(char* _out, char* const _end, const T _value)
+{
+    std::to_chars_result result;
+    if constexpr (std::is_floating_point_v<T>)
+        result = std::to_chars(_out, _end - 1, _value, std::chars_format::fixed, 6);
+    else
+        result = std::to_chars(_out, _end - 1, _value);
+    *result.ptr = ' ';
+    return result.ptr + 1;
+}
 }
 
 CPLYMeshWriter::CPLYMeshWriter()
@@ -110,13 +126,9 @@ bool CPLYMeshWriter::writeAsset(system::IFile* _file, const SAssetWriteParams& _
     uint32_t faceCount = {}; 
     size_t vertexCount = {};
 
-    void* indices = nullptr;
+    // read in place, the meshbuffer doesn't get modified
+    const void* indices = rawCopyMeshBuffer->getIndices();
     {
-        auto indexCount = rawCopyMeshBuffer->getIndexCount();
-
-        indices = _NBL_ALIGNED_MALLOC(indexCount * sizeof(uint32_t), _NBL_SIMD_ALIGNMENT);
-        memcpy(indices, rawCopyMeshBuffer->getIndices(), indexCount * sizeof(uint32_t));
-        
         IMeshManipulator::getPolyCount(faceCount, rawCopyMeshBuffer);
         vertexCount = IMeshManipulator::upperBoundVertexID(rawCopyMeshBuffer);
     }
@@ -219,307 +231,207 @@ bool CPLYMeshWriter::writeAsset(system::IFile* _file, const SAssetWriteParams& _
     }
  
     if (flags & asset::EWF_BINARY)
-        writeBinary(rawCopyMeshBuffer, vertexCount, faceCount, idxT, indices, forceFaces, vaidToWrite, context);
+        return writeBinary(rawCopyMeshBuffer, vertexCount, faceCount, idxT, indices, forceFaces, vaidToWrite, context);
     else
-        writeText(rawCopyMeshBuffer, vertexCount, faceCount, idxT, indices, forceFaces, vaidToWrite, context);
-
-    _NBL_ALIGNED_FREE(const_cast<void*>(indices));
-
-	return true;
+        return writeText(rawCopyMeshBuffer, vertexCount, faceCount, idxT, indices, forceFaces, vaidToWrite, context);
 }
 
-void CPLYMeshWriter::writeBinary(const asset::ICPUMeshBuffer* _mbuf, size_t _vtxCount, size_t _fcCount, asset::E_INDEX_TYPE _idxType, void* const _indices, bool _forceFaces, const bool _vaidToWrite[4], SContext& context) const
+template<typename Encode>
+bool CPLYMeshWriter::writeBlocks(SContext& context, const size_t _count, Encode&& encode)
 {
-    const size_t colCpa = asset::getFormatChannelCount(_mbuf->getAttribFormat(1));
-
-	bool flipVectors = (!(context.writeContext.params.flags & E_WRITER_FLAGS::EWF_MESH_IS_RIGHT_HANDED)) ? true : false;
-
-    auto mbCopy = createCopyMBuffNormalizedReplacedWithTrueInt(_mbuf);
-    for (size_t i = 0u; i < _vtxCount; ++i)
+    // the block storage gets reused by every batch, so nothing gets allocated after the first one
+    core::vector<core::vector<uint8_t>> blocks(core::min((_count+ElementsPerBlock-1ull)/ElementsPerBlock, BlocksPerBatch));
+    for (size_t batchFirst = 0ull; batchFirst < _count; batchFirst += ElementsPerBlock*BlocksPerBatch)
     {
-        core::vectorSIMDf f;
-        uint32_t ui[4];
-        if (_vaidToWrite[0])
-        {
-            writeAttribBinary(context, mbCopy.get(), 0, i, 3u, flipVectors);
-        }
-        if (_vaidToWrite[1])
-        {
-            writeAttribBinary(context, mbCopy.get(), 1, i, colCpa);
-        }
-        if (_vaidToWrite[2])
+        const size_t batchBlocks = core::min((_count-batchFirst+ElementsPerBlock-1ull)/ElementsPerBlock, blocks.size());
+        std::for_each(core::execution::par, blocks.begin(), blocks.begin()+batchBlocks, [&](core::vector<uint8_t>& block) -> void
         {
-            writeAttribBinary(context, mbCopy.get(), 2, i, 2u);
-        }
-        if (_vaidToWrite[3])
-        {
-            writeAttribBinary(context, mbCopy.get(), 3, i, 3u, flipVectors);
-        }
-    }
+            const size_t first = batchFirst+size_t(&block-blocks.data())*ElementsPerBlock;
+            block.clear();
+            encode(first, core::min(first+ElementsPerBlock, _count), block);
+        });
 
-    constexpr uint8_t listSize = 3u;
-    void* indices = _indices;
-    if (_forceFaces)
-    {
-        indices = _NBL_ALIGNED_MALLOC((_idxType == asset::EIT_32BIT ? 4 : 2) * listSize * _fcCount,_NBL_SIMD_ALIGNMENT);
-        if (_idxType == asset::EIT_16BIT)
-        {
-            for (uint16_t i = 0u; i < _fcCount; ++i)
-                ((uint16_t*)indices)[i] = i;
-        }
-        else
+        for (size_t i = 0ull; i < batchBlocks; ++i)
         {
-            for (uint32_t i = 0u; i < _fcCount; ++i)
-                ((uint32_t*)indices)[i] = i;
-        }
-    }
-    if (_idxType == asset::EIT_32BIT)
-    {
-        uint32_t* ind = (uint32_t*)indices;
-        for (size_t i = 0u; i < _fcCount; ++i)
-        {
-            {
-                system::IFile::success_t success;
-                context.writeContext.outputFile->write(success, &listSize, context.fileOffset, sizeof(listSize));
-                context.fileOffset += success.getBytesProcessed();
-            }
-
-            {
-                system::IFile::success_t success;
-                context.writeContext.outputFile->write(success, ind, context.fileOffset, listSize * 4);
-                context.fileOffset += success.getBytesProcessed();
-            }
-
-            ind += listSize;
-        }
-    }
-    else
-    {
-        uint16_t* ind = (uint16_t*)indices;
-        for (size_t i = 0u; i < _fcCount; ++i)
-        {
-            {
-                system::IFile::success_t success;
-                context.writeContext.outputFile->write(success, &listSize, context.fileOffset, sizeof(listSize));
-                context.fileOffset += success.getBytesProcessed();
-            }
-
-            {
-                system::IFile::success_t success;
-                context.writeContext.outputFile->write(success, ind, context.fileOffset, listSize * 2);
-                context.fileOffset += success.getBytesProcessed();
-            }
-            
-            ind += listSize;
+            system::IFile::success_t success;
+            context.writeContext.outputFile->write(success, blocks[i].data(), context.fileOffset, blocks[i].size());
+            context.fileOffset += success.getBytesProcessed();
+            if (!success)
+                return false;
         }
     }
-
-    if (_forceFaces)
-        _NBL_ALIGNED_FREE(indices);
+    return true;
 }
 
-void CPLYMeshWriter::writeText(const asset::ICPUMeshBuffer* _mbuf, size_t _vtxCount, size_t _fcCount, asset::E_INDEX_TYPE _idxType, void* const _indices, bool _forceFaces, const bool _vaidToWrite[4], SContext& context) const
+core::vector<CPLYMeshWriter::SAttribute> CPLYMeshWriter::getAttributesToWrite(const asset::ICPUMeshBuffer* _mbuf, const bool _vaidToWrite[4], const bool _flipVectors)
 {
-    auto mbCopy = createCopyMBuffNormalizedReplacedWithTrueInt(_mbuf);
-
-    auto writefunc = [&context, &mbCopy, this](uint32_t _vaid, size_t _ix, size_t _cpa)
+    core::vector<SAttribute> attributes;
+    for (uint32_t vaid = 0u; vaid < 4u; ++vaid)
     {
-		bool flipVerteciesAndNormals = false;
-		if (!(context.writeContext.params.flags & E_WRITER_FLAGS::EWF_MESH_IS_RIGHT_HANDED))
-			if(_vaid == 0u || _vaid == 3u)
-				flipVerteciesAndNormals = true;
-
-        uint32_t ui[4];
-        core::vectorSIMDf f;
-        const asset::E_FORMAT t = mbCopy->getAttribFormat(_vaid);
-        if (asset::isScaledFormat(t) || asset::isIntegerFormat(t))
-        {
-            mbCopy->getAttribute(ui, _vaid, _ix);
-            if (!asset::isSignedFormat(t))
-                writeVectorAsText(context, ui, _cpa, flipVerteciesAndNormals);
-            else
-            {
-                int32_t ii[4];
-                memcpy(ii, ui, 4*4);
-                writeVectorAsText(context, ii, _cpa, flipVerteciesAndNormals);
-            }
-        }
+        if (!_vaidToWrite[vaid])
+            continue;
+
+        SAttribute& attribute = attributes.emplace_back();
+        // same as `ICPUMeshBuffer::getAttribPointer` without requiring a mutable meshbuffer
+        attribute.stride = _mbuf->getAttribStride(vaid);
+        attribute.src = reinterpret_cast<const uint8_t*>(_mbuf->getAttribBoundBuffer(vaid).buffer->getPointer()) + _mbuf->getAttribCombinedOffset(vaid) + int64_t(_mbuf->getBaseVertex()) * attribute.stride;
+
+        const asset::E_FORMAT t = _mbuf->getAttribFormat(vaid);
+        attribute.format = asset::isNormalizedFormat(t) ? impl::getCorrespondingIntegerFormat(t) : t;
+        attribute.channels = vaid == 1u ? asset::getFormatChannelCount(t) : (vaid == 2u ? 2u : 3u);
+        attribute.flipX = _flipVectors && (vaid == 0u || vaid == 3u);
+        attribute.isInteger = asset::isScaledFormat(attribute.format) || asset::isIntegerFormat(attribute.format);
+        attribute.isSigned = asset::isSignedFormat(attribute.format);
+
+        const uint32_t formatChannels = asset::getFormatChannelCount(attribute.format);
+        const uint32_t bytesPerCh = asset::getTexelOrBlockBytesize(attribute.format) / formatChannels;
+        attribute.isFloat32 = !attribute.isInteger && asset::isFloatingPointFormat(attribute.format) && bytesPerCh == 4u && attribute.channels <= formatChannels;
+        if (!attribute.isInteger)
+            attribute.binaryChannelSize = sizeof(float);
+        else if (bytesPerCh == 1u || t == asset::EF_A2B10G10R10_UINT_PACK32 || t == asset::EF_A2B10G10R10_SINT_PACK32 || t == asset::EF_A2B10G10R10_SSCALED_PACK32 || t == asset::EF_A2B10G10R10_USCALED_PACK32)
+            attribute.binaryChannelSize = 1u;
+        else if (bytesPerCh == 2u || bytesPerCh == 4u)
+            attribute.binaryChannelSize = bytesPerCh;
         else
-        {
-            mbCopy->getAttribute(f, _vaid, _ix);
-            writeVectorAsText(context, f.pointer, _cpa, flipVerteciesAndNormals);
-        }
-    };
-
-    const size_t colCpa = asset::getFormatChannelCount(_mbuf->getAttribFormat(1));
-
-    for (size_t i = 0u; i < _vtxCount; ++i)
-    {
-        core::vectorSIMDf f;
-        uint32_t ui[4];
-        if (_vaidToWrite[0])
-        {
-            writefunc(0, i, 3u);
-        }
-        if (_vaidToWrite[1])
-        {
-            writefunc(1, i, colCpa);
-        }
-        if (_vaidToWrite[2])
-        {
-            writefunc(2, i, 2u);
-        }
-        if (_vaidToWrite[3])
-        {
-            writefunc(3, i, 3u);
-        }
-
-        {
-            system::IFile::success_t success;
-            context.writeContext.outputFile->write(success, "\n", context.fileOffset, 1);
-            context.fileOffset += success.getBytesProcessed();
-        }
+            attribute.binaryChannelSize = 0u;
     }
+    return attributes;
+}
 
-    const char* listSize = "3 ";
-    void* indices = _indices;
-    if (_forceFaces)
-    {
-        indices = _NBL_ALIGNED_MALLOC((_idxType == asset::EIT_32BIT ? 4 : 2) * 3 * _fcCount,_NBL_SIMD_ALIGNMENT);
-        if (_idxType == asset::EIT_16BIT)
-        {
-            for (uint16_t i = 0u; i < _fcCount; ++i)
-                ((uint16_t*)indices)[i] = i;
-        }
-        else
-        {
-            for (uint32_t i = 0u; i < _fcCount; ++i)
-                ((uint32_t*)indices)[i] = i;
-        }
-    }
-    if (_idxType == asset::EIT_32BIT)
+bool CPLYMeshWriter::writeBinary(const asset::ICPUMeshBuffer* _mbuf, size_t _vtxCount, size_t _fcCount, asset::E_INDEX_TYPE _idxType, const void* _indices, bool _forceFaces, const bool _vaidToWrite[4], SContext& context) const
+{
+    const bool flipVectors = !(context.writeContext.params.flags & E_WRITER_FLAGS::EWF_MESH_IS_RIGHT_HANDED);
+    const auto attributes = getAttributesToWrite(_mbuf, _vaidToWrite, flipVectors);
+    size_t vertexSize = 0ull;
+    for (const auto& attribute : attributes)
+        vertexSize += attribute.channels * attribute.binaryChannelSize;
+
+    // fixed size records, values get copied as they are because the file is little endian just like every platform we support
+    const bool verticesWritten = writeBlocks(context, _vtxCount, [&](const size_t first, const size_t last, core::vector<uint8_t>& out) -> void
     {
-        uint32_t* ind = (uint32_t*)indices;
-        for (size_t i = 0u; i < _fcCount; ++i)
+        out.resize((last - first) * vertexSize);
+        uint8_t* dst = out.data();
+        for (size_t i = first; i < last; ++i)
+        for (const auto& attribute : attributes)
         {
+            if (attribute.isInteger)
             {
-                system::IFile::success_t success;
-                context.writeContext.outputFile->write(success, listSize, context.fileOffset, 2);
-                context.fileOffset += success.getBytesProcessed();
+                uint32_t ui[4] = {};
+                attribute.decode(i, ui);
+                switch (attribute.binaryChannelSize)
+                {
+                    case 1u:
+                        for (uint32_t k = 0u; k < attribute.channels; ++k)
+                            dst[k] = ui[k];
+                        break;
+                    case 2u:
+                        for (uint32_t k = 0u; k < attribute.channels; ++k)
+                        {
+                            const uint16_t a = ui[k];
+                            memcpy(dst + 2u * k, &a, 2u);
+                        }
+                        break;
+                    case 4u:
+                        memcpy(dst, ui, 4u * attribute.channels);
+                        break;
+                    default:
+                        break;
+                }
             }
-
-            writeVectorAsText(context, ind, 3);
-
+            else
             {
-                system::IFile::success_t success;
-                context.writeContext.outputFile->write(success, "\n", context.fileOffset, 1);
-                context.fileOffset += success.getBytesProcessed();
+                float f[4] = {};
+                attribute.decode(i, f);
+                memcpy(dst, f, 4u * attribute.channels);
             }
-
-            ind += 3;
+            dst += attribute.channels * attribute.binaryChannelSize;
         }
-    }
-    else
+    });
+    if (!verticesWritten)
+        return false;
+
+    constexpr uint8_t listSize = 3u;
+    const size_t indexSize = _idxType == asset::EIT_32BIT ? 4u : 2u;
+    const size_t faceSize = sizeof(listSize) + listSize * indexSize;
+    return writeBlocks(context, _fcCount, [&](const size_t first, const size_t last, core::vector<uint8_t>& out) -> void
     {
-        uint16_t* ind = (uint16_t*)indices;
-        for (size_t i = 0u; i < _fcCount; ++i)
+        out.resize((last - first) * faceSize);
+        uint8_t* dst = out.data();
+        for (size_t i = first; i < last; ++i)
         {
+            *(dst++) = listSize;
+            for (size_t k = 0u; k < listSize; ++k, dst += indexSize)
             {
-                system::IFile::success_t success;
-                context.writeContext.outputFile->write(success, listSize, context.fileOffset, 2);
-                context.fileOffset += success.getBytesProcessed();
+                const size_t ix = i * listSize + k;
+                // triangle lists without an index buffer just have consecutive vertices
+                const uint32_t index = _forceFaces ? uint32_t(ix) : (_idxType == asset::EIT_32BIT ? reinterpret_cast<const uint32_t*>(_indices)[ix] : reinterpret_cast<const uint16_t*>(_indices)[ix]);
+                if (_idxType == asset::EIT_32BIT)
+                    memcpy(dst, &index, 4u);
+                else
+                {
+                    const uint16_t index16 = index;
+                    memcpy(dst, &index16, 2u);
+                }
             }
-
-            writeVectorAsText(context, ind, 3);
-
-            {
-                system::IFile::success_t success;
-                context.writeContext.outputFile->write(success, "\n", context.fileOffset, 1);
-                context.fileOffset += success.getBytesProcessed();
-            }
-
-            ind += 3;
         }
-    }
-
-    if (_forceFaces)
-        _NBL_ALIGNED_FREE(indices);
+    });
 }
 
-void CPLYMeshWriter::writeAttribBinary(SContext& context, asset::ICPUMeshBuffer* _mbuf, uint32_t _vaid, size_t _ix, size_t _cpa, bool flipAttribute) const
+bool CPLYMeshWriter::writeText(const asset::ICPUMeshBuffer* _mbuf, size_t _vtxCount, size_t _fcCount, asset::E_INDEX_TYPE _idxType, const void* _indices, bool _forceFaces, const bool _vaidToWrite[4], SContext& context) const
 {
-    uint32_t ui[4];
-    core::vectorSIMDf f;
-    asset::E_FORMAT t = _mbuf->getAttribFormat(_vaid);
+    const bool flipVectors = !(context.writeContext.params.flags & E_WRITER_FLAGS::EWF_MESH_IS_RIGHT_HANDED);
+    const auto attributes = getAttributesToWrite(_mbuf, _vaidToWrite, flipVectors);
 
-    if (asset::isScaledFormat(t) || asset::isIntegerFormat(t))
+    // every value is followed by a space, every element by a line break
+    const bool verticesWritten = writeBlocks(context, _vtxCount, [&](const size_t first, const size_t last, core::vector<uint8_t>& out) -> void
     {
-        _mbuf->getAttribute(ui, _vaid, _ix);
-        if (flipAttribute)
-            ui[0] = -ui[0];
-
-        const uint32_t bytesPerCh = asset::getTexelOrBlockBytesize(t)/asset::getFormatChannelCount(t);
-        if (bytesPerCh == 1u || t == asset::EF_A2B10G10R10_UINT_PACK32 || t == asset::EF_A2B10G10R10_SINT_PACK32 || t == asset::EF_A2B10G10R10_SSCALED_PACK32 || t == asset::EF_A2B10G10R10_USCALED_PACK32)
+        char line[MaxTextLineSize];
+        for (size_t i = first; i < last; ++i)
         {
-            uint8_t a[4];
-            for (uint32_t k = 0u; k < _cpa; ++k)
-                a[k] = ui[k];
-
+            char* it = line;
+            for (const auto& attribute : attributes)
             {
-                system::IFile::success_t success;
-                context.writeContext.outputFile->write(success, a, context.fileOffset, _cpa);
-                context.fileOffset += success.getBytesProcessed();
+                if (attribute.isInteger)
+                {
+                    uint32_t ui[4] = {};
+                    attribute.decode(i, ui);
+                    for (uint32_t k = 0u; k < attribute.channels; ++k)
+                        it = attribute.isSigned ? impl::formatValue(it, line + MaxTextLineSize, int32_t(ui[k])) : impl::formatValue(it, line + MaxTextLineSize, ui[k]);
+                }
+                else
+                {
+                    float f[4] = {};
+                    attribute.decode(i, f);
+                    for (uint32_t k = 0u; k < attribute.channels; ++k)
+                        it = impl::formatValue(it, line + MaxTextLineSize, f[k]);
+                }
             }
+            *(it++) = '\n';
+            out.insert(out.end(), line, it);
         }
-        else if (bytesPerCh == 2u)
-        {
-            uint16_t a[4];
-            for (uint32_t k = 0u; k < _cpa; ++k)
-                a[k] = ui[k];
+    });
+    if (!verticesWritten)
+        return false;
 
-            {
-                system::IFile::success_t success;
-                context.writeContext.outputFile->write(success, a, context.fileOffset, 2 * _cpa);
-                context.fileOffset += success.getBytesProcessed();
-            }
-        }
-        else if (bytesPerCh == 4u)
+    return writeBlocks(context, _fcCount, [&](const size_t first, const size_t last, core::vector<uint8_t>& out) -> void
+    {
+        char line[MaxTextLineSize];
+        for (size_t i = first; i < last; ++i)
         {
+            char* it = line;
+            *(it++) = '3';
+            *(it++) = ' ';
+            for (size_t k = 0u; k < 3u; ++k)
             {
-                system::IFile::success_t success;
-                context.writeContext.outputFile->write(success, ui, context.fileOffset, 4 * _cpa);
-                context.fileOffset += success.getBytesProcessed();
+                const size_t ix = i * 3u + k;
+                // triangle lists without an index buffer just have consecutive vertices
+                const uint32_t index = _forceFaces ? uint32_t(ix) : (_idxType == asset::EIT_32BIT ? reinterpret_cast<const uint32_t*>(_indices)[ix] : reinterpret_cast<const uint16_t*>(_indices)[ix]);
+                it = impl::formatValue(it, line + MaxTextLineSize, index);
             }
+            *(it++) = '\n';
+            out.insert(out.end(), line, it);
         }
-    }
-    else
-    {
-        _mbuf->getAttribute(f, _vaid, _ix);
-        if (flipAttribute)
-            f[0] = -f[0];
-
-        {
-            system::IFile::success_t success;
-            context.writeContext.outputFile->write(success, f.pointer, context.fileOffset, 4 * _cpa);
-            context.fileOffset += success.getBytesProcessed();
-        }
-    }
-}
-
-core::smart_refctd_ptr<asset::ICPUMeshBuffer> CPLYMeshWriter::createCopyMBuffNormalizedReplacedWithTrueInt(const asset::ICPUMeshBuffer* _mbuf)
-{
-    auto mbCopy = core::smart_refctd_ptr_static_cast<ICPUMeshBuffer>(_mbuf->clone(2));
-
-    for (size_t i = 0; i < ICPUMeshBuffer::MAX_VERTEX_ATTRIB_COUNT; ++i)
-    {
-        auto vaid = i;
-        asset::E_FORMAT t = _mbuf->getAttribFormat(vaid);
-    
-        if (_mbuf->getAttribBoundBuffer(vaid).buffer)
-            mbCopy->getPipeline()->getCachedCreationParams().vertexInput.attributes[vaid].format = asset::isNormalizedFormat(t) ? impl::getCorrespondingIntegerFormat(t) : t;
-    }
-
-    return mbCopy;
+    });
 }
 
 std::string CPLYMeshWriter::getTypeString(asset::E_FORMAT _t)
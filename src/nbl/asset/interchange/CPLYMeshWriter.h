@@ -6,8 +6,6 @@
 #ifndef __NBL_ASSET_PLY_MESH_WRITER_H_INCLUDED__
 #define __NBL_ASSET_PLY_MESH_WRITER_H_INCLUDED__
 
-#include <iomanip>
-
 #include "nbl/asset/ICPUMeshBuffer.h"
 #include "nbl/asset/interchange/IAssetWriter.h"
 
@@ -45,38 +43,59 @@ class CPLYMeshWriter : public asset::IAssetWriter
             size_t fileOffset = 0;
         };
 
-        void writeBinary(const asset::ICPUMeshBuffer* _mbuf, size_t _vtxCount, size_t _fcCount, asset::E_INDEX_TYPE _idxType, void* const _indices, bool _forceFaces, const bool _vaidToWrite[4], SContext& context) const;
-        void writeText(const asset::ICPUMeshBuffer* _mbuf, size_t _vtxCount, size_t _fcCount, asset::E_INDEX_TYPE _idxType, void* const _indices, bool _forceFaces, const bool _vaidToWrite[4], SContext& context) const;
+        // every block of elements gets encoded on one thread, this many blocks get encoded in parallel before they're written in order
+        static inline constexpr size_t ElementsPerBlock = 0x1ull<<16u;
+        static inline constexpr size_t BlocksPerBatch = 16ull;
+        // longest possible line of the ASCII vertex element is 12 values of `float` with 6 decimal digits
+        static inline constexpr size_t MaxTextLineSize = 1024ull;
 
-        void writeAttribBinary(SContext& context, asset::ICPUMeshBuffer* _mbuf, uint32_t _vaid, size_t _ix, size_t _cpa, bool flipAttribute = false) const;
+        //! vertex attribute to write, resolved once so that encoding doesn't look up the pipeline and bindings for every value
+        struct SAttribute
+        {
+            inline void decode(const size_t _ix, uint32_t* _out) const
+            {
+                ICPUMeshBuffer::getAttribute(_out, src+_ix*stride, format);
+                if (flipX)
+                    _out[0] = -_out[0];
+            }
+            inline void decode(const size_t _ix, float* _out) const
+            {
+                const uint8_t* vertex = src+_ix*stride;
+                if (isFloat32)
+                    memcpy(_out, vertex, channels*sizeof(float));
+                else
+                {
+                    core::vectorSIMDf f;
+                    ICPUMeshBuffer::getAttribute(f, vertex, format);
+                    memcpy(_out, f.pointer, channels*sizeof(float));
+                }
+                if (flipX)
+                    _out[0] = -_out[0];
+            }
+
+            const uint8_t* src;
+            uint32_t stride;
+            //! normalized formats get written as the corresponding true integer formats
+            asset::E_FORMAT format;
+            uint32_t channels;
+            bool flipX;
+            bool isInteger;
+            bool isSigned;
+            //! can be copied straight out of the vertex buffer
+            bool isFloat32;
+            //! bytes per channel in binary files, 0 if the format can't be written
+            uint32_t binaryChannelSize;
+        };
+        static core::vector<SAttribute> getAttributesToWrite(const asset::ICPUMeshBuffer* _mbuf, const bool _vaidToWrite[4], const bool _flipVectors);
 
-        //! Creates new mesh buffer with the same attribute buffers mapped but with normalized types changed to corresponding true integer types.
-        static core::smart_refctd_ptr<asset::ICPUMeshBuffer> createCopyMBuffNormalizedReplacedWithTrueInt(const asset::ICPUMeshBuffer* _mbuf);
+        //! `encode(first,last,outBlock)` appends elements `[first,last)` to `outBlock`, blocks get encoded in parallel and written in order with one call each
+        template<typename Encode>
+        static bool writeBlocks(SContext& context, const size_t _count, Encode&& encode);
 
-        static std::string getTypeString(asset::E_FORMAT _t);
+        bool writeBinary(const asset::ICPUMeshBuffer* _mbuf, size_t _vtxCount, size_t _fcCount, asset::E_INDEX_TYPE _idxType, const void* _indices, bool _forceFaces, const bool _vaidToWrite[4], SContext& context) const;
+        bool writeText(const asset::ICPUMeshBuffer* _mbuf, size_t _vtxCount, size_t _fcCount, asset::E_INDEX_TYPE _idxType, const void* _indices, bool _forceFaces, const bool _vaidToWrite[4], SContext& context) const;
 
-        template<typename T>
-        void writeVectorAsText(SContext& context, const T* _vec, size_t _elementsToWrite, bool flipVectors = false) const
-        {
-			constexpr size_t xID = 0u;
-            std::stringstream ss;
-            ss << std::fixed;
-			bool currentFlipOnVariable = false;
-			for (size_t i = 0u; i < _elementsToWrite; ++i)
-			{
-				if (flipVectors && i == xID)
-					currentFlipOnVariable = true;
-				else
-					currentFlipOnVariable = false;
-
-					ss << std::setprecision(6) << _vec[i] * (currentFlipOnVariable ? -1 : 1) << " ";
-			}
-            auto str = ss.str();
-
-            system::IFile::success_t succ;
-            context.writeContext.outputFile->write(succ, str.c_str(), context.fileOffset, str.size());
-            context.fileOffset += succ.getBytesProcessed();
-        }
+        static std::string getTypeString(asset::E_FORMAT _t);
 };
 
 } // end namespace
@@ -12,9 +12,14 @@
 
 #include "nbl/asset/IAssetManager.h"
 
+#include "nbl/core/algorithm/radix_sort.h"
+#include "nbl/core/execution.h"
+
 #include "nbl/system/ISystem.h"
 #include "nbl/system/IFile.h"
 
+#include <numeric>
+
 using namespace nbl;
 using namespace nbl::asset;
 
@@ -159,38 +164,21 @@ SAssetBundle CSTLMeshFileLoader::loadAsset(system::IFile* _file, const IAssetLoa
 	bool binary = false;
 	std::string token;
 	if (getNextToken(&context, token) != "solid")
-		binary = hasColor = true;
+		binary = true;
 
-	core::vector<core::vectorSIMDf> positions, normals;
-	core::vector<uint32_t> colors;
+	core::smart_refctd_ptr<ICPUBuffer> vertexBuf;
 	if (binary)
 	{
-		if (_file->getSize() < 80)
-			return {};
-
-		constexpr size_t headerOffset = 80; 
-		context.fileOffset = headerOffset; //! skip header
-
-		uint32_t vertexCount = 0u;
-
-		system::IFile::success_t success;
-		context.inner.mainFile->read(success, &vertexCount, context.fileOffset, sizeof(vertexCount));
-		if (!success)
+		if (!loadBinary(&context, vertexBuf, hasColor))
 			return {};
-		context.fileOffset += sizeof(vertexCount);
-
-		positions.reserve(3 * vertexCount);
-		normals.reserve(vertexCount);
-		colors.reserve(vertexCount);
 	}
 	else
+	{
 		goNextLine(&context); // skip header
 
-	uint16_t attrib = 0u;
-	token.reserve(32);
-	while (context.fileOffset < filesize) // TODO: check it
-	{
-		if (!binary)
+		core::vector<core::vectorSIMDf> positions, normals;
+		token.reserve(32);
+		while (context.fileOffset < filesize) // TODO: check it
 		{
 			if (getNextToken(&context, token) != "facet")
 			{
@@ -202,95 +190,72 @@ SAssetBundle CSTLMeshFileLoader::loadAsset(system::IFile* _file, const IAssetLoa
 			{
 				return {};
 			}
-		}
 
-		{
-			core::vectorSIMDf n;
-			getNextVector(&context, n, binary);
-			if(_params.loaderFlags & E_LOADER_PARAMETER_FLAGS::ELPF_RIGHT_HANDED_MESHES)
-				performActionBasedOnOrientationSystem<float>(n.x, [](float& varToFlip) {varToFlip = -varToFlip;});
-			normals.push_back(core::normalize(n));
-		}
+			{
+				core::vectorSIMDf n;
+				getNextVector(&context, n, binary);
+				if(_params.loaderFlags & E_LOADER_PARAMETER_FLAGS::ELPF_RIGHT_HANDED_MESHES)
+					performActionBasedOnOrientationSystem<float>(n.x, [](float& varToFlip) {varToFlip = -varToFlip;});
+				normals.push_back(core::normalize(n));
+			}
 
-		if (!binary)
-		{
 			if (getNextToken(&context, token) != "outer" || getNextToken(&context, token) != "loop")
 				return {};
-		}
 
-		{
-			core::vectorSIMDf p[3];
-			for (uint32_t i = 0u; i < 3u; ++i)
 			{
-				if (!binary)
+				core::vectorSIMDf p[3];
+				for (uint32_t i = 0u; i < 3u; ++i)
 				{
 					if (getNextToken(&context, token) != "vertex")
 						return {};
+					getNextVector(&context, p[i], binary);
+					if (_params.loaderFlags & E_LOADER_PARAMETER_FLAGS::ELPF_RIGHT_HANDED_MESHES)
+						performActionBasedOnOrientationSystem<float>(p[i].x, [](float& varToFlip){varToFlip = -varToFlip; });
 				}
-				getNextVector(&context, p[i], binary);
-				if (_params.loaderFlags & E_LOADER_PARAMETER_FLAGS::ELPF_RIGHT_HANDED_MESHES)
-					performActionBasedOnOrientationSystem<float>(p[i].x, [](float& varToFlip){varToFlip = -varToFlip; });
+				for (uint32_t i = 0u; i < 3u; ++i) // seems like in STL format vertices are ordered in clockwise manner...
+					positions.push_back(p[2u - i]);
 			}
-			for (uint32_t i = 0u; i < 3u; ++i) // seems like in STL format vertices are ordered in clockwise manner...
-				positions.push_back(p[2u - i]);
-		}
 
-		if (!binary)
-		{
 			if (getNextToken(&context, token) != "endloop" || getNextToken(&context, token) != "endfacet")
 				return {};
-		}
-		else
-		{
-			system::IFile::success_t success;
-			context.inner.mainFile->read(success, &attrib, context.fileOffset, sizeof(attrib));
-			if (!success)
-				return {};
-			context.fileOffset += sizeof(attrib);
-		}
-
-		if (hasColor && (attrib & 0x8000u)) // assuming VisCam/SolidView non-standard trick to store color in 2 bytes of extra attribute
-		{
-			const void* srcColor[1]{ &attrib };
-			uint32_t color{};
-			convertColor<EF_A1R5G5B5_UNORM_PACK16, EF_B8G8R8A8_UNORM>(srcColor, &color, 0u, 0u);
-			colors.push_back(color);
-		}
-		else
-		{
-			hasColor = false;
-			colors.clear();
-		}
 
-		if ((normals.back() == core::vectorSIMDf()).all())
-		{
-			normals.back().set(
-				core::plane3dSIMDf(
-					*(positions.rbegin() + 2),
-					*(positions.rbegin() + 1),
-					*(positions.rbegin() + 0)).getNormal()
-			);
-		}
-	} // end while (_file->getPos() < filesize)
+			if ((normals.back() == core::vectorSIMDf()).all())
+			{
+				normals.back().set(
+					core::plane3dSIMDf(
+						*(positions.rbegin() + 2),
+						*(positions.rbegin() + 1),
+						*(positions.rbegin() + 0)).getNormal()
+				);
+			}
+		} // end while (_file->getPos() < filesize)
 
-	const size_t vtxSize = hasColor ? (3 * sizeof(float) + 4 + 4) : (3 * sizeof(float) + 4);
-	auto vertexBuf = core::make_smart_refctd_ptr<asset::ICPUBuffer>(vtxSize * positions.size());
+		constexpr size_t vtxSize = 3 * sizeof(float) + 4;
+		vertexBuf = core::make_smart_refctd_ptr<asset::ICPUBuffer>(vtxSize * positions.size());
 
-	using quant_normal_t = CQuantNormalCache::value_type_t<EF_A2B10G10R10_SNORM_PACK32>;
+		using quant_normal_t = CQuantNormalCache::value_type_t<EF_A2B10G10R10_SNORM_PACK32>;
 
-	quant_normal_t normal;
-	for (size_t i = 0u; i < positions.size(); ++i)
-	{
-		if (i % 3 == 0)
-			normal = quantNormalCache->quantize<EF_A2B10G10R10_SNORM_PACK32>(normals[i / 3]);
-		uint8_t* ptr = ((uint8_t*)(vertexBuf->getPointer())) + i * vtxSize;
-		memcpy(ptr, positions[i].pointer, 3 * 4);
+		quant_normal_t normal;
+		for (size_t i = 0u; i < positions.size(); ++i)
+		{
+			if (i % 3 == 0)
+				normal = quantNormalCache->quantize<EF_A2B10G10R10_SNORM_PACK32>(normals[i / 3]);
+			uint8_t* ptr = ((uint8_t*)(vertexBuf->getPointer())) + i * vtxSize;
+			memcpy(ptr, positions[i].pointer, 3 * 4);
 
-		*reinterpret_cast<quant_normal_t*>(ptr + 12) = normal;
+			*reinterpret_cast<quant_normal_t*>(ptr + 12) = normal;
+		}
+	}
 
-		if (hasColor)
-			memcpy(ptr + 16, colors.data() + i / 3, 4);
+	const uint32_t vtxSize = hasColor ? (3 * sizeof(float) + 4 + 4) : (3 * sizeof(float) + 4);
+	const uint32_t vertexCount = vertexBuf->getSize() / vtxSize;
+	if (_params.loaderFlags & E_LOADER_PARAMETER_FLAGS::ELPF_WELD_VERTICES)
+	{
+		meshbuffer->setIndexBufferBinding({ 0ull, weldVertices(vertexBuf, vtxSize) });
+		meshbuffer->setIndexType(asset::EIT_32BIT);
 	}
+	else
+		meshbuffer->setIndexType(asset::EIT_UNKNOWN);
 
 	const IAssetLoader::SAssetLoadContext fakeContext(IAssetLoader::SAssetLoadParams{}, nullptr);
 	const asset::IAsset::E_TYPE types[]{ asset::IAsset::ET_RENDERPASS_INDEPENDENT_PIPELINE, (asset::IAsset::E_TYPE)0u };
@@ -306,8 +271,7 @@ SAssetBundle CSTLMeshFileLoader::loadAsset(system::IFile* _file, const IAssetLoa
 	meta->placeMeta(0u, mbPipeline.get());
 
 	meshbuffer->setPipeline(std::move(mbPipeline));
-	meshbuffer->setIndexCount(positions.size());
-	meshbuffer->setIndexType(asset::EIT_UNKNOWN);
+	meshbuffer->setIndexCount(vertexCount);
 
 	meshbuffer->setVertexBufferBinding({ 0ul, vertexBuf }, 0);
 	mesh->getMeshBufferVector().emplace_back(std::move(meshbuffer));
@@ -348,6 +312,169 @@ bool CSTLMeshFileLoader::isALoadableFileFormat(system::IFile* _file, const syste
 	}
 }
 
+bool CSTLMeshFileLoader::loadBinary(SContext* context, core::smart_refctd_ptr<ICPUBuffer>& outVertices, bool& outHasColor) const
+{
+	system::IFile* const file = context->inner.mainFile;
+	uint32_t triangleCount = 0u;
+	{
+		system::IFile::success_t success;
+		file->read(success, &triangleCount, BinaryHeaderSize-sizeof(triangleCount), sizeof(triangleCount));
+		if (!success)
+			return false;
+	}
+	const size_t recordsSize = size_t(triangleCount)*BinaryRecordSize;
+	if (file->getSize()<BinaryHeaderSize+recordsSize)
+		return false;
+
+	// no per-facet reads, the records get used straight from the mapping or read with one call
+	const uint8_t* records = reinterpret_cast<const uint8_t*>(static_cast<const system::IFile*>(file)->getMappedPointer());
+	core::vector<uint8_t> recordStorage;
+	if (records)
+		records += BinaryHeaderSize;
+	else
+	{
+		recordStorage.resize(recordsSize);
+		system::IFile::success_t success;
+		file->read(success, recordStorage.data(), BinaryHeaderSize, recordsSize);
+		if (!success)
+			return false;
+		records = recordStorage.data();
+	}
+	auto getAttribute = [records](const uint32_t triangle) -> uint16_t
+	{
+		uint16_t attrib;
+		memcpy(&attrib, records+size_t(triangle)*BinaryRecordSize+48u, sizeof(attrib));
+		return attrib;
+	};
+
+	core::vector<uint32_t> chunks((triangleCount+BinaryTrianglesPerChunk-1u)/BinaryTrianglesPerChunk);
+	std::iota(chunks.begin(), chunks.end(), 0u);
+	auto forEachTriangleInChunk = [triangleCount](const uint32_t chunk, auto&& func) -> void
+	{
+		const uint32_t end = core::min(triangleCount, (chunk+1u)*BinaryTrianglesPerChunk);
+		for (uint32_t triangle=chunk*BinaryTrianglesPerChunk; triangle<end; triangle++)
+			func(triangle);
+	};
+
+	// assuming VisCam/SolidView non-standard trick to store color in 2 bytes of extra attribute, only if every facet has it
+	outHasColor = triangleCount && std::all_of(core::execution::par_unseq, chunks.begin(), chunks.end(), [&](const uint32_t chunk) -> bool
+	{
+		bool hasColor = true;
+		forEachTriangleInChunk(chunk, [&](const uint32_t triangle) -> void {hasColor = hasColor && (getAttribute(triangle)&0x8000u);});
+		return hasColor;
+	});
+
+	const size_t vtxSize = outHasColor ? (3 * sizeof(float) + 4 + 4) : (3 * sizeof(float) + 4);
+	outVertices = core::make_smart_refctd_ptr<asset::ICPUBuffer>(vtxSize * 3ull * triangleCount);
+	uint8_t* const vertices = reinterpret_cast<uint8_t*>(outVertices->getPointer());
+
+	using quant_normal_t = CQuantNormalCache::value_type_t<EF_A2B10G10R10_SNORM_PACK32>;
+	CQuantNormalCache* const quantNormalCache = context->inner.params.meshManipulatorOverride->getQuantNormalCache();
+	// the X axis gets flipped unless right handed meshes are wanted, like `getNextVector` and the ASCII path do
+	const core::vectorSIMDf flip(context->inner.params.loaderFlags&E_LOADER_PARAMETER_FLAGS::ELPF_RIGHT_HANDED_MESHES ? 1.f:-1.f, 1.f, 1.f, 0.f);
+	const bool hasColor = outHasColor;
+	std::for_each(core::execution::par, chunks.begin(), chunks.end(), [&](const uint32_t chunk) -> void
+	{
+		forEachTriangleInChunk(chunk, [&](const uint32_t triangle) -> void
+		{
+			// normal and 3 vertices
+			float record[12];
+			memcpy(record, records+size_t(triangle)*BinaryRecordSize, sizeof(record));
+			const core::vectorSIMDf n = core::vectorSIMDf(record[0], record[1], record[2], 0.f)*flip;
+			core::vectorSIMDf p[3];
+			for (uint32_t i = 0u; i < 3u; ++i)
+				p[i] = core::vectorSIMDf(record[3*i+3], record[3*i+4], record[3*i+5], 0.f)*flip;
+
+			const core::vectorSIMDf normal = (n == core::vectorSIMDf()).all() ? core::plane3dSIMDf(p[2], p[1], p[0]).getNormal():core::normalize(n);
+			const quant_normal_t quantNormal = quantNormalCache->quantize<EF_A2B10G10R10_SNORM_PACK32>(normal);
+
+			uint32_t color = 0u;
+			if (hasColor)
+			{
+				const uint16_t attrib = getAttribute(triangle);
+				const void* srcColor[1]{ &attrib };
+				convertColor<EF_A1R5G5B5_UNORM_PACK16, EF_B8G8R8A8_UNORM>(srcColor, &color, 0u, 0u);
+			}
+
+			uint8_t* ptr = vertices + size_t(triangle) * 3ull * vtxSize;
+			for (uint32_t i = 0u; i < 3u; ++i, ptr += vtxSize) // seems like in STL format vertices are ordered in clockwise manner...
+			{
+				memcpy(ptr, p[2u - i].pointer, 3 * 4);
+				memcpy(ptr + 12, &quantNormal, sizeof(quantNormal));
+				if (hasColor)
+					memcpy(ptr + 16, &color, 4);
+			}
+		});
+	});
+	return true;
+}
+
+core::smart_refctd_ptr<ICPUBuffer> CSTLMeshFileLoader::weldVertices(core::smart_refctd_ptr<ICPUBuffer>& vertices, const uint32_t vertexSize)
+{
+	const uint32_t vertexCount = vertices->getSize() / vertexSize;
+	const uint8_t* const src = reinterpret_cast<const uint8_t*>(vertices->getPointer());
+	auto getVertex = [src, vertexSize](const uint32_t vertex) -> std::string_view
+	{
+		return std::string_view(reinterpret_cast<const char*>(src) + size_t(vertex) * vertexSize, vertexSize);
+	};
+
+	// sorting by hash makes identical vertices neighbours, the second halves are the radix sort's scratch
+	core::vector<uint64_t> hashes(vertexCount * 2ull);
+	core::vector<uint32_t> order(vertexCount * 2ull);
+	std::iota(order.begin(), order.begin() + vertexCount, 0u);
+	std::for_each(core::execution::par_unseq, order.begin(), order.begin() + vertexCount, [&](const uint32_t vertex) -> void
+	{
+		hashes[vertex] = std::hash<std::string_view>()(getVertex(vertex));
+	});
+	const auto [sortedHashes, sortedOrder] = core::radix_sort_key_value(core::execution::par, hashes.begin(), hashes.begin() + vertexCount, order.begin(), order.begin() + vertexCount, vertexCount);
+
+	core::vector<uint32_t> runBegins;
+	for (uint32_t i = 0u; i < vertexCount; i++)
+	if (i == 0u || sortedHashes[i] != sortedHashes[i - 1u])
+		runBegins.push_back(i);
+	runBegins.push_back(vertexCount);
+
+	// every vertex maps to the first (lowest index) vertex equal to it, collisions just make longer runs
+	core::vector<uint32_t> representative(vertexCount);
+	std::for_each(core::execution::par, runBegins.begin(), runBegins.end() - 1, [&](const uint32_t& runBegin) -> void
+	{
+		const auto begin = sortedOrder + runBegin;
+		const auto end = sortedOrder + (&runBegin)[1];
+		std::sort(begin, end);
+		for (auto it = begin; it != end; it++)
+		{
+			auto found = begin;
+			while (getVertex(*found) != getVertex(*it))
+				found++;
+			representative[*it] = *found;
+		}
+	});
+
+	// `order` got scrambled by the sort, but the identity permutation is still needed for the parallel loops
+	std::iota(order.begin(), order.begin() + vertexCount, 0u);
+	core::vector<uint32_t> newIndices(vertexCount);
+	std::transform_exclusive_scan(core::execution::par, order.begin(), order.begin() + vertexCount, newIndices.begin(), 0u, std::plus<uint32_t>(), [&representative](const uint32_t vertex) -> uint32_t
+	{
+		return representative[vertex] == vertex ? 1u : 0u;
+	});
+	const uint32_t uniqueCount = vertexCount ? (newIndices.back() + (representative.back() == vertexCount - 1u ? 1u : 0u)) : 0u;
+
+	auto uniqueVertices = core::make_smart_refctd_ptr<ICPUBuffer>(size_t(uniqueCount) * vertexSize);
+	auto indices = core::make_smart_refctd_ptr<ICPUBuffer>(sizeof(uint32_t) * vertexCount);
+	uint8_t* const dst = reinterpret_cast<uint8_t*>(uniqueVertices->getPointer());
+	uint32_t* const indexData = reinterpret_cast<uint32_t*>(indices->getPointer());
+	std::for_each(core::execution::par_unseq, order.begin(), order.begin() + vertexCount, [&](const uint32_t vertex) -> void
+	{
+		const uint32_t newIndex = newIndices[representative[vertex]];
+		indexData[vertex] = newIndex;
+		if (representative[vertex] == vertex)
+			memcpy(dst + size_t(newIndex) * vertexSize, src + size_t(vertex) * vertexSize, vertexSize);
+	});
+
+	vertices = std::move(uniqueVertices);
+	return indices;
+}
+
 //! Read 3d vector of floats
 void CSTLMeshFileLoader::getNextVector(SContext* context, core::vectorSIMDf& vec, bool binary) const
 {
@@ -61,6 +61,15 @@ class CSTLMeshFileLoader final : public IRenderpassIndependentPipelineLoader
 		//! Read 3d vector of floats
 		void getNextVector(SContext* context, core::vectorSIMDf& vec, bool binary) const;
 
+		// binary STL is an 80 byte header, the triangle count and then fixed size records
+		static inline constexpr size_t BinaryHeaderSize = 84ull;
+		static inline constexpr size_t BinaryRecordSize = 50ull;
+		static inline constexpr uint32_t BinaryTrianglesPerChunk = 0x1u<<12u;
+		//! decodes all the records at once (straight from the mapping if there is one) in parallel chunks into an interleaved vertex buffer
+		bool loadBinary(SContext* context, core::smart_refctd_ptr<ICPUBuffer>& outVertices, bool& outHasColor) const;
+		//! merges bitwise identical vertices, returns the 32bit index buffer and replaces `vertices` with the unique ones
+		static core::smart_refctd_ptr<ICPUBuffer> weldVertices(core::smart_refctd_ptr<ICPUBuffer>& vertices, const uint32_t vertexSize);
+
 		template<typename aType>
 		static inline void performActionBasedOnOrientationSystem(aType& varToHandle, void (*performOnCertainOrientation)(aType& varToHandle))
 		{
@@ -8,6 +8,10 @@
 #include "CSTLMeshWriter.h"
 #include "SColor.h"
 
+#include "nbl/core/execution.h"
+
+#include <numeric>
+
 using namespace nbl;
 using namespace nbl::asset;
 
@@ -63,23 +67,29 @@ bool CSTLMeshWriter::writeAsset(system::IFile* _file, const SAssetWriteParams& _
 
 namespace
 {
+constexpr size_t STL_TRI_SZ = 50u;
+// 50MB of records get encoded in parallel before every write
+constexpr uint32_t TrianglesPerWrite = 0x1u<<20u;
+
+//! encodes triangles `[firstTriangle,firstTriangle+triangles.size())` of the buffer into consecutive 50 byte records, `triangles` is just an iota range to run the policy over
 template <class I>
-inline void writeFacesBinary(const asset::ICPUMeshBuffer* buffer, const bool& noIndices, system::IFile* file, uint32_t _colorVaid, IAssetWriter::SAssetWriteContext* context, size_t* fileOffset)
+inline void encodeFacesBinary(const asset::ICPUMeshBuffer* buffer, const bool& noIndices, uint32_t _colorVaid, const IAssetWriter::SAssetWriteContext* context, const uint32_t firstTriangle, const std::span<const uint32_t> triangles, uint8_t* out)
 {
 	auto& inputParams = buffer->getPipeline()->getCachedCreationParams().vertexInput;
 	bool hasColor = inputParams.enabledAttribFlags & core::createBitmask({ COLOR_ATTRIBUTE });
     const asset::E_FORMAT colorType = static_cast<asset::E_FORMAT>(hasColor ? inputParams.attributes[COLOR_ATTRIBUTE].format : asset::EF_UNKNOWN);
+	const bool rightHanded = context->params.flags & E_WRITER_FLAGS::EWF_MESH_IS_RIGHT_HANDED;
 
-    const uint32_t indexCount = buffer->getIndexCount();
-    for (uint32_t j = 0u; j < indexCount; j += 3u)
+    std::for_each(core::execution::par_unseq, triangles.begin(), triangles.end(), [&](const uint32_t& triangle) -> void
     {
+        const uint32_t j = (firstTriangle+triangle)*3u;
         I idx[3];
         for (uint32_t i = 0u; i < 3u; ++i)
         {
             if (noIndices)
                 idx[i] = j + i;
             else
-                idx[i] = ((I*)buffer->getIndices())[j + i];
+                idx[i] = ((const I*)buffer->getIndices())[j + i];
         }
 
         core::vectorSIMDf v[3];
@@ -91,7 +101,7 @@ inline void writeFacesBinary(const asset::ICPUMeshBuffer* buffer, const bool& no
         {
             if (asset::isIntegerFormat(colorType))
             {
-                uint32_t res[4];
+                uint32_t res[4] = {};
                 for (uint32_t i = 0u; i < 3u; ++i)
                 {
                     uint32_t d[4];
@@ -114,57 +124,21 @@ inline void writeFacesBinary(const asset::ICPUMeshBuffer* buffer, const bool& no
             }
         }
 
-		core::vectorSIMDf normal = core::plane3dSIMDf(v[0], v[1], v[2]).getNormal();
-		core::vectorSIMDf vertex1 = v[2];
-		core::vectorSIMDf vertex2 = v[1];
-		core::vectorSIMDf vertex3 = v[0];
-
-		auto flipVectors = [&]()
-		{
-			vertex1.X = -vertex1.X;
-			vertex2.X = -vertex2.X;
-			vertex3.X = -vertex3.X;
-			normal = core::plane3dSIMDf(vertex1, vertex2, vertex3).getNormal();
-		};
-
-		if (!(context->params.flags & E_WRITER_FLAGS::EWF_MESH_IS_RIGHT_HANDED))
-			flipVectors();
-
-		{
-			system::IFile::success_t success;;
-			file->write(success, &normal, *fileOffset, 12);
-	
-			*fileOffset += success.getBytesProcessed();
-		}
-
-		{
-			system::IFile::success_t success;;
-			file->write(success, &vertex1, *fileOffset, 12);
-	
-			*fileOffset += success.getBytesProcessed();
-		}
-
-		{
-			system::IFile::success_t success;;
-			file->write(success, &vertex2, *fileOffset, 12);
-	
-			*fileOffset += success.getBytesProcessed();
-		}
-
-		{
-			system::IFile::success_t success;;
-			file->write(success, &vertex3, *fileOffset, 12);
-	
-			*fileOffset += success.getBytesProcessed();
-		}
-
-		{
-			system::IFile::success_t success;;
-			file->write(success, &color, *fileOffset, 2); // saving color using non-standard VisCAM/SolidView trick
-	
-			*fileOffset += success.getBytesProcessed();
-		}
-    }
+		// reversed winding, and the X axis flipped unless the mesh is right handed already
+		const core::vectorSIMDf flip(rightHanded ? 1.f:-1.f, 1.f, 1.f, 1.f);
+		const core::vectorSIMDf vertex1 = v[2]*flip;
+		const core::vectorSIMDf vertex2 = v[1]*flip;
+		const core::vectorSIMDf vertex3 = v[0]*flip;
+		// mirroring flips the normal's X just like the positions'
+		const core::vectorSIMDf normal = core::plane3dSIMDf(v[0], v[1], v[2]).getNormal()*flip;
+
+		uint8_t* record = out + size_t(triangle)*STL_TRI_SZ;
+		memcpy(record, normal.pointer, 12);
+		memcpy(record + 12, vertex1.pointer, 12);
+		memcpy(record + 24, vertex2.pointer, 12);
+		memcpy(record + 36, vertex3.pointer, 12);
+		memcpy(record + 48, &color, 2); // saving color using non-standard VisCAM/SolidView trick
+    });
 }
 }
 
@@ -174,53 +148,31 @@ bool CSTLMeshWriter::writeMeshBinary(const asset::ICPUMesh* mesh, SContext* cont
     const char headerTxt[] = "Irrlicht-baw Engine";
     constexpr size_t HEADER_SIZE = 80u;
 
-	{
-		system::IFile::success_t success;;
-		context->writeContext.outputFile->write(success, headerTxt, context->fileOffset, sizeof(headerTxt));
-
-		context->fileOffset += success.getBytesProcessed();
-	}
+	uint8_t header[HEADER_SIZE + sizeof(uint32_t)] = {};
+	memcpy(header, headerTxt, sizeof(headerTxt));
 
 	const std::string name = context->writeContext.outputFile->getFileName().filename().replace_extension().string(); // TODO: check it
-	const int32_t sizeleft = HEADER_SIZE - sizeof(headerTxt) - name.size();
-
-	if (sizeleft < 0)
-	{
-		system::IFile::success_t success;;
-		context->writeContext.outputFile->write(success, name.c_str(), context->fileOffset, HEADER_SIZE - sizeof(headerTxt));
-
-		context->fileOffset += success.getBytesProcessed();
-	}
-	else
-	{
-		const char buf[80] = {0};
-
-		{
-			system::IFile::success_t success;;
-			context->writeContext.outputFile->write(success, name.c_str(), context->fileOffset, name.size());
-	
-			context->fileOffset += success.getBytesProcessed();
-		}
-
-		{
-			system::IFile::success_t success;;
-			context->writeContext.outputFile->write(success, buf, context->fileOffset, sizeleft);
-	
-			context->fileOffset += success.getBytesProcessed();
-		}
-	}
+	memcpy(header + sizeof(headerTxt), name.c_str(), core::min(name.size(), HEADER_SIZE - sizeof(headerTxt)));
 
 	uint32_t facenum = 0;
 	for (auto& mb : mesh->getMeshBuffers())
 		facenum += mb->getIndexCount()/3;
-	{
-		system::IFile::success_t success;;
-		context->writeContext.outputFile->write(success, &facenum, context->fileOffset, sizeof(facenum));
+	memcpy(header + HEADER_SIZE, &facenum, sizeof(facenum));
 
+	auto write = [context](const void* data, const size_t size) -> bool
+	{
+		system::IFile::success_t success;
+		context->writeContext.outputFile->write(success, data, context->fileOffset, size);
 		context->fileOffset += success.getBytesProcessed();
-	}
-	// write mesh buffers
+		return bool(success);
+	};
+	if (!write(header, sizeof(header)))
+		return false;
 
+	// write mesh buffers, every block of records gets encoded in parallel and written with one call
+	core::vector<uint32_t> triangles(core::min(facenum, TrianglesPerWrite));
+	std::iota(triangles.begin(), triangles.end(), 0u);
+	core::vector<uint8_t> records(triangles.size() * STL_TRI_SZ);
 	for (auto& buffer : mesh->getMeshBuffers())
 	if (buffer)
 	{
@@ -228,12 +180,19 @@ bool CSTLMeshWriter::writeMeshBinary(const asset::ICPUMesh* mesh, SContext* cont
 		if (!buffer->getIndexBufferBinding().buffer)
             type = asset::EIT_UNKNOWN;
 
-		if (type== asset::EIT_16BIT)
-            writeFacesBinary<uint16_t>(buffer, false, context->writeContext.outputFile, COLOR_ATTRIBUTE, &context->writeContext, &context->fileOffset);
-		else if (type== asset::EIT_32BIT)
-            writeFacesBinary<uint32_t>(buffer, false, context->writeContext.outputFile, COLOR_ATTRIBUTE, &context->writeContext, &context->fileOffset);
-		else
-            writeFacesBinary<uint16_t>(buffer, true, context->writeContext.outputFile, COLOR_ATTRIBUTE, &context->writeContext, &context->fileOffset); //template param doesn't matter if there's no indices
+		const uint32_t triangleCount = buffer->getIndexCount()/3u;
+		for (uint32_t first = 0u; first < triangleCount; first += TrianglesPerWrite)
+		{
+			const std::span<const uint32_t> block(triangles.data(), core::min(triangleCount - first, TrianglesPerWrite));
+			if (type== asset::EIT_16BIT)
+				encodeFacesBinary<uint16_t>(buffer, false, COLOR_ATTRIBUTE, &context->writeContext, first, block, records.data());
+			else if (type== asset::EIT_32BIT)
+				encodeFacesBinary<uint32_t>(buffer, false, COLOR_ATTRIBUTE, &context->writeContext, first, block, records.data());
+			else
+				encodeFacesBinary<uint32_t>(buffer, true, COLOR_ATTRIBUTE, &context->writeContext, first, block, records.data()); //template param doesn't matter if there's no indices
+			if (!write(records.data(), block.size() * STL_TRI_SZ))
+				return false;
+		}
 	}
 	return true;
 }
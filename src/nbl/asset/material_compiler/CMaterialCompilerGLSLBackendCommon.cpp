@@ -90,6 +90,235 @@ class CIdGenerator
 };
 
 
+// Merkle-style hash consing of IR subtrees, a node's hash covers its own parameters and the hashes of its children
+// so structurally identical BxDF trees (even if allocated as separate nodes) compare equal and can share instruction streams
+class CSubtreeHasher
+{
+	public:
+		size_t hash(const IR::INode* _node)
+		{
+			if (auto found = m_cache.find(_node); found != m_cache.end())
+				return found->second;
+
+			size_t retval = hashLocal(_node);
+			core::hash_combine(retval, _node->children.count);
+			for (const IR::INode* child : _node->children)
+				core::hash_combine(retval, hash(child));
+
+			m_cache.insert({ _node, retval });
+			return retval;
+		}
+
+		// full comparison, so hash collisions can never merge different materials
+		bool equal(const IR::INode* _lhs, const IR::INode* _rhs)
+		{
+			if (_lhs == _rhs)
+				return true;
+			if (hash(_lhs) != hash(_rhs) || !equalLocal(_lhs, _rhs) || _lhs->children.count != _rhs->children.count)
+				return false;
+			for (size_t i = 0ull; i < _lhs->children.count; ++i)
+				if (!equal(_lhs->children[i], _rhs->children[i]))
+					return false;
+			return true;
+		}
+
+	private:
+		static inline void hashColor(size_t& seed, const IR::INode::color_t& c)
+		{
+			for (uint32_t i = 0u; i < 3u; ++i)
+				core::hash_combine(seed, c[i]);
+		}
+		static inline void hashTexture(size_t& seed, const IR::INode::STextureSource& t)
+		{
+			core::hash_combine<const void*>(seed, t.image.get());
+			core::hash_combine<const void*>(seed, t.sampler.get());
+			core::hash_combine(seed, t.scale);
+		}
+		template <typename T>
+		static inline void hashParam(size_t& seed, const IR::INode::SParameter<T>& p)
+		{
+			core::hash_combine<uint32_t>(seed, p.source);
+			if (p.source == IR::INode::EPS_TEXTURE)
+				hashTexture(seed, p.value.texture);
+			else if constexpr (std::is_same_v<T,IR::INode::color_t>)
+				hashColor(seed, p.value.constant);
+			else
+				core::hash_combine(seed, p.value.constant);
+		}
+
+		static inline bool equalColor(const IR::INode::color_t& a, const IR::INode::color_t& b)
+		{
+			return a.x == b.x && a.y == b.y && a.z == b.z;
+		}
+		template <typename T>
+		static inline bool equalParam(const IR::INode::SParameter<T>& a, const IR::INode::SParameter<T>& b)
+		{
+			if (a.source != b.source)
+				return false;
+			if (a.source == IR::INode::EPS_TEXTURE)
+				return a.value.texture == b.value.texture;
+			if constexpr (std::is_same_v<T,IR::INode::color_t>)
+				return equalColor(a.value.constant, b.value.constant);
+			else
+				return a.value.constant == b.value.constant;
+		}
+
+		static size_t hashLocal(const IR::INode* _node)
+		{
+			size_t seed = 0ull;
+			core::hash_combine<uint32_t>(seed, _node->symbol);
+			switch (_node->symbol)
+			{
+			case IR::INode::ES_GEOM_MODIFIER:
+			{
+				auto* node = static_cast<const IR::CGeomModifierNode*>(_node);
+				core::hash_combine<uint32_t>(seed, node->type);
+				hashTexture(seed, node->texture);
+			}
+			break;
+			case IR::INode::ES_EMISSION:
+				hashColor(seed, static_cast<const IR::CEmissionNode*>(_node)->intensity);
+				break;
+			case IR::INode::ES_OPACITY:
+				hashParam(seed, static_cast<const IR::COpacityNode*>(_node)->opacity);
+				break;
+			case IR::INode::ES_BSDF_COMBINER:
+			{
+				auto* node = static_cast<const IR::CBSDFCombinerNode*>(_node);
+				core::hash_combine<uint32_t>(seed, node->type);
+				if (node->type == IR::CBSDFCombinerNode::ET_WEIGHT_BLEND)
+					hashParam(seed, static_cast<const IR::CBSDFBlendNode*>(node)->weight);
+				else if (node->type == IR::CBSDFCombinerNode::ET_MIX)
+				for (size_t i = 0ull; i < node->children.count; ++i)
+					core::hash_combine(seed, static_cast<const IR::CBSDFMixNode*>(node)->weights[i]);
+			}
+			break;
+			case IR::INode::ES_BSDF:
+			{
+				auto* node = static_cast<const IR::CBSDFNode*>(_node);
+				core::hash_combine<uint32_t>(seed, node->type);
+				hashColor(seed, node->eta);
+				hashColor(seed, node->etaK);
+				switch (node->type)
+				{
+				case IR::CBSDFNode::ET_MICROFACET_DIFFTRANS:
+				{
+					auto* n = static_cast<const IR::CMicrofacetDifftransBSDFNode*>(node);
+					hashParam(seed, n->alpha_u);
+					hashParam(seed, n->alpha_v);
+					hashParam(seed, n->transmittance);
+				}
+				break;
+				case IR::CBSDFNode::ET_MICROFACET_DIFFUSE:
+				{
+					auto* n = static_cast<const IR::CMicrofacetDiffuseBSDFNode*>(node);
+					hashParam(seed, n->alpha_u);
+					hashParam(seed, n->alpha_v);
+					hashParam(seed, n->reflectance);
+				}
+				break;
+				case IR::CBSDFNode::ET_MICROFACET_SPECULAR: [[fallthrough]];
+				case IR::CBSDFNode::ET_MICROFACET_COATING: [[fallthrough]];
+				case IR::CBSDFNode::ET_MICROFACET_DIELECTRIC:
+				{
+					auto* n = static_cast<const IR::CMicrofacetSpecularBSDFNode*>(node);
+					core::hash_combine<uint32_t>(seed, n->ndf);
+					core::hash_combine<uint32_t>(seed, n->shadowing);
+					hashParam(seed, n->alpha_u);
+					hashParam(seed, n->alpha_v);
+					if (node->type == IR::CBSDFNode::ET_MICROFACET_COATING)
+						hashParam(seed, static_cast<const IR::CMicrofacetCoatingBSDFNode*>(node)->thicknessSigmaA);
+					else if (node->type == IR::CBSDFNode::ET_MICROFACET_DIELECTRIC)
+						core::hash_combine(seed, static_cast<const IR::CMicrofacetDielectricBSDFNode*>(node)->thin);
+				}
+				break;
+				default:
+					break;
+				}
+			}
+			break;
+			}
+			return seed;
+		}
+
+		static bool equalLocal(const IR::INode* _lhs, const IR::INode* _rhs)
+		{
+			if (_lhs->symbol != _rhs->symbol)
+				return false;
+			switch (_lhs->symbol)
+			{
+			case IR::INode::ES_GEOM_MODIFIER:
+			{
+				auto* a = static_cast<const IR::CGeomModifierNode*>(_lhs);
+				auto* b = static_cast<const IR::CGeomModifierNode*>(_rhs);
+				return a->type == b->type && a->texture == b->texture;
+			}
+			case IR::INode::ES_EMISSION:
+				return equalColor(static_cast<const IR::CEmissionNode*>(_lhs)->intensity, static_cast<const IR::CEmissionNode*>(_rhs)->intensity);
+			case IR::INode::ES_OPACITY:
+				return equalParam(static_cast<const IR::COpacityNode*>(_lhs)->opacity, static_cast<const IR::COpacityNode*>(_rhs)->opacity);
+			case IR::INode::ES_BSDF_COMBINER:
+			{
+				auto* a = static_cast<const IR::CBSDFCombinerNode*>(_lhs);
+				auto* b = static_cast<const IR::CBSDFCombinerNode*>(_rhs);
+				if (a->type != b->type)
+					return false;
+				if (a->type == IR::CBSDFCombinerNode::ET_WEIGHT_BLEND)
+					return equalParam(static_cast<const IR::CBSDFBlendNode*>(a)->weight, static_cast<const IR::CBSDFBlendNode*>(b)->weight);
+				else if (a->type == IR::CBSDFCombinerNode::ET_MIX)
+				{
+					if (a->children.count != b->children.count)
+						return false;
+					return std::equal(static_cast<const IR::CBSDFMixNode*>(a)->weights, static_cast<const IR::CBSDFMixNode*>(a)->weights+a->children.count, static_cast<const IR::CBSDFMixNode*>(b)->weights);
+				}
+				return true;
+			}
+			case IR::INode::ES_BSDF:
+			{
+				auto* a = static_cast<const IR::CBSDFNode*>(_lhs);
+				auto* b = static_cast<const IR::CBSDFNode*>(_rhs);
+				if (a->type != b->type || !equalColor(a->eta, b->eta) || !equalColor(a->etaK, b->etaK))
+					return false;
+				switch (a->type)
+				{
+				case IR::CBSDFNode::ET_MICROFACET_DIFFTRANS:
+				{
+					auto* na = static_cast<const IR::CMicrofacetDifftransBSDFNode*>(a);
+					auto* nb = static_cast<const IR::CMicrofacetDifftransBSDFNode*>(b);
+					return equalParam(na->alpha_u, nb->alpha_u) && equalParam(na->alpha_v, nb->alpha_v) && equalParam(na->transmittance, nb->transmittance);
+				}
+				case IR::CBSDFNode::ET_MICROFACET_DIFFUSE:
+				{
+					auto* na = static_cast<const IR::CMicrofacetDiffuseBSDFNode*>(a);
+					auto* nb = static_cast<const IR::CMicrofacetDiffuseBSDFNode*>(b);
+					return equalParam(na->alpha_u, nb->alpha_u) && equalParam(na->alpha_v, nb->alpha_v) && equalParam(na->reflectance, nb->reflectance);
+				}
+				case IR::CBSDFNode::ET_MICROFACET_SPECULAR: [[fallthrough]];
+				case IR::CBSDFNode::ET_MICROFACET_COATING: [[fallthrough]];
+				case IR::CBSDFNode::ET_MICROFACET_DIELECTRIC:
+				{
+					auto* na = static_cast<const IR::CMicrofacetSpecularBSDFNode*>(a);
+					auto* nb = static_cast<const IR::CMicrofacetSpecularBSDFNode*>(b);
+					if (na->ndf != nb->ndf || na->shadowing != nb->shadowing || !equalParam(na->alpha_u, nb->alpha_u) || !equalParam(na->alpha_v, nb->alpha_v))
+						return false;
+					if (a->type == IR::CBSDFNode::ET_MICROFACET_COATING)
+						return equalParam(static_cast<const IR::CMicrofacetCoatingBSDFNode*>(a)->thicknessSigmaA, static_cast<const IR::CMicrofacetCoatingBSDFNode*>(b)->thicknessSigmaA);
+					else if (a->type == IR::CBSDFNode::ET_MICROFACET_DIELECTRIC)
+						return static_cast<const IR::CMicrofacetDielectricBSDFNode*>(a)->thin == static_cast<const IR::CMicrofacetDielectricBSDFNode*>(b)->thin;
+					return true;
+				}
+				default:
+					return true;
+				}
+			}
+			}
+			return false;
+		}
+
+		core::unordered_map<const IR::INode*, size_t> m_cache;
+};
+
+
 // base class for the many traversals:
 // - texture prefetch
 // - normal precompute
@@ -1206,9 +1435,30 @@ auto CMaterialCompilerGLSLBackendCommon::compile(SContext* _ctx, IR* _ir, E_GENE
 	res.noPrefetchStream = true;
 	res.usedRegisterCount = 0u;
 	res.globalPrefetchRegCountFlags = 0u;
+	res.dedupStats = {};
 
+	// roots which are structurally identical to an already compiled one just point at its streams
+	CSubtreeHasher hasher;
+	core::unordered_multimap<size_t, const IR::INode*> compiledRoots;
 	for (const IR::INode* root : _ir->roots)
 	{
+		res.dedupStats.rootCount++;
+		{
+			const size_t rootHash = hasher.hash(root);
+			auto candidates = compiledRoots.equal_range(rootHash);
+			auto found = std::find_if(candidates.first, candidates.second, [&hasher,root](const auto& item) { return hasher.equal(item.second, root); });
+			if (found != candidates.second)
+			{
+				const result_t::instr_streams_t streams = res.streams[found->second];
+				res.streams.insert({root,streams});
+				res.dedupStats.dedupedRootCount++;
+				res.dedupStats.instructionsSaved += streams.rem_and_pdf_count+streams.gen_choice_count+streams.norm_precomp_count;
+				res.dedupStats.prefetchInstructionsSaved += streams.tex_prefetch_count;
+				continue;
+			}
+			compiledRoots.insert({rootHash,root});
+		}
+
 		uint32_t remainingRegisters = instr_stream::MAX_REGISTER_COUNT;
 
 		const size_t interm_bsdf_data_begin_ix = _ctx->bsdfData.size();
@@ -4,10 +4,13 @@
 
 #include "nbl/asset/utils/CSPIRVIntrospector.h"
 #include "nbl/asset/utils/spvUtils.h"
+#include "nbl/asset/CVectorCPUBuffer.h"
 
 #include "nbl_spirv_cross/spirv_parser.hpp"
 #include "nbl_spirv_cross/spirv_cross.hpp"
 
+#include <bit>
+
 namespace nbl::asset
 {
 
@@ -284,7 +287,7 @@ NBL_API2 bool CSPIRVIntrospector::CPipelineIntrospectionData::merge(const CSPIRV
         };
 
         // iterate over all bytes used
-        const IShader::E_SHADER_STAGE shaderStage = stageData->getParams().shader->getStage();
+        const IShader::E_SHADER_STAGE shaderStage = stageData->getShaderStage();
         for (auto it = pcRangesSpan.begin(); it != pcRangesSpan.end(); ++it)
             *it |= shaderStage;
     }
@@ -893,6 +896,380 @@ void CSPIRVIntrospector::CStageIntrospectionData::finalize(const IShader::E_SHAD
     }
 }
 
+namespace
+{
+    struct SSerializedWriter
+    {
+        template<typename T>
+        inline void write(const T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            writeBytes(&value,sizeof(T));
+        }
+        inline void writeBytes(const void* data, const size_t size)
+        {
+            const auto oldSize = out.size();
+            out.resize(oldSize+size);
+            if (size)
+                memcpy(out.data()+oldSize,data,size);
+        }
+        template<typename T>
+        inline void writeArray(const T* data, const size_t count)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            write<uint64_t>(count);
+            writeBytes(data,sizeof(T)*count);
+        }
+
+        core::vector<uint8_t>& out;
+    };
+    struct SSerializedReader
+    {
+        template<typename T>
+        inline bool read(T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            return readBytes(&value,sizeof(T));
+        }
+        inline bool readBytes(void* data, const size_t size)
+        {
+            if (in.size()<size)
+                return false;
+            if (size)
+                memcpy(data,in.data(),size);
+            in = in.subspan(size);
+            return true;
+        }
+        template<typename T, class Container>
+        inline bool readArray(Container& container)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            uint64_t count;
+            if (!read(count) || count>in.size()/core::max<size_t>(sizeof(T),1ull))
+                return false;
+            if constexpr (std::is_default_constructible_v<T>)
+            {
+                container.resize(count);
+                return readBytes(container.data(),sizeof(T)*count);
+            }
+            else
+            {
+                // descriptor infos have unions of members with default initializers, so can only be copied in
+                container.reserve(count);
+                for (uint64_t i=0ull; i<count; i++)
+                {
+                    std::array<uint8_t,sizeof(T)> raw;
+                    if (!readBytes(raw.data(),sizeof(T)))
+                        return false;
+                    container.push_back(std::bit_cast<T>(raw));
+                }
+                return true;
+            }
+        }
+
+        std::span<const uint8_t>& in;
+    };
+}
+
+void CSPIRVIntrospector::CStageIntrospectionData::serialize(core::vector<uint8_t>& out) const
+{
+    const auto* const basePtr = reinterpret_cast<const uint8_t*>(m_memPool.data());
+    // the serialized form is exactly the mutable form `finalize` starts from
+    auto toBased = [basePtr]<typename T>(const T* ptr) -> core::based_offset<T>
+    {
+        if (!ptr)
+            return {};
+        return {size_t(reinterpret_cast<const uint8_t*>(ptr)-basePtr)};
+    };
+    auto spanToBased = [&toBased]<typename T>(std::span<const T>& field) -> void
+    {
+        const core::based_span<const T> based(field.empty() ? 0ull:toBased(field.data()).byte_offset(),field.size());
+        reinterpret_cast<core::based_span<const T>&>(field) = based;
+    };
+    auto ptrToBased = [&toBased]<typename T>(const T*& field) -> void
+    {
+        reinterpret_cast<core::based_offset<T>&>(field) = toBased(field);
+    };
+
+    // types only live in the pool, so patch the copy of the pool at the same offsets as the live fields
+    core::vector<char> pool(m_memPool);
+    auto poolCopyOf = [&pool,basePtr]<typename T>(const T* live) -> T*
+    {
+        return reinterpret_cast<T*>(pool.data()+(reinterpret_cast<const uint8_t*>(live)-basePtr));
+    };
+    auto rebaseBlock = [&](const SMemoryBlock<false>& block) -> void
+    {
+        core::stack<const SType<false>*> stk;
+        if (block.type)
+            stk.push(block.type);
+        while (!stk.empty())
+        {
+            const SType<false>* type = stk.top();
+            stk.pop();
+            for (auto m=0u; m<type->memberCount; m++)
+                stk.push(type->memberTypes()[m]);
+
+            auto* outType = poolCopyOf(type);
+            spanToBased(outType->typeName);
+            spanToBased(outType->count);
+            auto* outMemberTypes = poolCopyOf(type->memberTypes());
+            auto* outMemberNames = poolCopyOf(type->memberNames());
+            for (auto m=0u; m<type->memberCount; m++)
+            {
+                ptrToBased(const_cast<const SType<false>*&>(outMemberTypes[m]));
+                spanToBased(const_cast<std::span<const char>&>(outMemberNames[m]));
+            }
+            ptrToBased(outType->memberInfoStorage);
+        }
+    };
+
+    SSerializedWriter writer = {out};
+    writer.write<uint32_t>(static_cast<uint32_t>(m_shaderStage));
+    {
+        core::vector<SSpecConstant<>> specConstants(m_specConstants.begin(),m_specConstants.end());
+        for (auto& specConstant : specConstants)
+            spanToBased(specConstant.name);
+        writer.writeArray(specConstants.data(),specConstants.size());
+    }
+    {
+        core::vector<SInputInterface> inputs(m_input.begin(),m_input.end());
+        writer.writeArray(inputs.data(),inputs.size());
+    }
+    if (m_shaderStage==IShader::E_SHADER_STAGE::ESS_FRAGMENT)
+    {
+        const auto& outputs = std::get<core::vector<SFragmentOutputInterface>>(m_output);
+        writer.writeArray(outputs.data(),outputs.size());
+    }
+    else
+    {
+        const auto& outputs = std::get<core::vector<SOutputInterface>>(m_output);
+        writer.writeArray(outputs.data(),outputs.size());
+    }
+    {
+        auto pushConstants = m_pushConstants;
+        rebaseBlock(m_pushConstants);
+        ptrToBased(pushConstants.type);
+        spanToBased(pushConstants.name);
+        writer.write(pushConstants);
+    }
+    for (auto set=0; set<DESCRIPTOR_SET_COUNT; set++)
+    {
+        auto descriptors = m_descriptorSetBindings[set];
+        for (auto& descriptor : descriptors)
+        {
+            spanToBased(descriptor.name);
+            switch (descriptor.type)
+            {
+                case IDescriptor::E_TYPE::ET_UNIFORM_BUFFER:
+                    rebaseBlock(descriptor.uniformBuffer);
+                    ptrToBased(descriptor.uniformBuffer.type);
+                    break;
+                case IDescriptor::E_TYPE::ET_STORAGE_BUFFER:
+                    rebaseBlock(descriptor.storageBuffer);
+                    ptrToBased(descriptor.storageBuffer.type);
+                    break;
+                default:
+                    break;
+            }
+        }
+        writer.writeArray(descriptors.data(),descriptors.size());
+    }
+    writer.writeArray(pool.data(),pool.size());
+}
+
+bool CSPIRVIntrospector::CStageIntrospectionData::deserialize(std::span<const uint8_t>& in)
+{
+    SSerializedReader reader = {in};
+    uint32_t stage;
+    if (!reader.read(stage))
+        return false;
+    m_shaderStage = static_cast<IShader::E_SHADER_STAGE>(stage);
+    {
+        core::vector<SSpecConstant<>> specConstants;
+        if (!reader.readArray<SSpecConstant<>>(specConstants))
+            return false;
+        m_specConstants.insert(specConstants.begin(),specConstants.end());
+    }
+    {
+        core::vector<SInputInterface> inputs;
+        if (!reader.readArray<SInputInterface>(inputs))
+            return false;
+        m_input.insert(inputs.begin(),inputs.end());
+    }
+    if (m_shaderStage==IShader::E_SHADER_STAGE::ESS_FRAGMENT)
+    {
+        m_output = core::vector<SFragmentOutputInterface>();
+        if (!reader.readArray<SFragmentOutputInterface>(std::get<core::vector<SFragmentOutputInterface>>(m_output)))
+            return false;
+    }
+    else
+    {
+        m_output = core::vector<SOutputInterface>();
+        if (!reader.readArray<SOutputInterface>(std::get<core::vector<SOutputInterface>>(m_output)))
+            return false;
+    }
+    if (!reader.read(m_pushConstants))
+        return false;
+    for (auto set=0; set<DESCRIPTOR_SET_COUNT; set++)
+    if (!reader.readArray<SDescriptorVarInfo<>>(m_descriptorSetBindings[set]))
+        return false;
+    if (!reader.readArray<char>(m_memPool))
+        return false;
+
+    if (!validateBasedOffsets())
+        return false;
+    finalize(m_shaderStage);
+    return true;
+}
+
+bool CSPIRVIntrospector::CStageIntrospectionData::validateBasedOffsets()
+{
+    auto* const basePtr = m_memPool.data();
+    const size_t poolSize = m_memPool.size();
+    auto inPool = [poolSize](const size_t byteOffset, const size_t count, const size_t stride) -> bool
+    {
+        return byteOffset<=poolSize && count<=(poolSize-byteOffset)/stride;
+    };
+    auto validSpan = [&inPool]<typename T>(const core::based_span<T>& span) -> bool
+    {
+        return span.empty() || inPool(span.byte_offset(),span.size(),sizeof(T));
+    };
+    auto validString = [&validSpan](const std::span<const char>& name) -> bool
+    {
+        return validSpan(reinterpret_cast<const core::based_span<const char>&>(name));
+    };
+
+    // `finalize` patches types in-place, a type reachable twice (or through a cycle) would get patched twice
+    core::unordered_set<size_t> visitedTypes;
+    auto validBlock = [&](const SMemoryBlock<true>& block) -> bool
+    {
+        core::stack<core::based_offset<SType<true>>> stk;
+        if (block.type)
+            stk.push(block.type);
+        while (!stk.empty())
+        {
+            const size_t typeOffset = stk.top().byte_offset();
+            stk.pop();
+            if (!inPool(typeOffset,1ull,sizeof(SType<true>)) || !visitedTypes.insert(typeOffset).second)
+                return false;
+
+            const auto* type = reinterpret_cast<const SType<true>*>(basePtr+typeOffset);
+            if (!validSpan(type->typeName) || !validSpan(type->count))
+                return false;
+            if (type->memberCount==0u)
+                continue;
+            if (!inPool(type->memberInfoStorage.byte_offset(),type->memberCount,SType<true>::StoragePerMember))
+                return false;
+            const auto* memberTypes = type->memberTypes()(basePtr);
+            const auto* memberNames = type->memberNames()(basePtr);
+            for (auto m=0u; m<type->memberCount; m++)
+            {
+                if (!validSpan(memberNames[m]))
+                    return false;
+                if (memberTypes[m])
+                    stk.push(memberTypes[m]);
+            }
+        }
+        return true;
+    };
+
+    for (const auto& specConstant : m_specConstants)
+    if (!validString(specConstant.name))
+        return false;
+    if (!validString(m_pushConstants.name) || !validBlock(reinterpret_cast<const SPushConstantInfo<true>&>(m_pushConstants)))
+        return false;
+    for (auto set=0; set<DESCRIPTOR_SET_COUNT; set++)
+    for (const auto& descriptor : m_descriptorSetBindings[set])
+    {
+        if (!validString(descriptor.name))
+            return false;
+        const auto& asMutable = reinterpret_cast<const SDescriptorVarInfo<true>&>(descriptor);
+        switch (descriptor.type)
+        {
+            case IDescriptor::E_TYPE::ET_UNIFORM_BUFFER:
+                if (!validBlock(asMutable.uniformBuffer))
+                    return false;
+                break;
+            case IDescriptor::E_TYPE::ET_STORAGE_BUFFER:
+                if (!validBlock(asMutable.storageBuffer))
+                    return false;
+                break;
+            default:
+                break;
+        }
+    }
+    return true;
+}
+
+core::blake3_hash_t CSPIRVIntrospector::getSPIRVContentHash(const ICPUShader* shader)
+{
+    const ICPUBuffer* code = shader->getContent();
+    // an untouched `IPreHashed` holds the hash of an empty array
+    static const auto NoHash = static_cast<core::blake3_hash_t>(core::blake3_hasher{});
+    const auto& hash = code->getContentHash();
+    if (hash!=NoHash || code->getSize()==0ull)
+        return hash;
+
+    // stored on the buffer like a loader would have, so the next introspection of it doesn't hash again, immutable buffers get hashed every time
+    const auto computed = code->computeContentHash();
+    const_cast<ICPUBuffer*>(code)->setContentHash(computed);
+    return computed;
+}
+
+core::smart_refctd_ptr<ICPUBuffer> CSPIRVIntrospector::serializeCache() const
+{
+    core::vector<uint8_t> retVal;
+    SSerializedWriter writer = {retVal};
+    writer.write(SerializedCacheMagic);
+    writer.write(SerializedCacheVersion);
+    {
+        auto lk = system::read_lock_guard<>(m_cacheLock);
+        writer.write<uint64_t>(m_introspectionCache.size());
+        for (const auto& [key,data] : m_introspectionCache)
+        {
+            writer.write(key.contentHash);
+            writer.writeArray(key.entryPoint.data(),key.entryPoint.size());
+            writer.write<uint32_t>(static_cast<uint32_t>(key.stage));
+            data->serialize(retVal);
+        }
+    }
+    return core::make_smart_refctd_ptr<CVectorCPUBuffer<uint8_t,nbl::core::aligned_allocator<uint8_t>>>(std::move(retVal));
+}
+
+bool CSPIRVIntrospector::deserializeCache(const std::span<const uint8_t> serializedCache)
+{
+    std::span<const uint8_t> in = serializedCache;
+    SSerializedReader reader = {in};
+    uint32_t magic, version;
+    if (!reader.read(magic) || magic!=SerializedCacheMagic || !reader.read(version) || version!=SerializedCacheVersion)
+        return false;
+    uint64_t entryCount;
+    if (!reader.read(entryCount))
+        return false;
+
+    // parse everything first, a truncated blob shouldn't leave a half-filled cache behind
+    core::vector<std::pair<SCacheKey,core::smart_refctd_ptr<const CStageIntrospectionData>>> entries;
+    for (uint64_t i=0ull; i<entryCount; i++)
+    {
+        SCacheKey key;
+        uint32_t stage;
+        if (!reader.read(key.contentHash) || !reader.readArray<char>(key.entryPoint) || !reader.read(stage))
+            return false;
+        key.stage = static_cast<IShader::E_SHADER_STAGE>(stage);
+
+        auto data = core::make_smart_refctd_ptr<CStageIntrospectionData>();
+        data->m_params.entryPoint = key.entryPoint;
+        if (!data->deserialize(in) || data->m_shaderStage!=key.stage)
+            return false;
+        entries.emplace_back(std::move(key),std::move(data));
+    }
+
+    auto lk = system::write_lock_guard<>(m_cacheLock);
+    for (auto& entry : entries)
+        m_introspectionCache.insert(std::move(entry));
+    return true;
+}
+
 void CSPIRVIntrospector::CStageIntrospectionData::printExtents(std::ostringstream& out, const SArrayInfo& count)
 {
     out << "[";
@@ -4,12 +4,13 @@
 #include "nbl/core/declarations.h"
 #include "nbl/core/IReferenceCounted.h"
 #include "nbl/system/ILogger.h"
+#include "nbl/asset/CVectorCPUBuffer.h"
 
 using namespace nbl::asset;
 
 static constexpr spv_target_env SPIRV_VERSION = spv_target_env::SPV_ENV_UNIVERSAL_1_5;
 
-nbl::core::smart_refctd_ptr<ICPUBuffer> ISPIRVOptimizer::optimize(const uint32_t* _spirv, uint32_t _dwordCount, system::logger_opt_ptr logger) const
+static spvtools::Optimizer::PassToken createPass(const ISPIRVOptimizer::E_OPTIMIZER_PASS pass)
 {
     //https://www.lunarg.com/wp-content/uploads/2020/05/SPIR-V-Shader-Legalization-and-Size-Reduction-Using-spirv-opt_v1.2.pdf
 
@@ -21,8 +22,13 @@ nbl::core::smart_refctd_ptr<ICPUBuffer> ISPIRVOptimizer::optimize(const uint32_t
         return spvtools::CreateReduceLoadSizePass();
     };
 
+    // ADCE stays disabled, but needs an entry so the table lines up with `E_OPTIMIZER_PASS`
+    auto CreateDisabledAggressiveDCEPass = [] {
+        return spvtools::CreateNullPass();
+    };
+
     using create_pass_f_t = spvtools::Optimizer::PassToken(*)();
-    create_pass_f_t create_pass_f[EOP_COUNT]{
+    create_pass_f_t create_pass_f[ISPIRVOptimizer::EOP_COUNT]{
         &spvtools::CreateMergeReturnPass,
         &spvtools::CreateInlineExhaustivePass,
         &spvtools::CreateEliminateDeadFunctionsPass,
@@ -32,7 +38,7 @@ nbl::core::smart_refctd_ptr<ICPUBuffer> ISPIRVOptimizer::optimize(const uint32_t
         &spvtools::CreateSimplificationPass,
         &spvtools::CreateVectorDCEPass,
         &spvtools::CreateDeadInsertElimPass,
-        //&spvtools::CreateAggressiveDCEPass,
+        CreateDisabledAggressiveDCEPass, //&spvtools::CreateAggressiveDCEPass,
         &spvtools::CreateDeadBranchElimPass,
         &spvtools::CreateBlockMergePass,
         &spvtools::CreateLocalMultiStoreElimPass,
@@ -44,9 +50,15 @@ nbl::core::smart_refctd_ptr<ICPUBuffer> ISPIRVOptimizer::optimize(const uint32_t
         &spvtools::CreateIfConversionPass
     };
 
-    auto msgConsumer = [&logger](spv_message_level_t level, const char* src, const spv_position_t& pos, const char* msg)
+    return create_pass_f[pass]();
+}
+
+static spvtools::MessageConsumer createMessageConsumer(nbl::system::logger_opt_ptr logger)
+{
+    return [logger](spv_message_level_t level, const char* src, const spv_position_t& pos, const char* msg)
     {
         using namespace std::string_literals;
+        using namespace nbl;
 
 
         constexpr static system::ILogger::E_LOG_LEVEL lvl2lvl[6]{
@@ -62,25 +74,184 @@ nbl::core::smart_refctd_ptr<ICPUBuffer> ISPIRVOptimizer::optimize(const uint32_t
 
         logger.log(location, lvl, msg);
     };
+}
+
+static nbl::core::smart_refctd_ptr<ICPUBuffer> createBufferFromDwords(const uint32_t* dwords, const size_t dwordCount)
+{
+    const size_t resultBytesize = dwordCount * sizeof(uint32_t);
+    if (!resultBytesize)
+        return nullptr;
 
-    spvtools::Optimizer opt(SPIRV_VERSION);
+    auto result = nbl::core::make_smart_refctd_ptr<ICPUBuffer>(resultBytesize);
+    memcpy(result->getPointer(), dwords, resultBytesize);
+
+    return result;
+}
 
-    for (E_OPTIMIZER_PASS pass : m_passes)
-        opt.RegisterPass(create_pass_f[pass]());
 
-    opt.SetMessageConsumer(msgConsumer);
+nbl::core::smart_refctd_ptr<ICPUBuffer> ISPIRVOptimizer::CCache::find(const SKey& key) const
+{
+    auto lk = system::read_lock_guard<>(m_lock);
+    auto found = m_container.find(key);
+    if (found == m_container.end())
+        return nullptr;
+    return createBufferFromDwords(found->second.data(), found->second.size());
+}
+
+void ISPIRVOptimizer::CCache::insert(SKey&& key, const std::span<const uint32_t> optimized)
+{
+    core::vector<uint32_t> value(optimized.begin(), optimized.end());
+    auto lk = system::write_lock_guard<>(m_lock);
+    m_container.insert_or_assign(std::move(key), std::move(value));
+}
+
+// Layout: MAGIC, VERSION, entry count, then per entry the input hash, target env, pass count, passes, dword count and the optimized dwords
+nbl::core::smart_refctd_ptr<ICPUBuffer> ISPIRVOptimizer::CCache::serialize() const
+{
+    core::vector<uint8_t> retVal;
+    auto write = [&retVal](const void* data, const size_t size) -> void
+    {
+        const auto oldSize = retVal.size();
+        retVal.resize(oldSize + size);
+        if (size)
+            memcpy(retVal.data() + oldSize, data, size);
+    };
+
+    auto lk = system::read_lock_guard<>(m_lock);
+    const uint64_t entryCount = m_container.size();
+    write(&MAGIC, sizeof(MAGIC));
+    write(&VERSION, sizeof(VERSION));
+    write(&entryCount, sizeof(entryCount));
+    for (const auto& [key, dwords] : m_container)
+    {
+        write(&key.inputHash, sizeof(key.inputHash));
+        write(&key.targetEnv, sizeof(key.targetEnv));
+        const uint32_t passCount = key.passes.size();
+        write(&passCount, sizeof(passCount));
+        for (const auto pass : key.passes)
+        {
+            const uint32_t passID = pass;
+            write(&passID, sizeof(passID));
+        }
+        const uint64_t dwordCount = dwords.size();
+        write(&dwordCount, sizeof(dwordCount));
+        write(dwords.data(), dwords.size() * sizeof(uint32_t));
+    }
+
+    return core::make_smart_refctd_ptr<CVectorCPUBuffer<uint8_t, nbl::core::aligned_allocator<uint8_t>>>(std::move(retVal));
+}
+
+nbl::core::smart_refctd_ptr<ISPIRVOptimizer::CCache> ISPIRVOptimizer::CCache::deserialize(const std::span<const uint8_t> serializedCache)
+{
+    std::span<const uint8_t> in = serializedCache;
+    auto read = [&in](void* data, const size_t size) -> bool
+    {
+        if (in.size() < size)
+            return false;
+        if (size)
+            memcpy(data, in.data(), size);
+        in = in.subspan(size);
+        return true;
+    };
+
+    uint32_t magic, version;
+    uint64_t entryCount;
+    if (!read(&magic, sizeof(magic)) || magic != MAGIC || !read(&version, sizeof(version)) || version != VERSION || !read(&entryCount, sizeof(entryCount)))
+        return nullptr;
+
+    auto retVal = core::make_smart_refctd_ptr<CCache>();
+    for (uint64_t i = 0u; i < entryCount; i++)
+    {
+        SKey key;
+        uint32_t passCount;
+        if (!read(&key.inputHash, sizeof(key.inputHash)) || !read(&key.targetEnv, sizeof(key.targetEnv)) || !read(&passCount, sizeof(passCount)))
+            return nullptr;
+        if (passCount > in.size() / sizeof(uint32_t))
+            return nullptr;
+        key.passes.resize(passCount);
+        for (auto& pass : key.passes)
+        {
+            uint32_t passID;
+            if (!read(&passID, sizeof(passID)) || passID >= EOP_COUNT)
+                return nullptr;
+            pass = static_cast<E_OPTIMIZER_PASS>(passID);
+        }
+        uint64_t dwordCount;
+        if (!read(&dwordCount, sizeof(dwordCount)) || dwordCount > in.size() / sizeof(uint32_t))
+            return nullptr;
+        core::vector<uint32_t> dwords(dwordCount);
+        read(dwords.data(), dwordCount * sizeof(uint32_t));
+        retVal->m_container.emplace(std::move(key), std::move(dwords));
+    }
+
+    return retVal;
+}
 
+
+ISPIRVOptimizer::ISPIRVOptimizer(std::initializer_list<E_OPTIMIZER_PASS> _passes, core::smart_refctd_ptr<CCache>&& _cache) : m_passes(std::move(_passes)), m_cache(std::move(_cache)) {}
+
+ISPIRVOptimizer::~ISPIRVOptimizer() = default;
+
+std::unique_ptr<spvtools::Optimizer> ISPIRVOptimizer::acquireOptimizer(system::logger_opt_ptr& logger) const
+{
+    std::unique_ptr<spvtools::Optimizer> opt;
+    {
+        std::unique_lock lk(m_optimizerPoolMutex);
+        if (!m_optimizerPool.empty())
+        {
+            opt = std::move(m_optimizerPool.back());
+            m_optimizerPool.pop_back();
+        }
+    }
+    if (!opt)
+    {
+        opt = std::make_unique<spvtools::Optimizer>(SPIRV_VERSION);
+        for (E_OPTIMIZER_PASS pass : m_passes)
+            opt->RegisterPass(createPass(pass));
+    }
+    // the logger can differ between calls
+    opt->SetMessageConsumer(createMessageConsumer(logger));
+    return opt;
+}
+
+void ISPIRVOptimizer::releaseOptimizer(std::unique_ptr<spvtools::Optimizer>&& optimizer) const
+{
+    std::unique_lock lk(m_optimizerPoolMutex);
+    m_optimizerPool.push_back(std::move(optimizer));
+}
+
+nbl::core::smart_refctd_ptr<ICPUBuffer> ISPIRVOptimizer::optimize_impl(const uint32_t* _spirv, uint32_t _dwordCount, const core::blake3_hash_t* inputHash, system::logger_opt_ptr logger) const
+{
+    CCache::SKey key;
+    if (m_cache)
+    {
+        if (inputHash)
+            key.inputHash = *inputHash;
+        else
+            key.inputHash = static_cast<core::blake3_hash_t>(core::blake3_hasher().update(_spirv, _dwordCount * sizeof(uint32_t)));
+        key.passes = m_passes;
+        key.targetEnv = SPIRV_VERSION;
+        if (auto found = m_cache->find(key); found)
+            return found;
+    }
+
+    auto opt = acquireOptimizer(logger);
     std::vector<uint32_t> optimized;
-    opt.Run(_spirv, _dwordCount, &optimized);
+    const bool success = opt->Run(_spirv, _dwordCount, &optimized);
+    releaseOptimizer(std::move(opt));
 
-    const uint32_t resultBytesize = optimized.size() * sizeof(uint32_t);
-    if (!resultBytesize)
+    if (!success || optimized.empty())
         return nullptr;
 
-    auto result = core::make_smart_refctd_ptr<ICPUBuffer>(resultBytesize);
-    memcpy(result->getPointer(), optimized.data(), resultBytesize);
+    if (m_cache)
+        m_cache->insert(std::move(key), optimized);
 
-    return result;
+    return createBufferFromDwords(optimized.data(), optimized.size());
+}
+
+nbl::core::smart_refctd_ptr<ICPUBuffer> ISPIRVOptimizer::optimize(const uint32_t* _spirv, uint32_t _dwordCount, system::logger_opt_ptr logger) const
+{
+    return optimize_impl(_spirv, _dwordCount, nullptr, logger);
 }
 
 nbl::core::smart_refctd_ptr<ICPUBuffer> ISPIRVOptimizer::optimize(const ICPUBuffer* _spirv, system::logger_opt_ptr logger) const
@@ -88,10 +259,82 @@ nbl::core::smart_refctd_ptr<ICPUBuffer> ISPIRVOptimizer::optimize(const ICPUBuff
     const uint32_t* spirv = reinterpret_cast<const uint32_t*>(_spirv->getPointer());
     const uint32_t count = _spirv->getSize() / sizeof(uint32_t);
 
-    return optimize(spirv, count, logger);
+    // reuse the precomputed hash when someone bothered to set it
+    static const auto NoHash = static_cast<core::blake3_hash_t>(core::blake3_hasher{});
+    const auto& hash = _spirv->getContentHash();
+    return optimize_impl(spirv, count, hash != NoHash ? &hash : nullptr, logger);
+}
+
+nbl::core::vector<nbl::core::smart_refctd_ptr<ICPUBuffer>> ISPIRVOptimizer::optimize(const std::span<const ICPUBuffer* const> _spirvs, system::logger_opt_ptr logger) const
+{
+    core::vector<core::smart_refctd_ptr<ICPUBuffer>> retval(_spirvs.size());
+    std::for_each(core::execution::par, _spirvs.begin(), _spirvs.end(), [&](const ICPUBuffer* const& spirv) -> void
+    {
+        if (spirv)
+            retval[std::distance(_spirvs.data(), &spirv)] = optimize(spirv, logger);
+    });
+    return retval;
+}
+
+nbl::core::smart_refctd_ptr<ICPUBuffer> ISPIRVOptimizer::profile(const ICPUBuffer* _spirv, core::vector<SPassTiming>& timings, system::logger_opt_ptr logger) const
+{
+    timings.clear();
+    timings.reserve(m_passes.size());
+
+    const uint32_t* spirvBegin = reinterpret_cast<const uint32_t*>(_spirv->getPointer());
+    std::vector<uint32_t> current(spirvBegin, spirvBegin + _spirv->getSize() / sizeof(uint32_t));
+    std::vector<uint32_t> optimized;
+    for (E_OPTIMIZER_PASS pass : m_passes)
+    {
+        spvtools::Optimizer opt(SPIRV_VERSION);
+        opt.RegisterPass(createPass(pass));
+        opt.SetMessageConsumer(createMessageConsumer(logger));
+
+        const auto start = std::chrono::high_resolution_clock::now();
+        const bool success = opt.Run(current.data(), current.size(), &optimized);
+        const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start);
+        if (!success || optimized.empty())
+        {
+            logger.log("SPIR-V optimizer pass %s failed", system::ILogger::ELL_ERROR, getPassName(pass));
+            return nullptr;
+        }
+
+        timings.push_back({ pass, duration, static_cast<uint32_t>(optimized.size()) });
+        logger.log("SPIR-V optimizer pass %s took %lld us, %zu -> %zu dwords", system::ILogger::ELL_PERFORMANCE, getPassName(pass), static_cast<long long>(duration.count()), current.size(), optimized.size());
+        std::swap(current, optimized);
+        optimized.clear();
+    }
+
+    return createBufferFromDwords(current.data(), current.size());
 }
 
 const std::span<const ISPIRVOptimizer::E_OPTIMIZER_PASS> nbl::asset::ISPIRVOptimizer::getPasses() const
 {
     return std::span{m_passes};
 }
+
+const char* ISPIRVOptimizer::getPassName(const E_OPTIMIZER_PASS pass)
+{
+    constexpr const char* names[EOP_COUNT] = {
+        "EOP_MERGE_RETURN",
+        "EOP_INLINE",
+        "EOP_ELIM_DEAD_FUNCTIONS",
+        "EOP_SCALAR_REPLACEMENT",
+        "EOP_LOCAL_SINGLE_BLOCK_LOAD_STORE_ELIM",
+        "EOP_LOCAL_SINGLE_STORE_ELIM",
+        "EOP_SIMPLIFICATION",
+        "EOP_VECTOR_DCE",
+        "EOP_DEAD_INSERT_ELIM",
+        "EOP_AGGRESSIVE_DCE",
+        "EOP_DEAD_BRANCH_ELIM",
+        "EOP_BLOCK_MERGE",
+        "EOP_LOCAL_MULTI_STORE_ELIM",
+        "EOP_REDUNDANCY_ELIM",
+        "EOP_LOOP_INVARIANT_CODE_MOTION",
+        "EOP_CCP",
+        "EOP_REDUCE_LOAD_SIZE",
+        "EOP_STRENGTH_REDUCTION",
+        "EOP_IF_CONVERSION"
+    };
+    return pass < EOP_COUNT ? names[pass] : "EOP_COUNT";
+}
@@ -509,6 +509,14 @@ asset::SAssetBundle CMitsubaLoader::loadAsset(system::IFile* _file, const asset:
 			createAndCacheVertexShader(m_assetMgr, DUMMY_VERTEX_SHADER);
 		}
 
+		{
+			core::vector<const CElementShape*> shapes;
+			shapes.reserve(parserManager.shapegroups.size());
+			for (const auto& shapepair : parserManager.shapegroups)
+				shapes.push_back(shapepair.first);
+			prefetchModels(ctx,_hierarchyLevel,shapes);
+		}
+
 		core::map<core::smart_refctd_ptr<asset::ICPUMesh>,std::pair<std::string,CElementShape::Type>> meshes;
 		for (auto& shapepair : parserManager.shapegroups)
 		{
@@ -541,6 +549,9 @@ asset::SAssetBundle CMitsubaLoader::loadAsset(system::IFile* _file, const asset:
 
 		// TODO: put IR and stuff in metadata so that we can recompile the materials after load
 		auto compResult = ctx.backend.compile(&ctx.backend_ctx, ctx.ir.get(), decltype(ctx.backend)::EGST_PRESENT_WITH_AOV_EXTRACTION);
+		_params.logger.log("Material compiler shared streams of %u out of %u BSDF roots, saving %zu instructions and %zu prefetch instructions.",system::ILogger::ELL_DEBUG,
+			compResult.dedupStats.dedupedRootCount,compResult.dedupStats.rootCount,compResult.dedupStats.instructionsSaved,compResult.dedupStats.prefetchInstructionsSaved
+		);
 		ctx.backend_ctx.vt.commitAll();
 		auto pipelineLayout = createPipelineLayout(m_assetMgr, ctx.backend_ctx.vt.vt.get());
 		auto fragShader = createFragmentShader(compResult, ctx.backend_ctx.vt.vt->getFloatViews().size());
@@ -610,6 +621,76 @@ asset::SAssetBundle CMitsubaLoader::loadAsset(system::IFile* _file, const asset:
 	}
 }
 
+static inline IAssetLoader::SAssetLoadParams getModelLoadParams(const SContext& ctx)
+{
+	auto loadParams = ctx.inner.params;
+	loadParams.loaderFlags = static_cast<IAssetLoader::E_LOADER_PARAMETER_FLAGS>(loadParams.loaderFlags | IAssetLoader::ELPF_RIGHT_HANDED_MESHES);
+	return loadParams;
+}
+
+void CMitsubaLoader::prefetchModels(SContext& ctx, uint32_t hierarchyLevel, const core::vector<const CElementShape*>& shapes)
+{
+	// gather every model file referenced directly or through (nested) shapegroups, deduplicated by filename
+	core::unordered_set<std::string> filenames;
+	std::function<void(const CElementShape*)> gather = [&](const CElementShape* shape) -> void
+	{
+		if (!shape)
+			return;
+		switch (shape->type)
+		{
+			case CElementShape::Type::OBJ:
+				filenames.insert(shape->obj.filename.svalue);
+				break;
+			case CElementShape::Type::PLY:
+				filenames.insert(shape->ply.filename.svalue);
+				break;
+			case CElementShape::Type::SERIALIZED:
+				filenames.insert(shape->serialized.filename.svalue);
+				break;
+			case CElementShape::Type::SHAPEGROUP:
+				for (auto i=0u; i<shape->shapegroup.childCount; i++)
+					gather(shape->shapegroup.children[i]);
+				break;
+			case CElementShape::Type::INSTANCE:
+				gather(shape->instance.parent);
+				break;
+			default:
+				break;
+		}
+	};
+	for (const auto* shape : shapes)
+		gather(shape);
+
+	// anything loaded by an earlier call is already cached
+	core::vector<std::pair<std::string,SContext::SModelFile>> loaded;
+	loaded.reserve(filenames.size());
+	for (const auto& filename : filenames)
+	if (ctx.modelCache.find(filename)==ctx.modelCache.end())
+		loaded.emplace_back(filename,SContext::SModelFile{});
+
+	const auto loadParams = getModelLoadParams(ctx);
+	std::for_each(core::execution::par,loaded.begin(),loaded.end(),[&](std::pair<std::string,SContext::SModelFile>& entry) -> void
+	{
+		auto& model = entry.second;
+		model.bundle = interm_getAssetInHierarchy(m_assetMgr,entry.first,loadParams,hierarchyLevel/*+ICPUScene::MESH_HIERARCHY_LEVELS_BELOW*/,ctx.override_);
+		if (model.bundle.getContents().empty() || model.bundle.getAssetType()!=asset::IAsset::ET_MESH)
+			return;
+		auto serializedMeta = model.bundle.getMetadata() ? model.bundle.getMetadata()->selfCast<CMitsubaSerializedMetadata>():nullptr;
+		if (!serializedMeta)
+			return;
+		const auto contentRange = model.bundle.getContents();
+		for (auto it=contentRange.begin(); it!=contentRange.end(); it++)
+		{
+			auto meshMeta = static_cast<const CMitsubaSerializedMetadata::CMesh*>(serializedMeta->getAssetSpecificMetadata(IAsset::castDown<ICPUMesh>(*it).get()));
+			if (meshMeta)
+				model.shapeIndexToContent.emplace(meshMeta->m_id,static_cast<uint32_t>(it-contentRange.begin()));
+		}
+	});
+	// the cache is not node-stable, so only touch it once the workers are done
+	for (auto& entry : loaded)
+		ctx.modelCache.emplace(std::move(entry.first),std::move(entry.second));
+}
+
 core::vector<SContext::shape_ass_type> CMitsubaLoader::getMesh(SContext& ctx, uint32_t hierarchyLevel, CElementShape* shape, const system::logger_opt_ptr& logger)
 {
 	if (!shape)
@@ -721,23 +802,24 @@ SContext::shape_ass_type CMitsubaLoader::loadBasicShape(SContext& ctx, uint32_t
 	auto loadModel = [&](const ext::MitsubaLoader::SPropertyElementData& filename, int64_t index=-1) -> core::smart_refctd_ptr<asset::ICPUMesh>
 	{
 		assert(filename.type==ext::MitsubaLoader::SPropertyElementData::Type::STRING);
-		auto loadParams = ctx.inner.params;
-		loadParams.loaderFlags = static_cast<IAssetLoader::E_LOADER_PARAMETER_FLAGS>(loadParams.loaderFlags | IAssetLoader::ELPF_RIGHT_HANDED_MESHES);
-		auto retval = interm_getAssetInHierarchy(m_assetMgr, filename.svalue, loadParams, hierarchyLevel/*+ICPUScene::MESH_HIERARCHY_LEVELS_BELOW*/, ctx.override_);
-		if (retval.getAssetType()!=asset::IAsset::ET_MESH)
+		auto found = ctx.modelCache.find(filename.svalue);
+		// should have been prefetched, but fall back to a serial load just in case
+		if (found==ctx.modelCache.end())
+		{
+			prefetchModels(ctx,hierarchyLevel,{shape});
+			found = ctx.modelCache.find(filename.svalue);
+		}
+		const auto& model = found->second;
+		if (model.bundle.getContents().empty() || model.bundle.getAssetType()!=asset::IAsset::ET_MESH)
 			return nullptr;
-		auto contentRange = retval.getContents();
-		auto serializedMeta = retval.getMetadata()->selfCast<CMitsubaSerializedMetadata>();
+		auto contentRange = model.bundle.getContents();
 		//
 		uint32_t actualIndex = 0;
-		if (index>=0ll && serializedMeta)
-		for (auto it=contentRange.begin(); it!=contentRange.end(); it++)
+		if (index>=0ll)
 		{
-			auto meshMeta = static_cast<const CMitsubaSerializedMetadata::CMesh*>(serializedMeta->getAssetSpecificMetadata(IAsset::castDown<ICPUMesh>(*it).get()));
-			if (meshMeta->m_id!=static_cast<uint32_t>(index))
-				continue;
-			actualIndex = it-contentRange.begin();
-			break;
+			auto foundIx = model.shapeIndexToContent.find(static_cast<uint32_t>(index));
+			if (foundIx!=model.shapeIndexToContent.end())
+				actualIndex = foundIx->second;
 		}
 		//
 		if (contentRange.begin()+actualIndex < contentRange.end())
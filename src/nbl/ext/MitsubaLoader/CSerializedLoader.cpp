@@ -60,6 +60,263 @@ using unaligned_dvec2 = unaligned_gvecN<double,2ull>;
 using unaligned_dvec3 = unaligned_gvecN<double,3ull>;
 
 
+// everything a single mesh of the file decodes to, before its meshbuffer and pipeline get assembled
+struct SDecodedMesh
+{
+	bool valid = false;
+	uint32_t flags = 0u;
+	std::string name = {};
+	uint64_t vertexCount = 0ull;
+	uint64_t triangleCount = 0ull;
+	bool sourceIsDoubles = false;
+	core::aabbox3df aabb;
+	core::smart_refctd_ptr<ICPUBuffer> indexbuf,posbuf,normalbuf,uvbuf,colorbuf;
+};
+
+//! inflates and decodes the attributes of one mesh, does not touch the asset manager so its safe to call for many meshes at once
+static bool decodeMesh(SDecodedMesh& out, system::IFile* file, const uint64_t fileOffset, const size_t localSize, CQuantNormalCache* const quantNormalCache)
+{
+	core::vector<uint8_t> data(localSize);
+	{
+		system::future<size_t> future;
+		file->read(future,data.data(),fileOffset,localSize);
+		if (future.get()!=localSize)
+			return false;
+	}
+
+	constexpr size_t CHUNK = 256ull*1024ull;
+	core::vector<Page_t> decompressed(CHUNK/sizeof(Page_t));
+	// decompress
+	size_t decompressSize;
+	{
+		// Setup the inflate stream.
+		z_stream stream;
+		stream.next_in = (Bytef*)data.data();
+		stream.avail_in = (uInt)localSize;
+		stream.total_in = 0;
+		stream.next_out = (Bytef*)decompressed.data();
+		stream.avail_out = CHUNK;
+		stream.total_out = 0u;
+		stream.zalloc = (alloc_func)0;
+		stream.zfree = (free_func)0;
+
+		int32_t err = inflateInit(&stream, -MAX_WBITS);
+		if (err == Z_OK)
+		{
+			while (err == Z_OK && err != Z_STREAM_END)
+			{
+				err = inflate(&stream, Z_SYNC_FLUSH);
+				if (err!=Z_OK || err==Z_STREAM_END || stream.avail_out)
+					continue;
+
+				if (stream.total_out+CHUNK>decompressed.size()*sizeof(Page_t))
+					decompressed.resize(decompressed.size()+CHUNK/sizeof(Page_t));
+				stream.next_out = reinterpret_cast<Bytef*>(decompressed.data())+stream.total_out;
+				stream.avail_out = CHUNK;
+			}
+		}
+		decompressSize = stream.total_out;
+		int32_t err2 = inflateEnd(&stream);
+
+		if (err == Z_OK || err == Z_STREAM_END)
+			err = err2;
+		if (err != Z_OK)
+			return false;
+	}
+	// compressed data no longer needed, keep peak memory per worker down
+	core::vector<uint8_t>().swap(data);
+	// too small to hold anything
+	if (decompressSize < sizeof(uint8_t)+sizeof(uint64_t)*2ull)
+		return false;
+
+	// some tracking
+	uint8_t* ptr = reinterpret_cast<uint8_t*>(decompressed.data());
+	uint8_t* streamEnd = ptr+decompressSize;
+	// vertex size determination
+	out.flags = *(reinterpret_cast<uint32_t*&>(ptr)++);
+	const auto flags = out.flags;
+	size_t typeSize;
+	{
+		if (flags & MF_SINGLE_FLOAT)
+			typeSize = sizeof(float);
+		else if (flags & MF_DOUBLE_FLOAT)
+			typeSize = sizeof(double);
+		else
+			return false;
+	}
+	out.sourceIsDoubles = typeSize==sizeof(double);
+	const bool requiresNormals = (flags&MF_PER_VERTEX_NORMALS) || (flags&MF_FACE_NORMALS);
+	const bool hasUVs = flags&MF_TEXTURE_COORDINATES;
+	const bool hasColors = flags&MF_VERTEX_COLORS;
+
+	// get name
+	char* stringPtr = reinterpret_cast<char*>(ptr);
+	while (ptr < streamEnd)
+	if (! *(ptr++))
+			break;
+	// name too long
+	const size_t stringLen = reinterpret_cast<char*>(ptr)-stringPtr;
+	if (ptr+sizeof(uint64_t)*2ull > streamEnd)
+		return false;
+	out.name = std::string(stringPtr,stringLen);
+
+	// 
+	const uint64_t vertexCount = out.vertexCount = *(reinterpret_cast<uint64_t*&>(ptr)++);
+	if (vertexCount<3ull || vertexCount>0xFFFFFFFFull)
+		return false;
+	const uint64_t triangleCount = out.triangleCount = *(reinterpret_cast<uint64_t*&>(ptr)++);
+	if (triangleCount<1ull)
+		return false;
+	const size_t indexDataSize = sizeof(uint32_t)*3ull*triangleCount;
+	{
+		size_t vertexDataSize = 3ull;
+		if (requiresNormals)
+			vertexDataSize += 3ull;
+		if (hasUVs)
+			vertexDataSize += 2ull;
+		if (hasColors)
+			vertexDataSize += 3ull;
+		vertexDataSize *= typeSize*vertexCount;
+		if (ptr+vertexDataSize > streamEnd)
+			return false;
+		size_t totalDataSize = vertexDataSize+indexDataSize;
+		if (ptr+totalDataSize > streamEnd)
+			return false;
+	}
+
+	out.indexbuf = core::make_smart_refctd_ptr<asset::ICPUBuffer>(indexDataSize);
+	const uint32_t posAttrSize = typeSize*3u;
+	out.posbuf = core::make_smart_refctd_ptr<asset::ICPUBuffer>(vertexCount*posAttrSize);
+	if (requiresNormals)
+		out.normalbuf = core::make_smart_refctd_ptr<asset::ICPUBuffer>(sizeof(uint32_t)*vertexCount);
+	// TODO: UV quantization and optimization (maybe lets just always use half floats?)
+	constexpr size_t uvAttrSize = sizeof(float)*2u;
+	if (hasUVs)
+		out.uvbuf = core::make_smart_refctd_ptr<asset::ICPUBuffer>(uvAttrSize*vertexCount);
+	if (hasColors)
+		out.colorbuf = core::make_smart_refctd_ptr<asset::ICPUBuffer>(sizeof(uint32_t)*vertexCount);
+
+	void* posPtr = out.posbuf->getPointer();
+	CQuantNormalCache::value_type_t<EF_A2B10G10R10_SNORM_PACK32>* normalPtr = !out.normalbuf ? nullptr:reinterpret_cast<CQuantNormalCache::value_type_t<EF_A2B10G10R10_SNORM_PACK32>*>(out.normalbuf->getPointer());
+	unaligned_vec2* uvPtr = !out.uvbuf ? nullptr:reinterpret_cast<unaligned_vec2*>(out.uvbuf->getPointer());
+	uint32_t* colorPtr = !out.colorbuf ? nullptr:reinterpret_cast<uint32_t*>(out.colorbuf->getPointer());
+
+	// the attribute streams are plain arrays, so every per-vertex decode is independent and can go wide
+	{
+		auto readPositions = [ptr,posPtr](const auto& pos) -> void
+		{
+			size_t vertexIx = std::distance(reinterpret_cast<decltype(&pos)>(ptr),&pos);
+			reinterpret_cast<std::remove_const_t<std::remove_reference_t<decltype(pos)>>*>(posPtr)[vertexIx] = pos;
+		};
+		auto computeAABB = [&out,vertexCount](const auto* positions) -> void
+		{
+			const auto* coords = positions[0].pointer;
+			out.aabb.reset(coords[0],coords[1],coords[2]);
+			for (uint64_t vertexIx=1ull; vertexIx<vertexCount; vertexIx++)
+			{
+				coords = positions[vertexIx].pointer;
+				out.aabb.addInternalPoint(coords[0],coords[1],coords[2]);
+			}
+		};
+		if (out.sourceIsDoubles)
+		{
+			auto*& typedPtr = reinterpret_cast<unaligned_dvec3*&>(ptr);
+			std::for_each_n(core::execution::par_unseq,typedPtr,vertexCount,readPositions);
+			computeAABB(reinterpret_cast<const unaligned_dvec3*>(posPtr));
+			typedPtr += vertexCount;
+		}
+		else
+		{
+			auto*& typedPtr = reinterpret_cast<unaligned_vec3*&>(ptr);
+			std::for_each_n(core::execution::par_unseq,typedPtr,vertexCount,readPositions);
+			computeAABB(reinterpret_cast<const unaligned_vec3*>(posPtr));
+			typedPtr += vertexCount;
+		}
+	}
+	if (requiresNormals)
+	{
+		auto readNormals = [quantNormalCache,ptr,normalPtr](const auto& nml) -> void
+		{
+			size_t vertexIx = std::distance(reinterpret_cast<decltype(&nml)>(ptr),&nml);
+			core::vectorSIMDf simdNormal(nml.pointer[0],nml.pointer[1],nml.pointer[2]);
+			normalPtr[vertexIx] = quantNormalCache->quantize<EF_A2B10G10R10_SNORM_PACK32>(simdNormal);
+		};
+		// quantization cache takes a lock, so no `unseq`
+		const bool read = flags&MF_PER_VERTEX_NORMALS;
+		if (out.sourceIsDoubles)
+		{
+			auto*& typedPtr = reinterpret_cast<unaligned_dvec3*&>(ptr);
+			if (read)
+				std::for_each_n(core::execution::par,typedPtr,vertexCount,readNormals);
+			typedPtr += vertexCount;
+		}
+		else
+		{
+			auto*& typedPtr = reinterpret_cast<unaligned_vec3*&>(ptr);
+			if (read)
+				std::for_each_n(core::execution::par,typedPtr,vertexCount,readNormals);
+			typedPtr += vertexCount;
+		}
+	}
+	if (hasUVs)
+	{
+		auto readUVs = [ptr,uvPtr](const auto& uv) -> void
+		{
+			size_t vertexIx = std::distance(reinterpret_cast<decltype(&uv)>(ptr),&uv);
+			for (auto k=0u; k<2u; k++)
+				uvPtr[vertexIx].pointer[k] = uv.pointer[k];
+		};
+		if (out.sourceIsDoubles)
+		{
+			auto*& typedPtr = reinterpret_cast<unaligned_dvec2*&>(ptr);
+			std::for_each_n(core::execution::par_unseq,typedPtr,vertexCount,readUVs);
+			typedPtr += vertexCount;
+		}
+		else
+		{
+			auto*& typedPtr = reinterpret_cast<unaligned_vec2*&>(ptr);
+			std::for_each_n(core::execution::par_unseq,typedPtr,vertexCount,readUVs);
+			typedPtr += vertexCount;
+		}
+	}
+	if (hasColors)
+	{
+		auto readColors = [ptr,colorPtr](const auto& color) -> void
+		{
+			size_t vertexIx = std::distance(reinterpret_cast<decltype(&color)>(ptr),&color);
+			const double colors[3] = {color.pointer[0],color.pointer[1],color.pointer[2]};
+			asset::encodePixels<asset::EF_B10G11R11_UFLOAT_PACK32,double>(colorPtr+vertexIx,colors);
+		};
+		if (out.sourceIsDoubles)
+		{
+			auto*& typedPtr = reinterpret_cast<unaligned_dvec3*&>(ptr);
+			std::for_each_n(core::execution::par_unseq,typedPtr,vertexCount,readColors);
+			typedPtr += vertexCount;
+		}
+		else
+		{
+			auto*& typedPtr = reinterpret_cast<unaligned_vec3*&>(ptr);
+			std::for_each_n(core::execution::par_unseq,typedPtr,vertexCount,readColors);
+			typedPtr += vertexCount;
+		}
+	}
+
+	// read and validate indices
+	{
+		const uint32_t* srcIndices = reinterpret_cast<const uint32_t*>(ptr);
+		uint32_t* indexPtr = reinterpret_cast<uint32_t*>(out.indexbuf->getPointer());
+		bool valid = true;
+		for (uint64_t j=0ull; j<triangleCount*3ull; j++)
+		{
+			indexPtr[j] = srcIndices[j];
+			valid = valid && indexPtr[j]<static_cast<uint32_t>(vertexCount);
+		}
+		if (!valid)
+			return false;
+	}
+	return true;
+}
+
 //! creates/loads an animated mesh from the file.
 asset::SAssetBundle CSerializedLoader::loadAsset(system::IFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override, uint32_t _hierarchyLevel)
 {
@@ -117,135 +374,34 @@ asset::SAssetBundle CSerializedLoader::loadAsset(system::IFile* _file, const ass
 	if (maxSize==0u)
 		return {};
 
+	// every mesh is an independent deflate stream, so inflate and decode all of them at once
+	core::vector<SDecodedMesh> decoded(ctx.meshCount);
+	std::for_each(core::execution::par,decoded.begin(),decoded.end(),[&](SDecodedMesh& mesh_i) -> void
+	{
+		const uint32_t i = std::distance(decoded.data(),&mesh_i);
+		const auto localSize = ctx.meshOffsets->operator[](i+ctx.meshCount);
+		mesh_i.valid = decodeMesh(mesh_i,ctx.inner.mainFile,sizeof(FileHeader)+ctx.meshOffsets->operator[](i),localSize,quantNormalCache);
+	});
+
 	auto meta = core::make_smart_refctd_ptr<CMitsubaSerializedMetadata>(ctx.meshCount,core::smart_refctd_ptr(IRenderpassIndependentPipelineLoader::m_basicViewParamsSemantics));
 	core::vector<core::smart_refctd_ptr<ICPUMesh>> meshes; meshes.reserve(ctx.meshCount);
 
-	uint8_t* data = reinterpret_cast<uint8_t*>(_NBL_ALIGNED_MALLOC(maxSize,alignof(double)));
-	constexpr size_t CHUNK = 256ull*1024ull;
-	core::vector<Page_t> decompressed(CHUNK/sizeof(Page_t));
-	system::future<size_t> future;
+	// assemble in file order so the output (and metadata indices) stay deterministic
 	for (uint32_t i=0; i<ctx.meshCount; i++)
 	{
-		auto localSize = ctx.meshOffsets->operator[](i+ctx.meshCount);
-		ctx.inner.mainFile->read(future,data,sizeof(FileHeader)+ctx.meshOffsets->operator[](i),localSize);
-		// decompress
-		size_t decompressSize;
+		auto& mesh_i = decoded[i];
+		if (!mesh_i.valid)
 		{
-			// Setup the inflate stream.
-			z_stream stream;
-			stream.next_in = (Bytef*)data;
-			stream.avail_in = (uInt)localSize;
-			stream.total_in = 0;
-			stream.next_out = (Bytef*)decompressed.data();
-			stream.avail_out = CHUNK;
-			stream.total_out = 0u;
-			stream.zalloc = (alloc_func)0;
-			stream.zfree = (free_func)0;
-
-			int32_t err = inflateInit(&stream, -MAX_WBITS);
-			if (err == Z_OK)
-			{
-				while (err == Z_OK && err != Z_STREAM_END)
-				{
-					err = inflate(&stream, Z_SYNC_FLUSH);
-					if (err!=Z_OK || err==Z_STREAM_END || stream.avail_out)
-						continue;
-
-					if (stream.total_out+CHUNK>decompressed.size()*sizeof(Page_t))
-						decompressed.resize(decompressed.size()+CHUNK/sizeof(Page_t));
-					stream.next_out = reinterpret_cast<Bytef*>(decompressed.data())+stream.total_out;
-					stream.avail_out = CHUNK;
-				}
-			}
-			decompressSize = stream.total_out;
-			int32_t err2 = inflateEnd(&stream);
-
-			if (err == Z_OK || err == Z_STREAM_END)
-				err = err2;
-			if (err != Z_OK)
-			{
-				std::string msg("Error decompressing mesh ix ");
-				msg += std::to_string(i);
-				_params.logger.log(msg, system::ILogger::E_LOG_LEVEL::ELL_ERROR);
-				continue;
-			}
-		}
-		// too small to hold anything
-		if (decompressSize < sizeof(uint8_t)+sizeof(uint64_t)*2ull)
+			std::string msg("Error decoding mesh ix ");
+			msg += std::to_string(i);
+			_params.logger.log(msg, system::ILogger::E_LOG_LEVEL::ELL_ERROR);
 			continue;
-
-		// some tracking
-		uint8_t* ptr = reinterpret_cast<uint8_t*>(decompressed.data());
-		uint8_t* streamEnd = ptr+decompressSize;
-		// vertex size determination
-		auto flags = *(reinterpret_cast<uint32_t*&>(ptr)++);
-		size_t typeSize;
-		{
-			if (flags & MF_SINGLE_FLOAT)
-				typeSize = sizeof(float);
-			else if (flags & MF_DOUBLE_FLOAT)
-				typeSize = sizeof(double);
-			else
-				continue;
 		}
-		const bool sourceIsDoubles = typeSize==sizeof(double);
+		const auto flags = mesh_i.flags;
 		const bool requiresNormals = (flags&MF_PER_VERTEX_NORMALS) || (flags&MF_FACE_NORMALS);
 		const bool hasUVs = flags&MF_TEXTURE_COORDINATES;
 		const bool hasColors = flags&MF_VERTEX_COLORS;
 
-		// get name
-		char* stringPtr = reinterpret_cast<char*>(ptr);
-		while (ptr < streamEnd)
-		if (! *(ptr++))
-				break;
-		// name too long
-		const size_t stringLen = reinterpret_cast<char*>(ptr)-stringPtr;
-		if (ptr+sizeof(uint64_t)*2ull > streamEnd)
-			continue;
-
-		// 
-		const uint64_t vertexCount = *(reinterpret_cast<uint64_t*&>(ptr)++);
-		if (vertexCount<3ull || vertexCount>0xFFFFFFFFull)
-			continue;
-		const uint64_t triangleCount = *(reinterpret_cast<uint64_t*&>(ptr)++);
-		if (triangleCount<1ull)
-			continue;
-		const size_t indexDataSize = sizeof(uint32_t)*3ull*triangleCount;
-		{
-			size_t vertexDataSize = 3ull;
-			if (requiresNormals)
-				vertexDataSize += 3ull;
-			if (hasUVs)
-				vertexDataSize += 2ull;
-			if (hasColors)
-				vertexDataSize += 3ull;
-			vertexDataSize *= typeSize*vertexCount;
-			if (ptr+vertexDataSize > streamEnd)
-				continue;
-			size_t totalDataSize = vertexDataSize+indexDataSize;
-			if (ptr+totalDataSize > streamEnd)
-				continue;
-		}
-
-		auto indexbuf = core::make_smart_refctd_ptr<asset::ICPUBuffer>(indexDataSize);
-		const uint32_t posAttrSize = typeSize*3u;
-		auto posbuf = core::make_smart_refctd_ptr<asset::ICPUBuffer>(vertexCount*posAttrSize);
-		core::smart_refctd_ptr<asset::ICPUBuffer> normalbuf,uvbuf,colorbuf;
-		if (requiresNormals)
-			normalbuf = core::make_smart_refctd_ptr<asset::ICPUBuffer>(sizeof(uint32_t)*vertexCount);
-		// TODO: UV quantization and optimization (maybe lets just always use half floats?)
-		constexpr size_t uvAttrSize = sizeof(float)*2u;
-		if (hasUVs)
-			uvbuf = core::make_smart_refctd_ptr<asset::ICPUBuffer>(uvAttrSize*vertexCount);
-		if (hasColors)
-			colorbuf = core::make_smart_refctd_ptr<asset::ICPUBuffer>(sizeof(uint32_t)*vertexCount);
-
-		void* posPtr = posbuf->getPointer();
-		CQuantNormalCache::value_type_t<EF_A2B10G10R10_SNORM_PACK32>* normalPtr = !normalbuf ? nullptr:reinterpret_cast<CQuantNormalCache::value_type_t<EF_A2B10G10R10_SNORM_PACK32>*>(normalbuf->getPointer());
-		unaligned_vec2* uvPtr = !uvbuf ? nullptr:reinterpret_cast<unaligned_vec2*>(uvbuf->getPointer());
-		uint32_t* colorPtr = !colorbuf ? nullptr:reinterpret_cast<uint32_t*>(colorbuf->getPointer());
-
-
 		auto meshBuffer = core::make_smart_refctd_ptr<asset::ICPUMeshBuffer>();
 		meshBuffer->setPositionAttributeIx(POSITION_ATTRIBUTE);
 
@@ -293,146 +449,46 @@ asset::SAssetBundle CSerializedLoader::loadAsset(system::IFile* _file, const ass
 		};
 
 		meshBuffer->setPositionAttributeIx(POSITION_ATTRIBUTE);
-		enableAttribute(POSITION_ATTRIBUTE,sourceIsDoubles ? asset::EF_R64G64B64_SFLOAT:asset::EF_R32G32B32_SFLOAT,posbuf);
-		{
-			core::aabbox3df aabb;
-			auto readPositions = [&aabb,ptr,posPtr](const auto& pos) -> void
-			{
-				size_t vertexIx = std::distance(reinterpret_cast<decltype(&pos)>(ptr),&pos);
-				const auto* coords = pos.pointer;
-				if (vertexIx)
-					aabb.addInternalPoint(coords[0],coords[1],coords[2]);
-				else
-					aabb.reset(coords[0],coords[1],coords[2]);
-				reinterpret_cast<std::remove_const_t<std::remove_reference_t<decltype(pos)>>*>(posPtr)[vertexIx] = pos;
-			};
-			if (sourceIsDoubles)
-			{
-				auto*& typedPtr = reinterpret_cast<unaligned_dvec3*&>(ptr);
-				std::for_each_n(core::execution::seq,typedPtr,vertexCount,readPositions);
-				typedPtr += vertexCount;
-			}
-			else
-			{
-				auto*& typedPtr = reinterpret_cast<unaligned_vec3*&>(ptr);
-				std::for_each_n(core::execution::seq,typedPtr,vertexCount,readPositions);
-				typedPtr += vertexCount;
-			}
-			meshBuffer->setBoundingBox(aabb);
-		}
+		enableAttribute(POSITION_ATTRIBUTE,mesh_i.sourceIsDoubles ? asset::EF_R64G64B64_SFLOAT:asset::EF_R32G32B32_SFLOAT,mesh_i.posbuf);
+		meshBuffer->setBoundingBox(mesh_i.aabb);
 		if (requiresNormals)
 		{
-			enableAttribute(NORMAL_ATTRIBUTE,asset::EF_A2B10G10R10_SNORM_PACK32,normalbuf);
-			auto readNormals = [quantNormalCache,ptr,normalPtr](const auto& nml) -> void
-			{
-				size_t vertexIx = std::distance(reinterpret_cast<decltype(&nml)>(ptr),&nml);
-				core::vectorSIMDf simdNormal(nml.pointer[0],nml.pointer[1],nml.pointer[2]);
-				normalPtr[vertexIx] = quantNormalCache->quantize<EF_A2B10G10R10_SNORM_PACK32>(simdNormal);
-			};
-			const bool read = flags&MF_PER_VERTEX_NORMALS;
-			if (sourceIsDoubles)
-			{
-				auto*& typedPtr = reinterpret_cast<unaligned_dvec3*&>(ptr);
-				if (read)
-					std::for_each_n(core::execution::seq,typedPtr,vertexCount,readNormals);
-				typedPtr += vertexCount;
-			}
-			else
-			{
-				auto*& typedPtr = reinterpret_cast<unaligned_vec3*&>(ptr);
-				if (read)
-					std::for_each_n(core::execution::seq,typedPtr,vertexCount,readNormals);
-				typedPtr += vertexCount;
-			}
+			enableAttribute(NORMAL_ATTRIBUTE,asset::EF_A2B10G10R10_SNORM_PACK32,mesh_i.normalbuf);
 			meshBuffer->setNormalAttributeIx(NORMAL_ATTRIBUTE);
 		}
 		if (hasUVs)
-		{
-			enableAttribute(UV_ATTRIBUTE,asset::EF_R32G32_SFLOAT,uvbuf);
-			auto readUVs = [ptr,uvPtr](const auto& uv) -> void
-			{
-				size_t vertexIx = std::distance(reinterpret_cast<decltype(&uv)>(ptr),&uv);
-				for (auto k=0u; k<2u; k++)
-					uvPtr[vertexIx].pointer[k] = uv.pointer[k];
-			};
-			if (sourceIsDoubles)
-			{
-				auto*& typedPtr = reinterpret_cast<unaligned_dvec2*&>(ptr);
-				std::for_each_n(core::execution::seq,typedPtr,vertexCount,readUVs);
-				typedPtr += vertexCount;
-			}
-			else
-			{
-				auto*& typedPtr = reinterpret_cast<unaligned_vec2*&>(ptr);
-				std::for_each_n(core::execution::seq,typedPtr,vertexCount,readUVs);
-				typedPtr += vertexCount;
-			}
-		}
+			enableAttribute(UV_ATTRIBUTE,asset::EF_R32G32_SFLOAT,mesh_i.uvbuf);
 		if (hasColors)
-		{
-			enableAttribute(COLOR_ATTRIBUTE,asset::EF_B10G11R11_UFLOAT_PACK32,colorbuf);
-			auto readColors = [ptr,colorPtr](const auto& color) -> void
-			{
-				size_t vertexIx = std::distance(reinterpret_cast<decltype(&color)>(ptr),&color);
-				const double colors[3] = {color.pointer[0],color.pointer[1],color.pointer[2]};
-				asset::encodePixels<asset::EF_B10G11R11_UFLOAT_PACK32,double>(colorPtr+vertexIx,colors);
-			};
-			if (sourceIsDoubles)
-			{
-				auto*& typedPtr = reinterpret_cast<unaligned_dvec3*&>(ptr);
-				std::for_each_n(core::execution::seq,typedPtr,vertexCount,readColors);
-				typedPtr += vertexCount;
-			}
-			else
-			{
-				auto*& typedPtr = reinterpret_cast<unaligned_vec3*&>(ptr);
-				std::for_each_n(core::execution::seq,typedPtr,vertexCount,readColors);
-				typedPtr += vertexCount;
-			}
-		}
+			enableAttribute(COLOR_ATTRIBUTE,asset::EF_B10G11R11_UFLOAT_PACK32,mesh_i.colorbuf);
 
 		auto mbPipeline = core::make_smart_refctd_ptr<asset::ICPURenderpassIndependentPipeline>(std::move(mbPipelineLayout), nullptr, nullptr, inputParams, blendParams, primitiveAssemblyParams, rastarizationParams);
 		mbPipeline->setShaderAtStage(asset::ISpecializedShader::E_SHADER_STAGE::ESS_VERTEX, mbVertexShader.get());
 		mbPipeline->setShaderAtStage(asset::ISpecializedShader::E_SHADER_STAGE::ESS_FRAGMENT, mbFragmentShader.get());
 
-		meshBuffer->setIndexBufferBinding({0u,indexbuf});
-		meshBuffer->setIndexCount(triangleCount * 3u);
+		meshBuffer->setIndexBufferBinding({0u,mesh_i.indexbuf});
+		meshBuffer->setIndexCount(mesh_i.triangleCount * 3u);
 		meshBuffer->setIndexType(asset::EIT_32BIT);
 
-		// read indices and possibly create per-face normals
-		auto readIndices = [&]() -> bool
+		// possibly create per-face normals
+		if (flags & MF_FACE_NORMALS)
 		{
-			uint32_t* indexPtr = reinterpret_cast<uint32_t*>(indexbuf->getPointer());
-			for (uint64_t j=0ull; j<triangleCount; j++)
+			const uint32_t* indexPtr = reinterpret_cast<const uint32_t*>(mesh_i.indexbuf->getPointer());
+			for (uint64_t j=0ull; j<mesh_i.triangleCount; j++)
 			{
-				uint32_t* triangleIndices = indexPtr;
+				const uint32_t* triangleIndices = indexPtr+j*3ull;
+				core::vectorSIMDf pos[3];
+				for (uint64_t k=0ull; k<3ull; k++)
+					pos[k] = meshBuffer->getPosition(triangleIndices[k]);
+				auto normal = core::cross(pos[1]-pos[0],pos[2]-pos[0]);
 				for (uint64_t k=0ull; k<3ull; k++)
-				{
-					triangleIndices[k] = *(reinterpret_cast<uint32_t*&>(ptr)++);
-					if (triangleIndices[k] >= static_cast<uint32_t>(vertexCount))
-						return false;
-				}
-				indexPtr += 3u;
-
-				if (flags & MF_FACE_NORMALS)
-				{
-					core::vectorSIMDf pos[3];
-					for (uint64_t k=0ull; k<3ull; k++)
-						pos[k] = meshBuffer->getPosition(triangleIndices[k]);
-					auto normal = core::cross(pos[1]-pos[0],pos[2]-pos[0]);
-					for (uint64_t k=0ull; k<3ull; k++)
-						meshBuffer->setAttribute(normal,NORMAL_ATTRIBUTE,k);
-				}
+					meshBuffer->setAttribute(normal,NORMAL_ATTRIBUTE,k);
 			}
-			return true;
-		};
-		if (!readIndices())
-			continue;
+		}
 
 
 		auto mesh = core::make_smart_refctd_ptr<asset::ICPUMesh>();
 
-		meta->placeMeta(meshes.size(),mbPipeline.get(),mesh.get(),{std::string(stringPtr,stringLen),i});
+		meta->placeMeta(meshes.size(),mbPipeline.get(),mesh.get(),{std::move(mesh_i.name),i});
 
 		meshBuffer->setPipeline(std::move(mbPipeline));
 
@@ -440,12 +496,10 @@ asset::SAssetBundle CSerializedLoader::loadAsset(system::IFile* _file, const ass
 		mesh->getMeshBufferVector().emplace_back(std::move(meshBuffer));
 		meshes.push_back(std::move(mesh));
 	}
-	_NBL_ALIGNED_FREE(data);
 
 	return SAssetBundle(std::move(meta),std::move(meshes));
 }
 
-
 }
 }
 }
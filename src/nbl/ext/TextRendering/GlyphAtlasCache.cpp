@@ -0,0 +1,318 @@
+#include "nabla.h"
+#include <nbl/ext/TextRendering/GlyphAtlasCache.h>
+#include "nbl/asset/CVectorCPUBuffer.h"
+
+#define STB_RECT_PACK_IMPLEMENTATION
+#include <nbl/ext/TextRendering/stb_rect_pack.h>
+
+namespace nbl
+{
+namespace ext
+{
+namespace TextRendering
+{
+
+// SNORM texel value of "far outside the shape" in our (inverted) MSDF convention
+constexpr int8_t EmptyMSDFTexel = 127;
+
+bool GlyphAtlasCache::CPersistentCache::find(const SKey& key, int8_t* dst, size_t dstRowPitch) const
+{
+	auto lk = system::read_lock_guard<>(m_lock);
+	auto found = m_container.find(key);
+	if (found == m_container.end())
+		return false;
+
+	const size_t srcRowPitch = key.width * 4u;
+	for (uint32_t y = 0u; y < key.height; y++)
+		memcpy(dst + y * dstRowPitch, found->second.data() + y * srcRowPitch, srcRowPitch);
+	return true;
+}
+
+void GlyphAtlasCache::CPersistentCache::insert(const SKey& key, const int8_t* src, size_t srcRowPitch)
+{
+	const size_t dstRowPitch = key.width * 4u;
+	core::vector<int8_t> texels(dstRowPitch * key.height);
+	for (uint32_t y = 0u; y < key.height; y++)
+		memcpy(texels.data() + y * dstRowPitch, src + y * srcRowPitch, dstRowPitch);
+
+	auto lk = system::write_lock_guard<>(m_lock);
+	m_container.insert_or_assign(key, std::move(texels));
+}
+
+// Layout: MAGIC, VERSION, entry count, then every key followed by its tightly packed texels
+core::smart_refctd_ptr<ICPUBuffer> GlyphAtlasCache::CPersistentCache::serialize() const
+{
+	core::vector<uint8_t> retVal;
+	auto write = [&retVal](const void* data, const size_t size) -> void
+	{
+		const auto oldSize = retVal.size();
+		retVal.resize(oldSize + size);
+		if (size)
+			memcpy(retVal.data() + oldSize, data, size);
+	};
+
+	auto lk = system::read_lock_guard<>(m_lock);
+	const uint64_t entryCount = m_container.size();
+	write(&MAGIC, sizeof(MAGIC));
+	write(&VERSION, sizeof(VERSION));
+	write(&entryCount, sizeof(entryCount));
+	for (const auto& [key, texels] : m_container)
+	{
+		write(key.fontHash.data, sizeof(key.fontHash.data));
+		write(&key.glyphId, sizeof(key.glyphId));
+		write(&key.msdfPixelRange, sizeof(key.msdfPixelRange));
+		write(&key.width, sizeof(key.width));
+		write(&key.height, sizeof(key.height));
+		write(texels.data(), texels.size());
+	}
+
+	return core::make_smart_refctd_ptr<CVectorCPUBuffer<uint8_t, nbl::core::aligned_allocator<uint8_t>>>(std::move(retVal));
+}
+
+core::smart_refctd_ptr<GlyphAtlasCache::CPersistentCache> GlyphAtlasCache::CPersistentCache::deserialize(const std::span<const uint8_t> serializedCache)
+{
+	std::span<const uint8_t> in = serializedCache;
+	auto read = [&in](void* data, const size_t size) -> bool
+	{
+		if (in.size() < size)
+			return false;
+		if (size)
+			memcpy(data, in.data(), size);
+		in = in.subspan(size);
+		return true;
+	};
+
+	uint32_t magic, version;
+	uint64_t entryCount;
+	if (!read(&magic, sizeof(magic)) || magic != MAGIC || !read(&version, sizeof(version)) || version != VERSION || !read(&entryCount, sizeof(entryCount)))
+		return nullptr;
+
+	auto retVal = core::make_smart_refctd_ptr<CPersistentCache>();
+	for (uint64_t i = 0u; i < entryCount; i++)
+	{
+		SKey key;
+		if (!read(key.fontHash.data, sizeof(key.fontHash.data)) || !read(&key.glyphId, sizeof(key.glyphId)) || !read(&key.msdfPixelRange, sizeof(key.msdfPixelRange)) ||
+			!read(&key.width, sizeof(key.width)) || !read(&key.height, sizeof(key.height)))
+			return nullptr;
+
+		const uint64_t texelBytes = uint64_t(key.width) * key.height * 4u;
+		if (texelBytes > in.size())
+			return nullptr;
+		core::vector<int8_t> texels(texelBytes);
+		read(texels.data(), texelBytes);
+		retVal->m_container.emplace(key, std::move(texels));
+	}
+
+	return retVal;
+}
+
+
+GlyphAtlasCache::GlyphAtlasCache(core::smart_refctd_ptr<FontFace>&& face, uint32_t2 pageExtents, uint32_t maxPageCount, core::smart_refctd_ptr<CPersistentCache>&& persistentCache, system::ISystem* system)
+	: m_face(std::move(face)), m_persistentCache(std::move(persistentCache)), m_pageExtents(pageExtents), m_maxPageCount(core::max(maxPageCount, 1u))
+{
+	assert(m_face);
+	if (m_persistentCache)
+	{
+		// without the font file's contents there's no key the entries would be valid under
+		if (const auto* fontHash = m_face->getContentHash(system))
+			m_fontHash = *fontHash;
+		else
+			m_persistentCache = nullptr;
+	}
+}
+
+std::unique_ptr<GlyphAtlasCache::Page> GlyphAtlasCache::createPage() const
+{
+	auto page = std::make_unique<Page>();
+	const size_t bytes = size_t(m_pageExtents.x) * m_pageExtents.y * 4u;
+	page->buffer = core::make_smart_refctd_ptr<ICPUBuffer>(bytes);
+	// so the padding and unused space read as empty
+	memset(page->buffer->getPointer(), EmptyMSDFTexel, bytes);
+	// skyline packer is optimal with as many nodes as the width
+	page->nodes.resize(m_pageExtents.x);
+	stbrp_init_target(&page->packer, m_pageExtents.x, m_pageExtents.y, page->nodes.data(), page->nodes.size());
+	return page;
+}
+
+void GlyphAtlasCache::resetPage(Page& page)
+{
+	for (const auto& glyph : page.residentGlyphs)
+		m_resident.erase(glyph);
+	page.residentGlyphs.clear();
+	// the padding between the new glyphs can land on texels of the old ones, which would bleed in when filtering
+	memset(page.buffer->getPointer(), EmptyMSDFTexel, page.buffer->getSize());
+	stbrp_init_target(&page.packer, m_pageExtents.x, m_pageExtents.y, page.nodes.data(), page.nodes.size());
+}
+
+core::vector<GlyphAtlasCache::SGlyphLocation> GlyphAtlasCache::request(const std::span<const SGlyphRequest> glyphs)
+{
+	const uint64_t useCounter = ++m_useCounter;
+	auto getKey = [](const SGlyphRequest& glyph) -> SGlyphKey
+	{
+		return { glyph.glyphId, glyph.msdfPixelRange, glyph.extents.x, glyph.extents.y };
+	};
+
+	// mark pages of resident glyphs as used so they can't get evicted by this request, and gather the unique misses
+	core::vector<SGlyphKey> missing;
+	{
+		core::unordered_set<SGlyphKey, GlyphKeyHasher> missingSet;
+		for (const auto& glyph : glyphs)
+		{
+			const auto key = getKey(glyph);
+			auto found = m_resident.find(key);
+			if (found != m_resident.end())
+				m_pages[found->second.page]->lastUsed = useCounter;
+			else if (missingSet.insert(key).second)
+				missing.push_back(key);
+		}
+	}
+
+	struct SPlacedGlyph
+	{
+		SGlyphKey key;
+		uint32_t page;
+		uint32_t2 offset;
+	};
+	core::vector<SPlacedGlyph> placed;
+	if (!missing.empty())
+	{
+		core::vector<stbrp_rect> rects;
+		rects.reserve(missing.size());
+		for (uint32_t i = 0u; i < missing.size(); i++)
+		{
+			const uint32_t paddedW = missing[i].width + GlyphPadding;
+			const uint32_t paddedH = missing[i].height + GlyphPadding;
+			if (!missing[i].width || !missing[i].height || paddedW > m_pageExtents.x || paddedH > m_pageExtents.y)
+				continue;
+			stbrp_rect rect = {};
+			rect.id = i;
+			rect.w = paddedW;
+			rect.h = paddedH;
+			rects.push_back(rect);
+		}
+
+		auto packInto = [&](const uint32_t pageIx) -> void
+		{
+			auto& page = *m_pages[pageIx];
+			stbrp_pack_rects(&page.packer, rects.data(), rects.size());
+			auto unpacked = std::partition(rects.begin(), rects.end(), [](const stbrp_rect& rect) { return rect.was_packed != 0; });
+			if (unpacked == rects.begin())
+				return;
+			for (auto it = rects.begin(); it != unpacked; it++)
+			{
+				const auto& key = missing[it->id];
+				placed.push_back({ key, pageIx, uint32_t2(it->x, it->y) });
+				page.residentGlyphs.push_back(key);
+			}
+			page.lastUsed = useCounter;
+			page.dirty = true;
+			rects.erase(rects.begin(), unpacked);
+		};
+
+		// existing pages first, then new ones, then recycle the least recently used pages not needed by this request
+		for (uint32_t pageIx = 0u; pageIx < m_pages.size() && !rects.empty(); pageIx++)
+			packInto(pageIx);
+		while (!rects.empty() && m_pages.size() < m_maxPageCount)
+		{
+			m_pages.push_back(createPage());
+			packInto(m_pages.size() - 1u);
+		}
+		while (!rects.empty())
+		{
+			uint32_t victim = InvalidPage;
+			for (uint32_t pageIx = 0u; pageIx < m_pages.size(); pageIx++)
+			if (m_pages[pageIx]->lastUsed != useCounter && (victim == InvalidPage || m_pages[pageIx]->lastUsed < m_pages[victim]->lastUsed))
+				victim = pageIx;
+			if (victim == InvalidPage)
+				break;
+			resetPage(*m_pages[victim]);
+			// guarantees progress, a freshly reset page gets marked as used even if nothing fit
+			m_pages[victim]->lastUsed = useCounter;
+			packInto(victim);
+		}
+
+		for (const auto& glyph : placed)
+			m_resident.emplace(glyph.key, SGlyphLocation{ glyph.page, glyph.offset, uint32_t2(glyph.key.width, glyph.key.height) });
+	}
+
+	if (!placed.empty())
+	{
+		const size_t rowPitch = size_t(m_pageExtents.x) * 4u;
+		const core::blake3_hash_t& fontHash = m_fontHash;
+		auto getDst = [&](const SPlacedGlyph& glyph) -> int8_t*
+		{
+			return reinterpret_cast<int8_t*>(m_pages[glyph.page]->buffer->getPointer()) + glyph.offset.y * rowPitch + glyph.offset.x * 4u;
+		};
+		auto getPersistentKey = [&fontHash](const SGlyphKey& key) -> CPersistentCache::SKey
+		{
+			return { fontHash, key.glyphId, key.msdfPixelRange, key.width, key.height };
+		};
+
+		// warm start, copy whatever was generated in a previous run
+		core::vector<uint8_t> needsGenerating(placed.size(), true);
+		if (m_persistentCache)
+		std::for_each(core::execution::par, placed.begin(), placed.end(), [&](const SPlacedGlyph& glyph) -> void
+		{
+			const auto ix = std::distance(placed.data(), &glyph);
+			needsGenerating[ix] = !m_persistentCache->find(getPersistentKey(glyph.key), getDst(glyph), rowPitch);
+		});
+
+		// FreeType is not thread-safe, so outlines are extracted up front
+		core::vector<msdfgen::Shape> shapes(placed.size());
+		for (size_t i = 0u; i < placed.size(); i++)
+		if (needsGenerating[i])
+			shapes[i] = m_face->generateGlyphShape(placed[i].key.glyphId);
+
+		auto* const textRenderer = m_face->getTextRenderer();
+		std::for_each(core::execution::par, placed.begin(), placed.end(), [&](const SPlacedGlyph& glyph) -> void
+		{
+			const auto ix = std::distance(placed.data(), &glyph);
+			if (!needsGenerating[ix])
+				return;
+
+			int8_t* const dst = getDst(glyph);
+			const uint32_t2 extents(glyph.key.width, glyph.key.height);
+			auto& shape = shapes[ix];
+			// whitespace and the like have no outline, they still get a slot but it stays empty
+			if (shape.contours.empty())
+			{
+				for (uint32_t y = 0u; y < extents.y; y++)
+					memset(dst + y * rowPitch, EmptyMSDFTexel, extents.x * 4u);
+			}
+			else
+			{
+				float32_t2 scale, translate;
+				FontFace::getGlyphMSDFTransform(shape, glyph.key.msdfPixelRange, extents, scale, translate);
+				textRenderer->generateShapeMSDF(dst, rowPitch, std::move(shape), glyph.key.msdfPixelRange, extents, scale, translate);
+			}
+
+			if (m_persistentCache)
+				m_persistentCache->insert(getPersistentKey(glyph.key), dst, rowPitch);
+		});
+	}
+
+	core::vector<SGlyphLocation> retval(glyphs.size());
+	for (size_t i = 0u; i < glyphs.size(); i++)
+	{
+		auto found = m_resident.find(getKey(glyphs[i]));
+		if (found != m_resident.end())
+			retval[i] = found->second;
+	}
+	return retval;
+}
+
+core::vector<uint32_t> GlyphAtlasCache::takeDirtyPages()
+{
+	core::vector<uint32_t> retval;
+	for (uint32_t pageIx = 0u; pageIx < m_pages.size(); pageIx++)
+	if (m_pages[pageIx]->dirty)
+	{
+		retval.push_back(pageIx);
+		m_pages[pageIx]->dirty = false;
+	}
+	return retval;
+}
+
+}
+}
+}
@@ -6,10 +6,6 @@ using namespace nbl::video;
 #include "nabla.h"
 #include <nbl/ext/TextRendering/TextRendering.h>
 
-// TODO sticking to using this library?
-// #define STB_RECT_PACK_IMPLEMENTATION
-//#include <nbl/ext/TextRendering/stb_rect_pack.h>
-
 namespace nbl
 {
 namespace ext
@@ -18,39 +14,36 @@ namespace TextRendering
 {
 
 core::smart_refctd_ptr<ICPUBuffer> TextRenderer::generateShapeMSDF(msdfgen::Shape glyph, uint32_t msdfPixelRange, uint32_t2 msdfExtents, float32_t2 scale, float32_t2 translate)
+{
+	auto cpuBuf = core::make_smart_refctd_ptr<ICPUBuffer>(msdfExtents.x * msdfExtents.y * sizeof(int8_t) * 4);
+	generateShapeMSDF(reinterpret_cast<int8_t*>(cpuBuf->getPointer()), msdfExtents.x * sizeof(int8_t) * 4, std::move(glyph), msdfPixelRange, msdfExtents, scale, translate);
+	return std::move(cpuBuf);
+}
+
+void TextRenderer::generateShapeMSDF(int8_t* dst, size_t dstRowPitch, msdfgen::Shape glyph, uint32_t msdfPixelRange, uint32_t2 msdfExtents, float32_t2 scale, float32_t2 translate)
 {
 	uint32_t glyphW = msdfExtents.x;
 	uint32_t glyphH = msdfExtents.y;
 
-	auto shapeBounds = glyph.getBounds();
-
 	msdfgen::edgeColoringSimple(glyph, 3.0);
 	msdfgen::Bitmap<float, 4> msdfMap(glyphW, glyphH);
 
 	msdfgen::generateMTSDF(msdfMap, glyph, msdfPixelRange, { scale.x, scale.y }, { translate.x, translate.y });
 
-	auto cpuBuf = core::make_smart_refctd_ptr<ICPUBuffer>(glyphW * glyphH * sizeof(int8_t) * 4);
-	int8_t* data = reinterpret_cast<int8_t*>(cpuBuf->getPointer());
-	
 	auto floatToSNORM8 = [](const float fl) -> int8_t
 		{
 			// we need to invert values because msdfgen assigns positive values for shape interior which is the exact opposite of our convention
 			return -1 * (int8_t)(std::clamp(fl * 2.0f - 1.0f, -1.0f, 1.0f) * 127.f);
 		};
 
-	for (int y = 0; y < msdfMap.height(); ++y)
+	// msdfgen rows are tightly packed and bottom-up, so convert whole flipped rows at once instead of addressing every pixel
+	const uint32_t rowChannels = glyphW * 4;
+	for (uint32_t y = 0; y < glyphH; ++y)
 	{
-		for (int x = 0; x < msdfMap.width(); ++x)
-		{
-			auto pixel = msdfMap(x, glyphH - 1 - y);
-			data[(x + y * glyphW) * 4 + 0] = floatToSNORM8(pixel[0]);
-			data[(x + y * glyphW) * 4 + 1] = floatToSNORM8(pixel[1]);
-			data[(x + y * glyphW) * 4 + 2] = floatToSNORM8(pixel[2]);
-			data[(x + y * glyphW) * 4 + 3] = floatToSNORM8(pixel[3]);
-		}
+		const float* srcRow = msdfMap(0, glyphH - 1 - y);
+		int8_t* dstRow = dst + y * dstRowPitch;
+		std::transform(srcRow, srcRow + rowChannels, dstRow, floatToSNORM8);
 	}
-
-	return std::move(cpuBuf);
 }
 
 constexpr double FreeTypeFontScaling = 1.0 / 64.0;
@@ -82,6 +75,14 @@ core::smart_refctd_ptr<ICPUBuffer> FontFace::generateGlyphMSDF(uint32_t msdfPixe
 	// Empty shapes should've been filtered sooner
 	assert(!shape.contours.empty());
 
+	float32_t2 scale, translate;
+	getGlyphMSDFTransform(shape, msdfPixelRange, textureExtents, scale, translate);
+
+	return m_textRenderer->generateShapeMSDF(shape, msdfPixelRange, textureExtents, scale, translate);
+}
+
+void FontFace::getGlyphMSDFTransform(const msdfgen::Shape& shape, uint32_t msdfPixelRange, uint32_t2 textureExtents, float32_t2& outScale, float32_t2& outTranslate)
+{
 	auto shapeBounds = shape.getBounds();
 
 	float32_t2 frameSize = float32_t2(
@@ -99,9 +100,9 @@ core::smart_refctd_ptr<ICPUBuffer> FontFace::generateGlyphMSDF(uint32_t msdfPixe
 	// Plugging in the values and solving for translate yields:
 	// Translate = (msdfExtents / (2 * scale)) - ((shapeBounds.l + shapeBounds.r) * 0.5, (shapeBounds.t + shapeBounds.b) * 0.5)
 	const float32_t2 shapeSpaceCenter = float32_t2(shapeBounds.l + shapeBounds.r, shapeBounds.t + shapeBounds.b) * float32_t2(0.5);
-	const float32_t2 translate = float32_t2(textureExtents) / (float32_t2(2.0) * uniformScale) - shapeSpaceCenter;
+	outTranslate = float32_t2(textureExtents) / (float32_t2(2.0) * uniformScale) - shapeSpaceCenter;
 
-	return m_textRenderer->generateShapeMSDF(shape, msdfPixelRange, textureExtents, float32_t2(uniformScale, uniformScale), translate);
+	outScale = float32_t2(uniformScale, uniformScale);
 }
 
 float32_t2 FontFace::getUV(float32_t2 uv, float32_t2 glyphSize, uint32_t2 textureExtents, uint32_t msdfPixelRange)
@@ -149,6 +150,36 @@ int ftCubicToMSDF(const FT_Vector* control1, const FT_Vector* control2, const FT
 	return 0;
 }
 
+const core::blake3_hash_t* FontFace::getContentHash(system::ISystem* system)
+{
+	std::lock_guard lk(m_contentHashLock);
+	if (m_contentHash)
+		return &m_contentHash.value();
+	if (!system)
+		return nullptr;
+
+	system::ISystem::future_t<core::smart_refctd_ptr<system::IFile>> future;
+	system->createFile(future, m_path, system::IFile::ECF_READ);
+	auto file = future.acquire();
+	if (!file || !*file)
+		return nullptr;
+
+	core::blake3_hasher hasher;
+	const size_t fileSize = file->get()->getSize();
+	core::vector<uint8_t> chunk(core::min<size_t>(fileSize, 0x1u<<20u));
+	for (size_t offset = 0u; offset < fileSize; offset += chunk.size())
+	{
+		const size_t size = core::min(chunk.size(), fileSize - offset);
+		system::IFile::success_t success;
+		file->get()->read(success, chunk.data(), offset, size);
+		if (!success)
+			return nullptr;
+		hasher.update(chunk.data(), size);
+	}
+	m_contentHash = static_cast<core::blake3_hash_t>(hasher);
+	return &m_contentHash.value();
+}
+
 msdfgen::Shape FontFace::generateGlyphShape(uint32_t glyphId)
 {
 	auto slot = getGlyphSlot(glyphId);
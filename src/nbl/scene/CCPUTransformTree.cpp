@@ -0,0 +1,303 @@
+// Copyright (C) 2018-2023 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#include "nbl/scene/CCPUTransformTree.h"
+#include "nbl/core/execution.h"
+
+#include <numeric>
+
+
+using namespace nbl;
+using namespace scene;
+
+
+uint32_t CCPUTransformTree::appendSlot(const node_t node, const relative_transform_t& transform)
+{
+	const uint32_t slot = m_slotToNode.size();
+	m_slotToNode.push_back(node);
+	m_parentSlots.push_back(invalid_slot);
+	m_relativeTransforms.push_back(transform);
+	m_modifiedStamps.push_back(initial_modified_timestamp);
+	m_globalTransforms.push_back(transform);
+	m_recomputedStamps.push_back(initial_recomputed_timestamp);
+	return slot;
+}
+
+void CCPUTransformTree::addNodes(const std::span<node_t> outNodes, const std::span<const parent_t> parents, const std::span<const relative_transform_t> relativeTransforms)
+{
+	assert(parents.empty() || parents.size()==outNodes.size());
+	assert(relativeTransforms.empty() || relativeTransforms.size()==outNodes.size());
+	for (size_t i=0ull; i<outNodes.size(); i++)
+	{
+		node_t node;
+		if (m_freeNodes.empty())
+		{
+			node = m_nodeToSlot.size();
+			m_nodeToSlot.push_back(invalid_slot);
+			m_parents.push_back(invalid_node);
+		}
+		else
+		{
+			node = m_freeNodes.back();
+			m_freeNodes.pop_back();
+		}
+
+		const parent_t parent = parents.empty() ? invalid_node:parents[i];
+		assert(parent==invalid_node || (parent<m_nodeToSlot.size() && m_nodeToSlot[parent]!=invalid_slot));
+		m_parents[node] = parent;
+		m_nodeToSlot[node] = appendSlot(node,relativeTransforms.empty() ? relative_transform_t():relativeTransforms[i]);
+		m_modifiedNodes.push_back(node);
+		outNodes[i] = node;
+	}
+	m_nodeCount += outNodes.size();
+	m_topologyChanged = m_topologyChanged || !outNodes.empty();
+}
+
+void CCPUTransformTree::removeNodes(const std::span<const node_t> nodes)
+{
+	if (nodes.empty())
+		return;
+
+	core::vector<uint8_t> removed(m_nodeToSlot.size(),0u);
+	for (const auto node : nodes)
+	{
+		const uint32_t slot = m_nodeToSlot[node];
+		if (slot==invalid_slot)
+			continue;
+		m_slotToNode[slot] = invalid_node;
+		m_nodeToSlot[node] = invalid_slot;
+		m_parents[node] = invalid_node;
+		m_freeNodes.push_back(node);
+		removed[node] = 1u;
+		m_nodeCount--;
+	}
+	// orphans have to be found now, before their parent's handle gets reused
+	for (node_t node=0u; node<m_parents.size(); node++)
+	{
+		const parent_t parent = m_parents[node];
+		if (parent!=invalid_node && removed[parent])
+		{
+			m_parents[node] = invalid_node;
+			m_modifiedNodes.push_back(node);
+		}
+	}
+	m_topologyChanged = true;
+}
+
+void CCPUTransformTree::clearNodes()
+{
+	m_nodeToSlot.clear();
+	m_parents.clear();
+	m_freeNodes.clear();
+	m_slotToNode.clear();
+	m_parentSlots.clear();
+	m_relativeTransforms.clear();
+	m_modifiedStamps.clear();
+	m_globalTransforms.clear();
+	m_recomputedStamps.clear();
+	m_firstChildSlots.clear();
+	m_childCounts.clear();
+	m_subtreeSizes.clear();
+	m_levelBegin.clear();
+	m_modifiedNodes.clear();
+	m_queued.clear();
+	m_nodeCount = 0u;
+	m_topologyChanged = false;
+}
+
+bool CCPUTransformTree::setParent(const node_t node, const parent_t parent)
+{
+	for (parent_t ancestor=parent; ancestor!=invalid_node; ancestor=m_parents[ancestor])
+	if (ancestor==node)
+		return false;
+
+	if (m_parents[node]!=parent)
+	{
+		m_parents[node] = parent;
+		m_modifiedNodes.push_back(node);
+		m_topologyChanged = true;
+	}
+	return true;
+}
+
+void CCPUTransformTree::setRelativeTransform(const node_t node, const relative_transform_t& transform)
+{
+	const uint32_t slot = m_nodeToSlot[node];
+	m_relativeTransforms[slot] = transform;
+	m_modifiedStamps[slot] = m_currentTimestamp;
+	m_modifiedNodes.push_back(node);
+}
+
+void CCPUTransformTree::relayout()
+{
+	const uint32_t nodeHandleCount = m_nodeToSlot.size();
+
+	// children of every node handle, in their current slot order so siblings keep their relative order
+	core::vector<uint32_t> childOffsets(nodeHandleCount+1u,0u);
+	for (const auto node : m_slotToNode)
+	if (node!=invalid_node && m_parents[node]!=invalid_node)
+		childOffsets[m_parents[node]+1u]++;
+	for (uint32_t node=0u; node<nodeHandleCount; node++)
+		childOffsets[node+1u] += childOffsets[node];
+	core::vector<node_t> children(childOffsets.back());
+	{
+		core::vector<uint32_t> cursors(childOffsets.begin(),childOffsets.end()-1);
+		for (const auto node : m_slotToNode)
+		if (node!=invalid_node && m_parents[node]!=invalid_node)
+			children[cursors[m_parents[node]]++] = node;
+	}
+
+	// breadth-first, which makes every depth level and every node's children contiguous
+	core::vector<node_t> order;
+	order.reserve(m_nodeCount);
+	for (const auto node : m_slotToNode)
+	if (node!=invalid_node && m_parents[node]==invalid_node)
+		order.push_back(node);
+	m_levelBegin.clear();
+	m_levelBegin.push_back(0u);
+	for (size_t levelBegin=0ull; levelBegin<order.size();)
+	{
+		const size_t levelEnd = order.size();
+		m_levelBegin.push_back(levelEnd);
+		for (size_t i=levelBegin; i<levelEnd; i++)
+		{
+			const node_t node = order[i];
+			order.insert(order.end(),children.begin()+childOffsets[node],children.begin()+childOffsets[node+1u]);
+		}
+		levelBegin = levelEnd;
+	}
+	assert(order.size()==m_nodeCount);
+
+	// permute the properties
+	{
+		core::vector<relative_transform_t> relativeTransforms(m_nodeCount);
+		core::vector<modified_stamp_t> modifiedStamps(m_nodeCount);
+		core::vector<global_transform_t> globalTransforms(m_nodeCount);
+		core::vector<recomputed_stamp_t> recomputedStamps(m_nodeCount);
+		for (uint32_t slot=0u; slot<m_nodeCount; slot++)
+		{
+			const node_t node = order[slot];
+			const uint32_t oldSlot = m_nodeToSlot[node];
+			relativeTransforms[slot] = m_relativeTransforms[oldSlot];
+			modifiedStamps[slot] = m_modifiedStamps[oldSlot];
+			globalTransforms[slot] = m_globalTransforms[oldSlot];
+			recomputedStamps[slot] = m_recomputedStamps[oldSlot];
+			m_nodeToSlot[node] = slot;
+		}
+		m_relativeTransforms = std::move(relativeTransforms);
+		m_modifiedStamps = std::move(modifiedStamps);
+		m_globalTransforms = std::move(globalTransforms);
+		m_recomputedStamps = std::move(recomputedStamps);
+	}
+	m_slotToNode = std::move(order);
+
+	m_parentSlots.resize(m_nodeCount);
+	m_firstChildSlots.resize(m_nodeCount);
+	m_childCounts.resize(m_nodeCount);
+	m_subtreeSizes.assign(m_nodeCount,1u);
+	m_queued.assign(m_nodeCount,0u);
+	uint32_t nextChildSlot = m_levelBegin.size()>1u ? m_levelBegin[1]:0u;
+	for (uint32_t slot=0u; slot<m_nodeCount; slot++)
+	{
+		const node_t node = m_slotToNode[slot];
+		const parent_t parent = m_parents[node];
+		m_parentSlots[slot] = parent!=invalid_node ? m_nodeToSlot[parent]:invalid_slot;
+		m_firstChildSlots[slot] = nextChildSlot;
+		m_childCounts[slot] = childOffsets[node+1u]-childOffsets[node];
+		nextChildSlot += m_childCounts[slot];
+	}
+	// children always come after their parents
+	for (uint32_t slot=m_nodeCount; slot--;)
+	if (m_parentSlots[slot]!=invalid_slot)
+		m_subtreeSizes[m_parentSlots[slot]] += m_subtreeSizes[slot];
+}
+
+void CCPUTransformTree::recomputeGlobalTransforms()
+{
+	if (m_topologyChanged)
+	{
+		relayout();
+		m_topologyChanged = false;
+	}
+
+	if (!m_modifiedNodes.empty() && m_nodeCount)
+	{
+		core::vector<uint32_t> modifiedSlots;
+		modifiedSlots.reserve(m_modifiedNodes.size());
+		for (const auto node : m_modifiedNodes)
+		if (node<m_nodeToSlot.size() && m_nodeToSlot[node]!=invalid_slot)
+			modifiedSlots.push_back(m_nodeToSlot[node]);
+		std::sort(modifiedSlots.begin(),modifiedSlots.end());
+		modifiedSlots.erase(std::unique(modifiedSlots.begin(),modifiedSlots.end()),modifiedSlots.end());
+
+		auto updateSlot = [this](const uint32_t slot) -> void
+		{
+			const uint32_t parentSlot = m_parentSlots[slot];
+			if (parentSlot!=invalid_slot)
+				m_globalTransforms[slot] = core::matrix3x4SIMD::concatenateBFollowedByA(m_globalTransforms[parentSlot],m_relativeTransforms[slot]);
+			else
+				m_globalTransforms[slot] = m_relativeTransforms[slot];
+			m_recomputedStamps[slot] = m_modifiedStamps[slot];
+		};
+		// all slots of one level are independent, their parents are in the previous level
+		auto updateLevel = [&updateSlot](const uint32_t* begin, const uint32_t* end) -> void
+		{
+			auto update = [&updateSlot](const uint32_t& slot) -> void {updateSlot(slot);};
+			if (end-begin<MinParallelLevelSize)
+				std::for_each(begin,end,update);
+			else
+				std::for_each(core::execution::par_unseq,begin,end,update);
+		};
+
+		// subtrees of nested modified nodes get counted twice, that's fine for a heuristic
+		uint64_t estimatedDirtyCount = 0ull;
+		for (const auto slot : modifiedSlots)
+			estimatedDirtyCount += m_subtreeSizes[slot];
+
+		const uint32_t levelCount = m_levelBegin.size()-1u;
+		if (estimatedDirtyCount>uint64_t(FullSweepRatio*m_nodeCount))
+		{
+			core::vector<uint32_t> slots(m_nodeCount);
+			std::iota(slots.begin(),slots.end(),0u);
+			for (uint32_t level=0u; level<levelCount; level++)
+				updateLevel(slots.data()+m_levelBegin[level],slots.data()+m_levelBegin[level+1u]);
+		}
+		else
+		{
+			core::vector<uint32_t> frontier,nextFrontier;
+			auto modifiedIt = modifiedSlots.begin();
+			for (uint32_t level=0u; level<levelCount && (!frontier.empty() || modifiedIt!=modifiedSlots.end()); level++)
+			{
+				// descendants of last level's updates are already queued
+				for (; modifiedIt!=modifiedSlots.end() && *modifiedIt<m_levelBegin[level+1u]; modifiedIt++)
+				if (!m_queued[*modifiedIt])
+				{
+					m_queued[*modifiedIt] = 1u;
+					frontier.push_back(*modifiedIt);
+				}
+				if (frontier.empty())
+					continue;
+
+				updateLevel(frontier.data(),frontier.data()+frontier.size());
+
+				nextFrontier.clear();
+				for (const auto slot : frontier)
+				{
+					m_queued[slot] = 0u;
+					const uint32_t firstChild = m_firstChildSlots[slot];
+					for (uint32_t child=firstChild; child<firstChild+m_childCounts[slot]; child++)
+					{
+						m_queued[child] = 1u;
+						nextFrontier.push_back(child);
+					}
+				}
+				std::swap(frontier,nextFrontier);
+			}
+			assert(frontier.empty());
+		}
+	}
+	m_modifiedNodes.clear();
+
+	m_currentTimestamp = m_currentTimestamp<max_timestamp ? (m_currentTimestamp+1u):min_timestamp;
+}
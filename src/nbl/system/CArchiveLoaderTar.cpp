@@ -1,4 +1,5 @@
 #include "nbl/system/CArchiveLoaderTar.h"
+#include "nbl/system/ISystem.h"
 
 
 enum E_TAR_LINK_INDICATOR
@@ -35,8 +36,47 @@ struct STarHeader
 	char DeviceMinor[8];
 	char FileNamePrefix[155];
 } PACK_STRUCT;
+
+// member list sidecar, the entries and the path characters of all the members follow the header
+struct STarIndexHeader
+{
+	char Magic[8];
+	uint32_t Version;
+	uint32_t EntryCount;
+	uint64_t ArchiveSize;
+	int64_t ArchiveLastWriteTime;
+	uint64_t PathsSize;
+} PACK_STRUCT;
+struct STarIndexEntry
+{
+	uint64_t Offset;
+	uint64_t Size;
+	uint32_t PathOffset;
+	uint32_t PathLength;
+} PACK_STRUCT;
 #include "nbl/nblunpack.h"
 
+static constexpr char TarIndexMagic[8] = "NBLTARI";
+static constexpr uint32_t TarIndexVersion = 1u;
+
+// octal, unless GNU tar had to store a size which doesn't fit in 11 octal digits (8GB+) as big endian binary with the high bit set
+static size_t parseTarSize(const char (&field)[12])
+{
+	size_t size = 0ull;
+	if (uint8_t(field[0])&0x80u)
+	{
+		for (size_t i=1ull; i<sizeof(field); i++)
+			size = (size<<8ull)|uint8_t(field[i]);
+		return size;
+	}
+	size_t i = 0ull;
+	while (i<sizeof(field) && field[i]==' ')
+		i++;
+	for (; i<sizeof(field) && field[i]>='0' && field[i]<='7'; i++)
+		size = (size<<3ull)|size_t(field[i]-'0');
+	return size;
+}
+
 
 using namespace nbl;
 using namespace nbl::system;
@@ -44,7 +84,9 @@ using namespace nbl::system;
 CFileArchive::file_buffer_t CArchiveLoaderTar::CArchive::getFileBuffer(const IFileArchive::SFileList::found_t& found)
 {
 	assert(found->allocatorType==EAT_NULL);
-	return {reinterpret_cast<uint8_t*>(m_file->getMappedPointer())+found->offset,found->size,nullptr};
+	// the archive is only mapped for reading, and so are its members
+	const auto* archive = reinterpret_cast<const uint8_t*>(static_cast<const IFile*>(m_file.get())->getMappedPointer());
+	return {const_cast<uint8_t*>(archive)+found->offset,found->size,nullptr};
 }
 
 
@@ -93,71 +135,56 @@ bool CArchiveLoaderTar::isALoadableFileFormat(IFile* file) const
 	return checksum1 == checksum || checksum2 == (int32_t)checksum;
 }
 
-core::smart_refctd_ptr<IFileArchive> CArchiveLoaderTar::createArchive_impl(core::smart_refctd_ptr<system::IFile>&& file, const std::string_view& password) const
+auto CArchiveLoaderTar::scanHeaders(const uint8_t* archive, const size_t archiveSize) const -> entries_t
 {
-	if (!file || !(file->getFlags()&IFileBase::ECF_MAPPABLE))
-		return nullptr;
+	auto items = std::make_shared<core::vector<IFileArchive::SFileList::SEntry>>();
+	// headers get read straight from the mapping
+	for (size_t pos=0ull; pos+BlockSize<=archiveSize; )
+	{
+		// the archive ends with zero blocks
+		if (std::all_of(archive+pos,archive+pos+BlockSize,[](const uint8_t c)->bool{return c==0u;}))
+			break;
 
-	std::shared_ptr<core::vector<IFileArchive::SFileList::SEntry>> items = std::make_shared<core::vector<IFileArchive::SFileList::SEntry>>();
+		const auto& fHead = *reinterpret_cast<const STarHeader*>(archive+pos);
+		const size_t size = parseTarSize(fHead.Size);
+		const size_t offset = pos+BlockSize;
+		// every kind of entry can have data blocks, not only regular files
+		pos = offset+core::roundUp(size,BlockSize);
 
-	for (size_t pos=0ull; true; )
-	{
-		STarHeader fHead;
-		{
-			IFile::success_t success;
-			file->read(success,&fHead,pos,sizeof(fHead));
-			if (!success)
-				break;
-		}
 		// only add standard files for now
 		switch (fHead.Link)
 		{
 			case ETLI_REGULAR_FILE:
 				[[fallthrough]];
+			case ETLI_CONTIGUOUS_FILE:
+				[[fallthrough]];
 			case ETLI_REGULAR_FILE_OLD:
 			{
-				std::string fullPath = "";
-				fullPath.reserve(256);
-
-				// USTAR archives have a filename prefix
-				// may not be null terminated, copy carefully!
-				if (!strncmp(fHead.Magic, "ustar", 5))
+				// fields may not be null terminated, copy carefully!
+				auto getField = []<size_t N>(const char (&field)[N]) -> std::string_view
 				{
-					char* np = fHead.FileNamePrefix;
-					while (*np && (np - fHead.FileNamePrefix) < 155)
-						fullPath += *np;
-					np++;
-				}
+					return std::string_view(field,std::find(field,field+N,'\0')-field);
+				};
 
-				// append the file name
-				char* np = fHead.FileName;
-				while (*np && (np - fHead.FileName) < 100)
+				std::string fullPath;
+				// USTAR archives have a filename prefix
+				if (!strncmp(fHead.Magic,"ustar",5))
 				{
-					fullPath += *np;
-					np++;
+					const auto prefix = getField(fHead.FileNamePrefix);
+					if (!prefix.empty())
+					{
+						fullPath = prefix;
+						fullPath += '/';
+					}
 				}
+				fullPath += getField(fHead.FileName);
 
-				// get size
-				std::string sSize = "";
-				sSize.reserve(12);
-				np = fHead.Size;
-				while (*np && (np - fHead.Size) < 12)
+				if (offset+size>archiveSize)
 				{
-					sSize += *np;
-					np++;
+					m_logger.log("File %s goes past the end of the archive", ILogger::ELL_ERROR, fullPath.c_str());
+					return items;
 				}
 
-				// TODO: this is horrible, replace
-				const size_t size = strtoul(sSize.c_str(), NULL, 8);
-				if (errno == ERANGE)
-					m_logger.log("File %s is too large", ILogger::ELL_WARNING, fullPath.c_str());
-
-				// save start position
-				const uint32_t offset = pos + BlockSize;
-
-				// move to next file header block
-				pos = offset + core::roundUp(size,BlockSize);
-
 				// add file to list
 				auto& item = items->emplace_back();
 				item.pathRelativeToArchive = fullPath;
@@ -169,13 +196,146 @@ core::smart_refctd_ptr<IFileArchive> CArchiveLoaderTar::createArchive_impl(core:
 			}
 			// TODO: ETLI_DIRECTORY, ETLI_LINK_TO_ARCHIVED_FILE
 			default:
-				// move to next block
-				pos += BlockSize;
 				break;
 		}
 	}
+	return items;
+}
+
+auto CArchiveLoaderTar::readIndexSidecar(const path& sidecarPath, const SArchiveStamp& stamp) const -> entries_t
+{
+	std::error_code ec;
+	if (!std::filesystem::exists(sidecarPath,ec))
+		return nullptr;
+
+	ISystem::future_t<core::smart_refctd_ptr<IFile>> future;
+	m_system->createFile(future,sidecarPath,core::bitflag<IFileBase::E_CREATE_FLAGS>(IFileBase::ECF_READ)|IFileBase::ECF_MAPPABLE);
+	if (!future.wait())
+		return nullptr;
+	const auto file = future.copy();
+	if (!file)
+		return nullptr;
+
+	// used straight from the mapping, the only copies made are the `SEntry`s themselves
+	const auto* data = reinterpret_cast<const uint8_t*>(static_cast<const IFile*>(file.get())->getMappedPointer());
+	const size_t fileSize = file->getSize();
+	if (!data || fileSize<sizeof(STarIndexHeader))
+		return nullptr;
+	const auto& header = *reinterpret_cast<const STarIndexHeader*>(data);
+	if (memcmp(header.Magic,TarIndexMagic,sizeof(TarIndexMagic)) || header.Version!=TarIndexVersion)
+		return nullptr;
+	if (header.ArchiveSize!=stamp.size || header.ArchiveLastWriteTime!=stamp.lastWriteTime)
+	{
+		m_logger.log("Index sidecar %s is out of date, the archive will be scanned", ILogger::ELL_INFO, sidecarPath.string().c_str());
+		return nullptr;
+	}
+	const size_t entriesSize = size_t(header.EntryCount)*sizeof(STarIndexEntry);
+	if (fileSize!=sizeof(STarIndexHeader)+entriesSize+header.PathsSize)
+		return nullptr;
+	const auto* indexEntries = reinterpret_cast<const STarIndexEntry*>(data+sizeof(STarIndexHeader));
+	const char* paths = reinterpret_cast<const char*>(data+sizeof(STarIndexHeader)+entriesSize);
+
+	auto items = std::make_shared<core::vector<IFileArchive::SFileList::SEntry>>(header.EntryCount);
+	for (uint32_t i=0u; i<header.EntryCount; i++)
+	{
+		const STarIndexEntry in = indexEntries[i];
+		// a corrupt sidecar must not make members point outside the archive
+		if (in.Offset>stamp.size || in.Size>stamp.size-in.Offset || in.PathOffset>header.PathsSize || in.PathLength>header.PathsSize-in.PathOffset)
+		{
+			m_logger.log("Index sidecar %s is corrupt, the archive will be scanned", ILogger::ELL_WARNING, sidecarPath.string().c_str());
+			return nullptr;
+		}
+		auto& item = (*items)[i];
+		item.pathRelativeToArchive = std::string_view(paths+in.PathOffset,in.PathLength);
+		item.size = in.Size;
+		item.offset = in.Offset;
+		item.ID = i;
+		item.allocatorType = IFileArchive::EAT_NULL;
+	}
+	return items;
+}
+
+void CArchiveLoaderTar::writeIndexSidecar(const path& sidecarPath, const SArchiveStamp& stamp, const core::vector<IFileArchive::SFileList::SEntry>& entries) const
+{
+	STarIndexHeader header = {};
+	memcpy(header.Magic,TarIndexMagic,sizeof(TarIndexMagic));
+	header.Version = TarIndexVersion;
+	header.EntryCount = entries.size();
+	header.ArchiveSize = stamp.size;
+	header.ArchiveLastWriteTime = stamp.lastWriteTime;
+
+	core::vector<STarIndexEntry> indexEntries(entries.size());
+	std::string paths;
+	for (size_t i=0ull; i<entries.size(); i++)
+	{
+		const std::string entryPath = entries[i].pathRelativeToArchive.generic_string();
+		indexEntries[i] = {entries[i].offset,entries[i].size,uint32_t(paths.size()),uint32_t(entryPath.size())};
+		paths += entryPath;
+	}
+	header.PathsSize = paths.size();
+
+	// everything goes out in one write
+	core::vector<uint8_t> data(sizeof(header)+indexEntries.size()*sizeof(STarIndexEntry)+paths.size());
+	memcpy(data.data(),&header,sizeof(header));
+	memcpy(data.data()+sizeof(header),indexEntries.data(),indexEntries.size()*sizeof(STarIndexEntry));
+	memcpy(data.data()+sizeof(header)+indexEntries.size()*sizeof(STarIndexEntry),paths.data(),paths.size());
+
+	// files don't get truncated when opened for writing, and a stale sidecar could be longer
+	std::error_code ec;
+	std::filesystem::remove(sidecarPath,ec);
+
+	ISystem::future_t<core::smart_refctd_ptr<IFile>> future;
+	m_system->createFile(future,sidecarPath,core::bitflag<IFileBase::E_CREATE_FLAGS>(IFileBase::ECF_WRITE));
+	core::smart_refctd_ptr<IFile> file;
+	if (future.wait())
+		file = future.copy();
+	// the archive might be somewhere read-only, the sidecar is just a cache
+	if (!file)
+	{
+		m_logger.log("Could not create index sidecar %s", ILogger::ELL_INFO, sidecarPath.string().c_str());
+		return;
+	}
+	IFile::success_t success;
+	file->write(success,data.data(),0ull,data.size());
+	if (!success)
+		m_logger.log("Failed to write index sidecar %s", ILogger::ELL_WARNING, sidecarPath.string().c_str());
+}
+
+core::smart_refctd_ptr<IFileArchive> CArchiveLoaderTar::createArchive_impl(core::smart_refctd_ptr<system::IFile>&& file, const std::string_view& password) const
+{
+	if (!file || !(file->getFlags()&IFileBase::ECF_MAPPABLE))
+		return nullptr;
+	const auto* archive = reinterpret_cast<const uint8_t*>(static_cast<const IFile*>(file.get())->getMappedPointer());
+	if (!archive)
+		return nullptr;
+	const size_t archiveSize = file->getSize();
+
+	// only archives which are files on disk have a last write time to check a sidecar against
+	path sidecarPath;
+	SArchiveStamp stamp = {archiveSize,0};
+	if (m_system && m_system->areTarIndexSidecarsEnabled())
+	{
+		std::error_code ec;
+		const auto lastWriteTime = std::filesystem::last_write_time(file->getFileName(),ec);
+		if (!ec)
+		{
+			sidecarPath = file->getFileName();
+			sidecarPath += IndexSidecarExtension;
+			stamp.lastWriteTime = lastWriteTime.time_since_epoch().count();
+		}
+	}
+
+	entries_t items;
+	if (!sidecarPath.empty())
+		items = readIndexSidecar(sidecarPath,stamp);
+	if (!items)
+	{
+		items = scanHeaders(archive,archiveSize);
+		if (!sidecarPath.empty() && items->size()>=MinEntriesForIndexSidecar)
+			writeIndexSidecar(sidecarPath,stamp,*items);
+	}
 	if (items->empty())
 		return nullptr;
 
 	return core::make_smart_refctd_ptr<CArchive>(std::move(file),core::smart_refctd_ptr(m_logger.get()),items);
-}
\ No newline at end of file
+}
@@ -7,6 +7,7 @@
 
 namespace nbl::system
 {
+class ISystem;
 
 class CArchiveLoaderTar final : public IArchiveLoader
 {
@@ -18,11 +19,16 @@ class CArchiveLoaderTar final : public IArchiveLoader
 					CFileArchive(path(_file->getFileName()),std::move(logger),_items), m_file(std::move(_file)) {}
 
 			protected:
+				// members are views straight into the archive's read-only mapping, nothing gets copied,
+				// which means writing through a member's `IFile::getMappedPointer()` faults
 				file_buffer_t getFileBuffer(const IFileArchive::SFileList::found_t& item) override;
 
 				core::smart_refctd_ptr<IFile> m_file;
 		};
 
+		//! Only the loader an `ISystem` registers for itself can use index sidecars, and only after `ISystem::setTarIndexSidecarsEnabled(true)`.
+		//! Then the member list of archives on disk gets cached in a sidecar file next to them (archive path + `IndexSidecarExtension`),
+		//! which is used instead of scanning every header for as long as the archive's size and last write time match the ones it was made for.
 		CArchiveLoaderTar(system::logger_opt_smart_ptr&& logger) : IArchiveLoader(std::move(logger)) {}
 
 		bool isALoadableFileFormat(IFile* file) const override;
@@ -33,10 +39,30 @@ class CArchiveLoaderTar final : public IArchiveLoader
 			return ext;
 		}
 
+		static inline constexpr const char* IndexSidecarExtension = ".nblidx";
+		//! archives with fewer members are quick enough to scan, so they don't get a sidecar written
+		static inline constexpr size_t MinEntriesForIndexSidecar = 1024ull;
+
 	private:
 		static constexpr size_t BlockSize = 512ull;
 
+		using entries_t = std::shared_ptr<core::vector<IFileArchive::SFileList::SEntry>>;
+		// what a sidecar has to match to be used
+		struct SArchiveStamp
+		{
+			uint64_t size;
+			int64_t lastWriteTime;
+		};
+		entries_t scanHeaders(const uint8_t* archive, const size_t archiveSize) const;
+		//! returns null if there's no sidecar or it doesn't match the archive
+		entries_t readIndexSidecar(const path& sidecarPath, const SArchiveStamp& stamp) const;
+		void writeIndexSidecar(const path& sidecarPath, const SArchiveStamp& stamp, const core::vector<IFileArchive::SFileList::SEntry>& entries) const;
+
 		core::smart_refctd_ptr<IFileArchive> createArchive_impl(core::smart_refctd_ptr<system::IFile>&& file, const std::string_view& password) const override;
+
+		// set only by the `ISystem` which owns this loader and never hands it out, so it can't outlive the system
+		friend class ISystem;
+		ISystem* m_system = nullptr;
 };
 
 }
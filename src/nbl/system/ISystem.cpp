@@ -18,7 +18,11 @@ using namespace nbl::system;
 ISystem::ISystem(core::smart_refctd_ptr<ISystem::ICaller>&& caller) : m_dispatcher(std::move(caller))
 {
     addArchiveLoader(core::make_smart_refctd_ptr<CArchiveLoaderZip>(nullptr));
-    addArchiveLoader(core::make_smart_refctd_ptr<CArchiveLoaderTar>(nullptr));
+    {
+        auto tarLoader = core::make_smart_refctd_ptr<CArchiveLoaderTar>(nullptr);
+        tarLoader->m_system = this;
+        addArchiveLoader(std::move(tarLoader));
+    }
     
     #ifdef NBL_EMBED_BUILTIN_RESOURCES
     mount(core::make_smart_refctd_ptr<nbl::builtin::CArchive>(nullptr));
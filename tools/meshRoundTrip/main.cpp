@@ -0,0 +1,301 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#include "nabla.h"
+#include "nbl/system/IApplicationFramework.h"
+
+#include <array>
+#include <cstdio>
+
+using namespace nbl;
+using namespace nbl::system;
+using namespace nbl::core;
+using namespace nbl::asset;
+
+// Load -> write -> load round trips through the STL and PLY loaders and writers. The mesh is generated big enough for every
+// parallel path to see more than one chunk (binary STL triangle chunks, ASCII PLY line chunks, PLY writer blocks).
+class MeshRoundTrip final : public system::IApplicationFramework
+{
+	using base_t = system::IApplicationFramework;
+
+public:
+	using base_t::base_t;
+
+	bool onAppInitialized(smart_refctd_ptr<ISystem>&& system) override
+	{
+		if (system)
+			m_system = std::move(system);
+		else
+			m_system = system::IApplicationFramework::createSystem();
+#ifdef _NBL_PLATFORM_LINUX_
+		if (!m_system)
+			m_system = make_smart_refctd_ptr<CSystemLinux>();
+#endif
+		if (!m_system)
+			return false;
+
+		m_logger = make_smart_refctd_ptr<CStdoutLogger>(core::bitflag(ILogger::ELL_INFO) | ILogger::ELL_WARNING | ILogger::ELL_ERROR);
+
+		if (argv.size() < 2)
+		{
+			m_logger->log("Usage: meshroundtrip <output directory>", ILogger::ELL_ERROR);
+			return false;
+		}
+		const path outputDirectory = argv[1];
+		std::filesystem::create_directories(outputDirectory);
+
+		m_assetMgr = make_smart_refctd_ptr<IAssetManager>(smart_refctd_ptr(m_system));
+
+		const SGrid grid = generateGrid();
+		const path stlPath = outputDirectory/"grid.stl";
+		const path plyPath = outputDirectory/"grid.ply";
+		if (!writeFile(stlPath, encodeBinarySTL(grid)) || !writeFile(plyPath, encodeASCIIPLY(grid)))
+			return false;
+
+		// the grid is mirror symmetric in X, so the loaders and writers flipping X for handedness can't make a correct round trip compare unequal
+		bool success = compare("binary STL load", grid.getTriangles(), loadTriangles(stlPath, IAssetLoader::ELPF_NONE));
+		success &= compare("ASCII PLY load", grid.getTriangles(), loadTriangles(plyPath, IAssetLoader::ELPF_NONE));
+		success &= checkRoundTrip(stlPath, outputDirectory/"grid_binary.stl", EWF_BINARY);
+		success &= checkRoundTrip(stlPath, outputDirectory/"grid_ascii.stl", EWF_NONE);
+		success &= checkRoundTrip(plyPath, outputDirectory/"grid_ascii.ply", EWF_NONE);
+		success &= checkRoundTrip(plyPath, outputDirectory/"grid_binary.ply", EWF_BINARY);
+		success &= checkWelding(stlPath);
+
+		if (success)
+			m_logger->log("All mesh round trips passed.", ILogger::ELL_INFO);
+		return success;
+	}
+
+	void workLoopBody() override {}
+
+	bool keepRunning() override { return false; }
+
+private:
+	using vertex_t = std::array<float, 3>;
+	// vertices sorted, so the comparison doesn't depend on the winding (the ASCII STL writer reverses it) or the vertex order
+	using triangle_t = std::array<vertex_t, 3>;
+
+	struct SGrid
+	{
+		core::vector<vertex_t> positions;
+		core::vector<std::array<uint32_t, 3>> triangles;
+
+		core::vector<triangle_t> getTriangles() const
+		{
+			core::vector<triangle_t> retval;
+			retval.reserve(triangles.size());
+			for (const auto& triangle : triangles)
+			{
+				triangle_t& out = retval.emplace_back();
+				for (uint32_t k = 0u; k < 3u; k++)
+					out[k] = positions[triangle[k]];
+				std::sort(out.begin(), out.end());
+			}
+			std::sort(retval.begin(), retval.end());
+			return retval;
+		}
+	};
+
+	// 301x301 vertices and 180000 triangles, coordinates are multiples of 1/8 so the ASCII formats store them exactly,
+	// the height only depends on the row so every strip of triangles is planar and has vertices to weld
+	static SGrid generateGrid()
+	{
+		constexpr int32_t HalfWidth = 150;
+		constexpr uint32_t Rows = 300u;
+		constexpr uint32_t RowSize = 2u * HalfWidth + 1u;
+
+		SGrid grid;
+		grid.positions.reserve(RowSize * (Rows + 1u));
+		for (uint32_t j = 0u; j <= Rows; j++)
+		for (int32_t i = -HalfWidth; i <= HalfWidth; i++)
+			grid.positions.push_back({ float(i) * 0.25f, float(j) * 0.25f, float(j % 4u) * 0.125f });
+
+		grid.triangles.reserve(size_t(Rows) * (RowSize - 1u) * 2u);
+		for (uint32_t j = 0u; j < Rows; j++)
+		for (int32_t i = -HalfWidth; i < HalfWidth; i++)
+		{
+			const uint32_t a = j * RowSize + uint32_t(i + HalfWidth);
+			const uint32_t b = a + 1u;
+			const uint32_t c = b + RowSize;
+			const uint32_t d = a + RowSize;
+			// the diagonals get mirrored too
+			if (i >= 0)
+			{
+				grid.triangles.push_back({ a, b, c });
+				grid.triangles.push_back({ a, c, d });
+			}
+			else
+			{
+				grid.triangles.push_back({ a, b, d });
+				grid.triangles.push_back({ b, c, d });
+			}
+		}
+		return grid;
+	}
+
+	static core::vector<uint8_t> encodeBinarySTL(const SGrid& grid)
+	{
+		core::vector<uint8_t> retval(84ull + grid.triangles.size() * 50ull, 0u);
+		const uint32_t triangleCount = grid.triangles.size();
+		memcpy(retval.data() + 80ull, &triangleCount, sizeof(triangleCount));
+		uint8_t* record = retval.data() + 84ull;
+		for (const auto& triangle : grid.triangles)
+		{
+			const auto& a = grid.positions[triangle[0]];
+			const auto& b = grid.positions[triangle[1]];
+			const auto& c = grid.positions[triangle[2]];
+			const core::vectorSIMDf normal = core::normalize(core::cross(core::vectorSIMDf(b[0] - a[0], b[1] - a[1], b[2] - a[2]), core::vectorSIMDf(c[0] - a[0], c[1] - a[1], c[2] - a[2])));
+			float values[12] = { normal.x, normal.y, normal.z };
+			for (uint32_t k = 0u; k < 3u; k++)
+				memcpy(values + 3u * (k + 1u), grid.positions[triangle[k]].data(), sizeof(vertex_t));
+			memcpy(record, values, sizeof(values));
+			record += 50ull;
+		}
+		return retval;
+	}
+
+	static core::vector<uint8_t> encodeASCIIPLY(const SGrid& grid)
+	{
+		std::string text = "ply\nformat ascii 1.0\n";
+		text += "element vertex " + std::to_string(grid.positions.size()) + "\nproperty float x\nproperty float y\nproperty float z\n";
+		text += "element face " + std::to_string(grid.triangles.size()) + "\nproperty list uchar int vertex_indices\nend_header\n";
+		char line[128];
+		for (const auto& position : grid.positions)
+		{
+			snprintf(line, sizeof(line), "%g %g %g\n", position[0], position[1], position[2]);
+			text += line;
+		}
+		for (const auto& triangle : grid.triangles)
+		{
+			snprintf(line, sizeof(line), "3 %u %u %u\n", triangle[0], triangle[1], triangle[2]);
+			text += line;
+		}
+		return core::vector<uint8_t>(text.begin(), text.end());
+	}
+
+	bool writeFile(const path& filename, const core::vector<uint8_t>& data)
+	{
+		ISystem::future_t<smart_refctd_ptr<IFile>> future;
+		m_system->createFile(future, filename, IFile::ECF_WRITE);
+		if (auto file = future.acquire())
+		if (*file)
+		{
+			IFile::success_t written;
+			file->get()->write(written, data.data(), 0ull, data.size());
+			if (written)
+				return true;
+		}
+		m_logger->log("Could not write %s", ILogger::ELL_ERROR, filename.string().c_str());
+		return false;
+	}
+
+	smart_refctd_ptr<IAsset> loadMesh(const path& filename, const IAssetLoader::E_LOADER_PARAMETER_FLAGS flags)
+	{
+		// every load has to actually run the loader, not return the previous one from the cache
+		IAssetLoader::SAssetLoadParams params(0u, nullptr, IAssetLoader::ECF_DUPLICATE_TOP_LEVEL, flags, m_logger.get());
+		const auto bundle = m_assetMgr->getAsset(filename.string(), params);
+		const auto contents = bundle.getContents();
+		if (contents.empty() || bundle.getAssetType() != IAsset::ET_MESH)
+		{
+			m_logger->log("Could not load %s as a mesh", ILogger::ELL_ERROR, filename.string().c_str());
+			return nullptr;
+		}
+		return contents[0];
+	}
+
+	// `outVertexCount` gets the number of vertices the index buffers reference
+	core::vector<triangle_t> loadTriangles(const path& filename, const IAssetLoader::E_LOADER_PARAMETER_FLAGS flags, size_t* outVertexCount = nullptr)
+	{
+		core::vector<triangle_t> retval;
+		const auto asset = loadMesh(filename, flags);
+		if (!asset)
+			return retval;
+
+		size_t vertexCount = 0ull;
+		for (const ICPUMeshBuffer* meshbuffer : IAsset::castDown<const ICPUMesh>(asset.get())->getMeshBuffers())
+		{
+			const uint32_t positionAttribute = meshbuffer->getPositionAttributeIx();
+			uint32_t maxIndex = 0u;
+			for (uint32_t i = 0u; i + 2u < meshbuffer->getIndexCount(); i += 3u)
+			{
+				triangle_t& triangle = retval.emplace_back();
+				for (uint32_t k = 0u; k < 3u; k++)
+				{
+					const uint32_t index = meshbuffer->getIndexValue(i + k);
+					maxIndex = core::max(maxIndex, index);
+					core::vectorSIMDf position;
+					meshbuffer->getAttribute(position, positionAttribute, index);
+					triangle[k] = { position.x, position.y, position.z };
+				}
+				std::sort(triangle.begin(), triangle.end());
+			}
+			if (meshbuffer->getIndexCount())
+				vertexCount += maxIndex + 1ull;
+		}
+		std::sort(retval.begin(), retval.end());
+		if (outVertexCount)
+			*outVertexCount = vertexCount;
+		return retval;
+	}
+
+	bool compare(const char* what, const core::vector<triangle_t>& expected, const core::vector<triangle_t>& actual)
+	{
+		if (expected.size() != actual.size())
+		{
+			m_logger->log("%s: expected %zu triangles, got %zu", ILogger::ELL_ERROR, what, expected.size(), actual.size());
+			return false;
+		}
+		const auto mismatch = std::mismatch(expected.begin(), expected.end(), actual.begin());
+		if (mismatch.first != expected.end())
+		{
+			const auto& e = (*mismatch.first)[0];
+			const auto& a = (*mismatch.second)[0];
+			m_logger->log("%s: triangle %zu differs, expected a vertex at (%f,%f,%f), got (%f,%f,%f)", ILogger::ELL_ERROR, what,
+				size_t(std::distance(expected.begin(), mismatch.first)), e[0], e[1], e[2], a[0], a[1], a[2]);
+			return false;
+		}
+		m_logger->log("%s: %zu triangles match", ILogger::ELL_INFO, what, actual.size());
+		return true;
+	}
+
+	bool checkRoundTrip(const path& input, const path& output, const E_WRITER_FLAGS writerFlags)
+	{
+		const std::string what = input.filename().string() + " -> " + output.filename().string();
+		const auto asset = loadMesh(input, IAssetLoader::ELPF_NONE);
+		if (!asset)
+			return false;
+
+		IAssetWriter::SAssetWriteParams params(asset.get(), writerFlags);
+		params.logger = m_logger.get();
+		if (!m_assetMgr->writeAsset(output.string(), params))
+		{
+			m_logger->log("%s: writing failed", ILogger::ELL_ERROR, what.c_str());
+			return false;
+		}
+		return compare(what.c_str(), loadTriangles(input, IAssetLoader::ELPF_NONE), loadTriangles(output, IAssetLoader::ELPF_NONE));
+	}
+
+	// welding must only add an index buffer, never change the triangles
+	bool checkWelding(const path& input)
+	{
+		size_t vertexCount = 0ull;
+		size_t weldedVertexCount = 0ull;
+		const auto triangles = loadTriangles(input, IAssetLoader::ELPF_NONE, &vertexCount);
+		const auto weldedTriangles = loadTriangles(input, IAssetLoader::ELPF_WELD_VERTICES, &weldedVertexCount);
+		if (!compare("welded STL load", triangles, weldedTriangles))
+			return false;
+		if (weldedVertexCount >= vertexCount)
+		{
+			m_logger->log("welded STL load: %zu vertices aren't fewer than the %zu unwelded ones", ILogger::ELL_ERROR, weldedVertexCount, vertexCount);
+			return false;
+		}
+		m_logger->log("welded STL load: %zu vertices down to %zu", ILogger::ELL_INFO, vertexCount, weldedVertexCount);
+		return true;
+	}
+
+	smart_refctd_ptr<ISystem> m_system;
+	smart_refctd_ptr<CStdoutLogger> m_logger;
+	smart_refctd_ptr<IAssetManager> m_assetMgr;
+};
+
+NBL_MAIN_FUNC(MeshRoundTrip)